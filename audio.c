@@ -0,0 +1,204 @@
+/* I2S audio output
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+
+#include "audio_i2s.pio.h"
+#include "audio.h"
+#include "dvo.h"
+#include "hw.h"
+
+#define AUDIO_PIO               pio0
+
+static uint32_t         audio_ring[AUDIO_RING_FRAMES]
+        __attribute__((aligned(1 << AUDIO_RING_BITS)));
+/* The control channel reloads the data channel's count from here: */
+static uint32_t         audio_ring_count = AUDIO_RING_FRAMES;
+static unsigned int     audio_wr;
+static unsigned int     audio_rate;
+static bool             audio_muted;
+static unsigned int     audio_sm;
+static int              dma_data;
+static int              dma_ctrl;
+
+
+/* State machine runs at 64*fs: in 24.8 fixed-point, sys/(64*fs)*256 */
+static void     audio_set_clocks(unsigned int rate)
+{
+        uint32_t sys = clock_get_hz(clk_sys);
+        uint32_t div = (sys * 4) / rate;
+
+        pio_sm_set_clkdiv_int_frac(AUDIO_PIO, audio_sm, div >> 8, div & 0xff);
+
+#ifdef MCU_VID_I2S_MCLK
+        /* MCLK at (roughly) 256*fs: PWM toggles every other count, so
+         * divide by sys/(512*fs), in 8.4 fixed-point.
+         */
+        unsigned int slice = pwm_gpio_to_slice_num(MCU_VID_I2S_MCLK);
+        uint32_t mdiv = sys / (32 * rate);
+        pwm_config c = pwm_get_default_config();
+
+        pwm_config_set_wrap(&c, 1);
+        pwm_config_set_clkdiv_int_frac(&c, mdiv >> 4, mdiv & 0xf);
+        pwm_init(slice, &c, true);
+        pwm_set_gpio_level(MCU_VID_I2S_MCLK, 1);
+#endif
+}
+
+int     audio_init(unsigned int rate)
+{
+        unsigned int offset;
+
+        memset(audio_ring, 0, sizeof(audio_ring));
+        audio_wr = 0;
+
+#ifdef MCU_VID_I2S_MCLK
+        gpio_set_function(MCU_VID_I2S_MCLK, GPIO_FUNC_PWM);
+#endif
+        offset = pio_add_program(AUDIO_PIO, &audio_i2s_program);
+        audio_sm = pio_claim_unused_sm(AUDIO_PIO, true);
+        audio_i2s_program_init(AUDIO_PIO, audio_sm, offset,
+                               MCU_VID_I2S_DATA, MCU_VID_I2S_WS);
+
+        /* The data channel reads the ring (wrapping its read address) into
+         * the TX FIFO.  When its count expires, it chains to the control
+         * channel, which rewrites the count and retriggers it; neither
+         * needs the CPU.
+         */
+        dma_data = dma_claim_unused_channel(true);
+        dma_ctrl = dma_claim_unused_channel(true);
+
+        dma_channel_config c = dma_channel_get_default_config(dma_data);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_ring(&c, false, AUDIO_RING_BITS);
+        channel_config_set_dreq(&c, pio_get_dreq(AUDIO_PIO, audio_sm, true));
+        channel_config_set_chain_to(&c, dma_ctrl);
+        dma_channel_configure(dma_data, &c, &AUDIO_PIO->txf[audio_sm],
+                              audio_ring, AUDIO_RING_FRAMES, false);
+
+        c = dma_channel_get_default_config(dma_ctrl);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, false);
+        dma_channel_configure(dma_ctrl, &c,
+                              &dma_hw->ch[dma_data].al1_transfer_count_trig,
+                              &audio_ring_count, 1, false);
+
+        dma_channel_start(dma_data);
+        return audio_set_rate(rate);
+}
+
+int     audio_set_rate(unsigned int rate)
+{
+        if (dvo_audio_config(rate) < 0) {
+                printf("*** Audio rate %d not supported\r\n", rate);
+                return -1;
+        }
+        pio_sm_set_enabled(AUDIO_PIO, audio_sm, false);
+        audio_set_clocks(rate);
+        pio_sm_clkdiv_restart(AUDIO_PIO, audio_sm);
+        pio_sm_set_enabled(AUDIO_PIO, audio_sm, true);
+        audio_rate = rate;
+        dvo_mute(audio_muted);
+        return 0;
+}
+
+unsigned int    audio_get_rate(void)
+{
+        return audio_rate;
+}
+
+static unsigned int audio_rd(void)
+{
+        uint32_t a = dma_channel_hw_addr(dma_data)->read_addr;
+
+        return ((a - (uintptr_t)audio_ring) / 4) & (AUDIO_RING_FRAMES - 1);
+}
+
+unsigned int    audio_level(void)
+{
+        return (audio_wr - audio_rd()) & (AUDIO_RING_FRAMES - 1);
+}
+
+unsigned int    audio_space(void)
+{
+        return AUDIO_RING_FRAMES - 1 - audio_level();
+}
+
+unsigned int    audio_write(const uint32_t *frames, unsigned int n)
+{
+        unsigned int space = audio_space();
+
+        if (n > space)
+                n = space;
+        for (unsigned int i = 0; i < n; i++) {
+                audio_ring[audio_wr] = frames[i];
+                audio_wr = (audio_wr + 1) & (AUDIO_RING_FRAMES - 1);
+        }
+        return n;
+}
+
+void    audio_mute(bool muted)
+{
+        audio_muted = muted;
+        dvo_mute(muted);
+}
+
+bool    audio_is_muted(void)
+{
+        return audio_muted;
+}
+
+/* Fill the whole ring with a triangle wave, which then loops by itself.
+ * The period divides the ring size so there's no discontinuity; 750Hz at
+ * 48kHz.
+ */
+void    audio_test_tone(void)
+{
+        const unsigned int period = 64;
+
+        for (unsigned int i = 0; i < AUDIO_RING_FRAMES; i++) {
+                int p = i % period;
+                int v = (p < period/2) ? p : (period - p);
+                int16_t s = (v - period/4) * (8192 / (period/4));
+
+                audio_ring[i] = ((uint32_t)(uint16_t)s << 16) | (uint16_t)s;
+        }
+}
+
+void    audio_status(void)
+{
+        printf("Audio: %d Hz, %s, ring %d/%d frames queued\r\n",
+               audio_rate, audio_muted ? "muted" : "unmuted",
+               audio_level(), AUDIO_RING_FRAMES);
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* I2S audio output to the video serialiser.
+ *
+ * Frames (16-bit stereo, packed as R<<16 | L) are written into a ring
+ * buffer, which DMA streams to a PIO I2S transmitter indefinitely.  If the
+ * producer stops, the ring's contents are replayed.
+ */
+
+#define AUDIO_RING_BITS         12                      /* log2 of size in bytes */
+#define AUDIO_RING_FRAMES       ((1 << AUDIO_RING_BITS) / 4)
+
+#define AUDIO_RATE_DEFAULT      48000
+
+int             audio_init(unsigned int rate);
+/* 32000, 44100 or 48000 */
+int             audio_set_rate(unsigned int rate);
+unsigned int    audio_get_rate(void);
+/* Free space, and queued frames not yet consumed by DMA */
+unsigned int    audio_space(void);
+unsigned int    audio_level(void);
+/* Queue up to n frames, returning how many were taken */
+unsigned int    audio_write(const uint32_t *frames, unsigned int n);
+void            audio_mute(bool muted);
+bool            audio_is_muted(void);
+void            audio_test_tone(void);
+void            audio_status(void);
+
+#endif
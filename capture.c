@@ -0,0 +1,200 @@
+/* FPGA parallel bus capture engine
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+
+#include "fpga_capture.pio.h"
+#include "capture.h"
+#include "events.h"
+#include "vidc_sound.h"
+#include "vidc_regs.h"
+#include "regcache.h"
+#include "video.h"
+#include "trace.h"
+#include "hw.h"
+
+extern uint8_t flag_autoprobe_mode;
+
+#define CAP_PIO                 pio1
+#define CAP_RING_BITS           13                      /* log2 of size in bytes */
+#define CAP_RING_SAMPLES        ((1 << CAP_RING_BITS) / 2)
+#define CAP_DRAIN_MS            1
+#define CAP_SOUND_BATCH         256
+
+static uint16_t         cap_ring[CAP_RING_SAMPLES]
+        __attribute__((aligned(1 << CAP_RING_BITS)));
+static uint32_t         cap_ring_count = (1 << CAP_RING_BITS) / 4;
+static unsigned int     cap_rd;
+static int              dma_data;
+static int              dma_ctrl;
+static repeating_timer_t drain_timer;
+static cap_parser_t     parser;
+
+static uint8_t          sound_buf[CAP_SOUND_BATCH];
+static unsigned int     sound_len;
+
+static struct {
+        unsigned int    samples;
+        unsigned int    vidc_writes;
+        unsigned int    high_water;
+        unsigned int    near_overflow;
+} cap_stats;
+
+
+static bool     capture_drain_tick(repeating_timer_t *rt)
+{
+        event_post(EVT_CAPTURE);
+        return true;
+}
+
+void    capture_init(void)
+{
+        unsigned int offset, sm;
+
+        memset(cap_ring, 0, sizeof(cap_ring));
+        cap_rd = 0;
+        cap_parser_init(&parser);
+
+        offset = pio_add_program(CAP_PIO, &fpga_capture_program);
+        sm = pio_claim_unused_sm(CAP_PIO, true);
+        fpga_capture_program_init(CAP_PIO, sm, offset, MCU_FPGA_D0);
+
+        /* As for audio, but in the other direction: the data channel writes
+         * into the ring, wrapping its write address, and the control
+         * channel re-arms it when its count expires.
+         */
+        dma_data = dma_claim_unused_channel(true);
+        dma_ctrl = dma_claim_unused_channel(true);
+
+        dma_channel_config c = dma_channel_get_default_config(dma_data);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_ring(&c, true, CAP_RING_BITS);
+        channel_config_set_dreq(&c, pio_get_dreq(CAP_PIO, sm, false));
+        channel_config_set_chain_to(&c, dma_ctrl);
+        dma_channel_configure(dma_data, &c, cap_ring, &CAP_PIO->rxf[sm],
+                              cap_ring_count, false);
+
+        c = dma_channel_get_default_config(dma_ctrl);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, false);
+        dma_channel_configure(dma_ctrl, &c,
+                              &dma_hw->ch[dma_data].al1_transfer_count_trig,
+                              &cap_ring_count, 1, false);
+
+        dma_channel_start(dma_data);
+        pio_sm_set_enabled(CAP_PIO, sm, true);
+
+        add_repeating_timer_ms(CAP_DRAIN_MS, capture_drain_tick, NULL, &drain_timer);
+}
+
+static void     capture_flush_sound(void)
+{
+        if (sound_len) {
+                vidc_sound_feed(sound_buf, sound_len);
+                sound_len = 0;
+        }
+}
+
+static void     capture_record(unsigned int type, const uint8_t *payload,
+                               unsigned int len, void *arg)
+{
+        switch (type) {
+        case CAP_REC_SOUND:
+                if (sound_len + len > CAP_SOUND_BATCH)
+                        capture_flush_sound();
+                memcpy(&sound_buf[sound_len], payload, len);
+                sound_len += len;
+                break;
+        case CAP_REC_VIDC_WRITE:
+                if (len >= 4) {
+                        uint32_t w = ((uint32_t)payload[0] << 24) |
+                                ((uint32_t)payload[1] << 16) |
+                                ((uint32_t)payload[2] << 8) | payload[3];
+                        unsigned int line = (len >= 6) ?
+                                ((payload[4] << 8) | payload[5]) : TRACE_NO_LINE;
+
+                        cap_stats.vidc_writes++;
+                        trace_vidc_write(w, line);
+                        /* This sees every timing write, not just HCR/VCR as
+                         * the reconfig IRQ does, so (re)start settling on
+                         * any of them:
+                         */
+                        if (vidc_is_timing_reg(VIDC_WRITE_REG(w))) {
+                                regcache_invalidate_vidc();
+                                if (flag_autoprobe_mode)
+                                        video_reconfig_event();
+                        }
+                }
+                break;
+        case CAP_REC_FRAME:
+                trace_frame();
+                break;
+        default:
+                break;
+        }
+}
+
+void    capture_poll(void)
+{
+        uint32_t wa = dma_channel_hw_addr(dma_data)->write_addr;
+        unsigned int wr = ((wa - (uintptr_t)cap_ring) / 2) & (CAP_RING_SAMPLES - 1);
+        unsigned int level = (wr - cap_rd) & (CAP_RING_SAMPLES - 1);
+
+        if (level > cap_stats.high_water)
+                cap_stats.high_water = level;
+        /* The DMA can't tell us if it lapped the reader; this is a hint
+         * that the drain interval is too long for the bus rate:
+         */
+        if (level > (CAP_RING_SAMPLES * 3) / 4)
+                cap_stats.near_overflow++;
+
+        if (wr < cap_rd) {
+                cap_parse(&parser, &cap_ring[cap_rd], CAP_RING_SAMPLES - cap_rd,
+                          capture_record, NULL);
+                cap_rd = 0;
+        }
+        cap_parse(&parser, &cap_ring[cap_rd], wr - cap_rd, capture_record, NULL);
+        cap_rd = wr;
+        cap_stats.samples += level;
+
+        capture_flush_sound();
+}
+
+void    capture_status(void)
+{
+        printf("Capture: %d samples, %d records (%d resyncs, %d stray bytes), "
+               "%d VIDC writes\r\n",
+               cap_stats.samples, parser.records, parser.resyncs, parser.stray,
+               cap_stats.vidc_writes);
+        printf("Capture: ring %d samples, high water %d, %d near-overflows\r\n",
+               CAP_RING_SAMPLES, cap_stats.high_water, cap_stats.near_overflow);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Capture of the FPGA's D0-D7/STROBE/VALID parallel bus.
+ *
+ * The bus carries a stream of records.  The first byte of each has VALID
+ * set, and holds the record type (bits 7:4) and payload length in bytes
+ * (bits 3:0); the payload bytes follow with VALID clear.
+ */
+
+#define CAP_SAMPLE_DATA         0x00ff
+#define CAP_SAMPLE_STROBE       0x0100
+#define CAP_SAMPLE_VALID        0x0200
+
+#define CAP_REC_SOUND           0x1     /* VIDC sound DMA bytes */
+#define CAP_REC_VIDC_WRITE      0x2     /* Big-endian VIDC register write, */
+                                        /* optionally + big-endian u16 line */
+#define CAP_REC_FRAME           0x3     /* Start of frame (VIDC flyback) */
+
+#define CAP_REC_MAX_LEN         15
+
+typedef void (*cap_record_cb_t)(unsigned int type, const uint8_t *payload,
+                                unsigned int len, void *arg);
+
+/* Record framing, independent of the hardware: */
+typedef struct {
+        unsigned int    type;
+        unsigned int    len;
+        unsigned int    got;
+        bool            in_record;
+        uint8_t         payload[CAP_REC_MAX_LEN];
+        unsigned int    records;
+        unsigned int    resyncs;        /* Record cut short by a new header */
+        unsigned int    stray;          /* Payload bytes outside a record */
+} cap_parser_t;
+
+void            cap_parser_init(cap_parser_t *p);
+/* Feed captured samples; cb is called for each complete record */
+void            cap_parse(cap_parser_t *p, const uint16_t *samples, unsigned int n,
+                          cap_record_cb_t cb, void *arg);
+
+/* The capture engine: PIO on pio1, DMA into a ring, drained periodically */
+void            capture_init(void);
+/* Process everything captured so far */
+void            capture_poll(void);
+void            capture_status(void);
+
+#endif
@@ -0,0 +1,65 @@
+/* FPGA parallel bus record framing
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include "capture.h"
+
+/* This is kept free of hardware dependencies, so that recorded sample
+ * streams can be replayed through it on a host.
+ */
+
+void    cap_parser_init(cap_parser_t *p)
+{
+        memset(p, 0, sizeof(*p));
+}
+
+void    cap_parse(cap_parser_t *p, const uint16_t *samples, unsigned int n,
+                  cap_record_cb_t cb, void *arg)
+{
+        for (unsigned int i = 0; i < n; i++) {
+                uint16_t s = samples[i];
+                uint8_t d = s & CAP_SAMPLE_DATA;
+
+                if (s & CAP_SAMPLE_VALID) {
+                        if (p->in_record)
+                                p->resyncs++;
+                        p->type = d >> 4;
+                        p->len = d & 0xf;
+                        p->got = 0;
+                        p->in_record = true;
+                } else if (p->in_record) {
+                        p->payload[p->got++] = d;
+                } else {
+                        p->stray++;
+                        continue;
+                }
+
+                if (p->in_record && p->got == p->len) {
+                        p->in_record = false;
+                        p->records++;
+                        cb(p->type, p->payload, p->len, arg);
+                }
+        }
+}
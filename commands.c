@@ -27,8 +27,10 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <stdlib.h>
 #include <ctype.h>
 #include "pico/stdlib.h"
+#include "hardware/sync.h"
 
 #include "version.h"
 #include "commands.h"
@@ -36,11 +38,22 @@
 #include "video.h"
 #include "dvo.h"
 #include "fpga.h"
+#include "regcache.h"
+#include "modestore.h"
+#include "events.h"
+#include "audio.h"
+#include "vidc_sound.h"
+#include "capture.h"
+#include "trace.h"
+#include "latency.h"
+#include "edid.h"
+#include "console.h"
 #include "hw.h"
 
 
 extern uint8_t flag_autoprobe_mode;
 extern uint8_t flag_test_mode;
+extern uint8_t flag_irq_mode;
 
 #define PROMPT "> "
 #define TEST_PROMPT "test> "
@@ -51,22 +64,106 @@ typedef struct {
         const char *format;
         const char *help;
         cmd_fn_t handler;
+        /* Run on core 0, as it doesn't touch the FPGA, I2C or flash (only
+         * reads/resets counters and flags, or dumps memory):
+         */
+        bool local;
 } cmd_t;
 
 /******************************************************************************/
 
+/* Console commands run on core 0, except those that need the FPGA (or
+ * the transmitter's I2C, or flash), which core 1 owns.  Those lines go
+ * to core 1 through a single-producer/single-consumer ring, and run
+ * between its other work; their output comes back through the console
+ * ring (console.c), and core 0 carries on draining that (not accepting
+ * more input) until core 1 says it's done.  The multicore FIFO isn't
+ * used, as flash lockout needs it.  Each index is written by only one
+ * core.
+ */
+#define CMDQ_ENTRIES    2
+#define CMD_LINE_MAX    100
+
+static char             cmdq[CMDQ_ENTRIES][CMD_LINE_MAX];
+static unsigned int     cmdq_len[CMDQ_ENTRIES];
+static volatile unsigned int cmdq_head;        /* Core 0 */
+static volatile unsigned int cmdq_tail;        /* Core 1 */
+static bool             cmd_busy;               /* Core 0: waiting on core 1 */
+
+static const cmd_t *cmd_find(char *linebuffer, int len, char **args);
+
 void	cmd_init(void)
 {
+        cmdq_head = 0;
+        cmdq_tail = 0;
+        cmd_busy = false;
+}
+
+/* Core 0: queue a line for core 1 */
+static void     cmd_submit(const char *line, unsigned int len)
+{
+        unsigned int h = cmdq_head;
+
+        while ((h - cmdq_tail) >= CMDQ_ENTRIES)
+                __wfe();
+        memcpy(cmdq[h % CMDQ_ENTRIES], line, len + 1);
+        cmdq_len[h % CMDQ_ENTRIES] = len;
+        __dmb();
+        cmdq_head = h + 1;
+        cmd_busy = true;
+        event_post(EVT_CLI_CMD);
+}
+
+/* Core 1: run any queued lines.  Their output mustn't be dropped, so
+ * waits for the console ring to drain if need be.
+ */
+void    cmd_service(void)
+{
+        unsigned int t = cmdq_tail;
+
+        while (t != cmdq_head) {
+                __dmb();
+                console_set_wait(true);
+                cmd_parse(cmdq[t % CMDQ_ENTRIES], cmdq_len[t % CMDQ_ENTRIES]);
+                console_set_wait(false);
+                __dmb();
+                cmdq_tail = ++t;
+                __sev();
+        }
+}
+
+/* Core 0: run a line here, or pass it on; false if it's been passed on */
+static bool     cmd_dispatch(char *line, unsigned int len)
+{
+        char *args;
+        const cmd_t *c = cmd_find(line, len, &args);
+
+        if (c && !c->local) {
+                cmd_submit(line, len);
+                return false;
+        }
+        cmd_parse(line, len);
+        return true;
 }
 
-/* Look for new activity, basic line editing/dispatch command: */
-void    cmd_poll(void)
+/* Look for new activity, basic line editing/dispatch command.
+ * Waits up to timeout_us for a character.
+ */
+void    cmd_poll(unsigned int timeout_us)
 {
-        static char buf[100];
+        static char buf[CMD_LINE_MAX];
         static unsigned int len = 0;
         static int line_done = 0;
 
-        int r = getchar_timeout_us(10000 /* 10ms */);
+        if (cmd_busy) {
+                /* Input waits (in the USB buffer) until core 1's done */
+                if (cmdq_tail != cmdq_head)
+                        return;
+                cmd_busy = false;
+                printf(flag_test_mode ? TEST_PROMPT : PROMPT);
+        }
+
+        int r = getchar_timeout_us(timeout_us);
 
         if (r >= 0) {
                 char c = (char)r;
@@ -99,10 +196,12 @@ void    cmd_poll(void)
                 }
 
                 if (line_done) {
-                        cmd_parse(buf, len);
+                        bool done = cmd_dispatch(buf, len);
+
                         line_done = 0;
                         len = 0;
-                        printf(flag_test_mode ? TEST_PROMPT : PROMPT);
+                        if (done)
+                                printf(flag_test_mode ? TEST_PROMPT : PROMPT);
                 }
         }
 }
@@ -177,7 +276,7 @@ static void cmd_version(char *args)
 
 	printf("  version " BUILD_VERSION " (" BUILD_SHA "), built " BUILD_TIME "\r\n");
         /* FIXME: Dump FPGA version */
-	printf("  FPGA %08x\r\n", fpga_read32(FPGA_CTRL(CTRL_ID)));
+	printf("  FPGA %08x\r\n", regcache_read(FPGA_CTRL(CTRL_ID)));
 }
 
 static void cmd_vtx(char *args)
@@ -296,9 +395,7 @@ static void cmd_led(char *args)
                 goto fail;
         }
 
-	uint32_t v = fpga_read32(FPGA_CTRL(CTRL_REG));
-	v = (v & ~CR_LED) | (en ? CR_LED : 0);
-	fpga_write32(FPGA_CTRL(CTRL_REG), v);
+	regcache_modify(FPGA_CTRL(CTRL_REG), CR_LED, en ? CR_LED : 0);
 fail:
         return;
 }
@@ -330,6 +427,8 @@ static void cmd_sync(char *args)
 
 static void cmd_probe(char *args)
 {
+        /* VIDC might have changed without a reconfig event */
+        regcache_invalidate_vidc();
         video_probe_mode(true);
 }
 
@@ -344,6 +443,48 @@ static void cmd_autoprobe(char *args)
         printf("Autoprobe is %s\r\n", flag_autoprobe_mode ? "on" : "off");
 }
 
+static void cmd_modecache(char *args)
+{
+        if (*args == 'f') {
+                video_modecache_flush();
+                printf("Mode cache flushed\r\n");
+        }
+        video_modecache_dump();
+}
+
+static void cmd_modestore(char *args)
+{
+        if (*args == 'e') {
+                modestore_erase();
+                printf("Mode store erased\r\n");
+        }
+        modestore_dump();
+}
+
+static void cmd_settle(char *args)
+{
+        int OK;
+        unsigned int frames, window;
+
+        frames = atoh(args, &args, &OK);
+        if (OK) {
+                args = skipwhitespace(args);
+                window = atoh(args, &args, &OK);
+                if (!OK) {
+                        printf("\r\n Syntax error, arg 1\r\n");
+                        return;
+                }
+                video_settle_config(frames, window);
+        }
+        video_settle_dump();
+}
+
+static void cmd_irqmode(char *args)
+{
+        flag_irq_mode = !flag_irq_mode;
+        printf("VIDC reconfig detection by %s\r\n", flag_irq_mode ? "IRQ" : "polling");
+}
+
 static void cmd_read_reg(char *args)
 {
         int OKa;
@@ -376,7 +517,7 @@ static void cmd_write_reg(char *args)
                         return;
                 }
 
-                fpga_write32(addr, data);
+                regcache_write(addr, data);
                 printf("  [%08x]\t<= %08x\r\n", addr, data);
         }
 }
@@ -384,12 +525,15 @@ static void cmd_write_reg(char *args)
 static void dump_regs(unsigned int r, unsigned int len)
 {
         const int wordsPerLine = 8;
+        uint32_t regs[wordsPerLine];
 
         for (unsigned int n = r; n < r+len; n++) {
                 if ((n & (wordsPerLine-1)) == 0) {
                         printf("  %08x: ", n*4);
+                        /* Fetch a line's worth at once */
+                        fpga_read_burst(n, regs, wordsPerLine);
                 }
-                printf("%08x ", fpga_read32(n));
+                printf("%08x ", regs[n & (wordsPerLine-1)]);
 
                 if ((n & (wordsPerLine-1)) == (wordsPerLine-1)) {
                         printf("\r\n");
@@ -407,8 +551,124 @@ static void cmd_dump_regs(char *args)
         dump_regs(0xc00, 8);
 }
 
+static void cmd_spi_stats(char *args)
+{
+        fpga_spi_stats_t st;
+
+        fpga_spi_get_stats(&st);
+        printf("FPGA SPI: %d transactions, %d bytes\r\n",
+               st.transactions, st.bytes);
+        fpga_spi_clear_stats();
+}
+
+static void cmd_pll_stats(char *args)
+{
+        video_pll_stats_t st;
+
+        video_pll_get_stats(&st);
+        printf("PLL: %d loads, %d skipped, %d lock timeouts\r\n",
+               st.loads, st.skipped, st.timeouts);
+        if (st.loads)
+                printf("Reconfig to lock: min %dus, avg %dus, max %dus\r\n",
+                       st.lock_min_us, st.lock_total_us / st.loads, st.lock_max_us);
+        video_pll_clear_stats();
+}
+
+static void cmd_commit_stats(char *args)
+{
+        video_commit_stats_t st;
+
+        video_commit_get_stats(&st);
+        printf("VIDO commits: %d, %d words changed, %d unchanged; %d written\r\n",
+               st.commits, st.words_changed, st.words_saved, st.words_written);
+        printf("Syncs: %d, %d timeouts, %d polls\r\n", st.syncs, st.sync_timeouts,
+               st.sync_polls);
+        if (st.syncs)
+                printf("Sync request to ack: min %dus, avg %dus, max %dus\r\n",
+                       st.sync_min_us, st.sync_total_us / st.syncs, st.sync_max_us);
+        video_commit_clear_stats();
+}
+
+static void cmd_sound(char *args)
+{
+        if (*args == 'm') {
+                audio_mute(!audio_is_muted());
+        } else if (*args == 't') {
+                audio_test_tone();
+        } else if (*args == 'b') {
+                vidc_sound_bench();
+                return;
+        } else if (*args != '\0') {
+                unsigned int rate = strtoul(args, NULL, 10);
+
+                audio_set_rate(rate);
+        }
+        audio_status();
+        vidc_sound_status();
+}
+
+static void cmd_trace(char *args)
+{
+        if (strncmp(args, "on", 2) == 0) {
+                trace_enable(true);
+        } else if (strncmp(args, "off", 3) == 0) {
+                trace_enable(false);
+        } else if (*args == 'c') {
+                trace_clear();
+        } else if (*args == 'd') {
+                trace_dump_binary();
+                return;
+        }
+        trace_status();
+}
+
+#if LATENCY_TRACE
+static void cmd_latency(char *args)
+{
+        if (*args == 'c') {
+                lat_clear();
+        } else if (*args == 'd') {
+                lat_dump();
+                return;
+        }
+        lat_status();
+}
+#endif
+
+static void cmd_edid(char *args)
+{
+        edid_dump();
+}
+
+static void cmd_edid_read(char *args)
+{
+        printf("EDID %s\r\n", edid_update() ? "changed" : "unchanged");
+        edid_dump();
+}
+
+static void cmd_capture(char *args)
+{
+        capture_status();
+}
+
+static void cmd_regcache_stats(char *args)
+{
+        static const char *names[RC_NUM_BANKS] = { "VIDC", "VIDO", "CTRL" };
+
+        for (int b = 0; b < RC_NUM_BANKS; b++) {
+                regcache_stats_t st;
+
+                regcache_get_stats(b, &st);
+                printf("%s:\thits %d, misses %d, uncached %d\r\n",
+                       names[b], st.hits, st.misses, st.uncached);
+        }
+        regcache_clear_stats();
+}
+
 static void cmd_dvo_init(char *args)
 {
+        if (*args == 's')
+                dvo_bus_scan();
 	dvo_init();
 }
 
@@ -424,10 +684,12 @@ static void cmd_help(char *args);
 static cmd_t commands[] = {
         { .format = "help",
           .help = "help\t\t\t\t\t\tGives this help",
-          .handler = cmd_help },
+          .handler = cmd_help,
+          .local = true },
         { .format = "?",
           .help = 0,
-          .handler = cmd_help },
+          .handler = cmd_help,
+          .local = true },
         { .format = "ver",
           .help = "ver\t\t\t\t\t\tPrint build version information",
           .handler = cmd_version },
@@ -449,6 +711,10 @@ static cmd_t commands[] = {
         { .format = "vt",
           .help = "vt\t\t\t\t\t\tDump video timing",
           .handler = cmd_vt },
+        { .format = "vo",
+          .help = "vo\t\t\t\t\tShow (and reset) output commit/sync counters",
+          .handler = cmd_commit_stats,
+          .local = true },
         { .format = "v",
           .help = "v\t\t\t\t\t\tDump VIDC regs",
           .handler = cmd_vidc_dump },
@@ -458,12 +724,30 @@ static cmd_t commands[] = {
         { .format = "sync",
           .help = "sync\t\t\t\t\t\tResync display to VIDC",
           .handler = cmd_sync },
+        { .format = "pll",
+          .help = "pll\t\t\t\t\tShow (and reset) PLL reconfig/lock times",
+          .handler = cmd_pll_stats,
+          .local = true },
         { .format = "p",
           .help = "p\t\t\t\t\t\tProbe mode for VIDC timings",
           .handler = cmd_probe },
         { .format = "a",
           .help = "a\t\t\t\t\t\tToggle mode autoprobing",
-          .handler = cmd_autoprobe },
+          .handler = cmd_autoprobe,
+          .local = true },
+        { .format = "mc",
+          .help = "mc [f]\t\t\t\t\tShow (or flush) mode decision cache",
+          .handler = cmd_modecache },
+        { .format = "ms",
+          .help = "ms [e]\t\t\t\t\tShow (or erase) stored modes",
+          .handler = cmd_modestore },
+        { .format = "settle",
+          .help = "settle [<frames> <window>]\t\t\tShow/set mode-change debounce",
+          .handler = cmd_settle },
+        { .format = "irq",
+          .help = "irq\t\t\t\t\tToggle IRQ/polled VIDC reconfig detection",
+          .handler = cmd_irqmode,
+          .local = true },
         { .format = "rr",
           .help = "rr <addr>\t\t\t\t\tRead FPGA register",
           .handler = cmd_read_reg },
@@ -473,8 +757,40 @@ static cmd_t commands[] = {
         { .format = "dr",
           .help = "dr\t\t\t\t\tDump FPGA register space",
           .handler = cmd_dump_regs },
+        { .format = "spi",
+          .help = "spi\t\t\t\t\tShow (and reset) FPGA SPI traffic counters",
+          .handler = cmd_spi_stats,
+          .local = true },
+        { .format = "rc",
+          .help = "rc\t\t\t\t\tShow (and reset) register cache counters",
+          .handler = cmd_regcache_stats,
+          .local = true },
+        { .format = "snd",
+          .help = "snd [m | t | b | <rate Hz>]\t\tAudio status, toggle mute, test tone, VIDC mix bench, rate",
+          .handler = cmd_sound },
+        { .format = "cap",
+          .help = "cap\t\t\t\t\tShow parallel bus capture status",
+          .handler = cmd_capture,
+          .local = true },
+        { .format = "tr",
+          .help = "tr [on | off | c | d]\t\t\tVIDC write trace on/off, clear, binary dump",
+          .handler = cmd_trace,
+          .local = true },
+#if LATENCY_TRACE
+        { .format = "lat",
+          .help = "lat [c | d]\t\t\t\tMode switch stage latencies, clear, text dump",
+          .handler = cmd_latency,
+          .local = true },
+#endif
+        { .format = "edid r",
+          .help = 0,
+          .handler = cmd_edid_read },
+        { .format = "edid",
+          .help = "edid [r]\t\t\t\tShow (or re-read) monitor EDID",
+          .handler = cmd_edid,
+          .local = true },
         { .format = "dvoi",
-          .help = "dvoi\t\t\t\t\tDVO reinit",
+          .help = "dvoi [s]\t\t\t\tDVO reinit (s: scan I2C bus first)",
           .handler = cmd_dvo_init },
         { .format = "dvos",
           .help = "dvos\t\t\t\t\tDVO status",
@@ -493,28 +809,35 @@ static void cmd_help(char *args)
         }
 }
 
-void cmd_parse(char *linebuffer, int len)
+/* The command a line's for, or NULL if it's blank or unknown */
+static const cmd_t *cmd_find(char *linebuffer, int len, char **args)
 {
-        char *cmd_start;
-        int ran_cmd = 0;
-
-        cmd_start = skipwhitespace(linebuffer);
+        char *cmd_start = skipwhitespace(linebuffer);
 
         /* Check for blank line: */
-        if (cmd_start - linebuffer == len) {
-                return;
-        }
+        if (cmd_start - linebuffer == len)
+                return NULL;
 
         for (int i = 0; i < num_commands; i++) {
                 int clen = strlen((char *)commands[i].format);
                 if (strncmp(cmd_start, (char *)commands[i].format, clen) == 0) {
-                        commands[i].handler(skipwhitespace(cmd_start + clen));
-                        ran_cmd = 1;
-                        break;
+                        *args = skipwhitespace(cmd_start + clen);
+                        return &commands[i];
                 }
         }
-        if (!ran_cmd) {
+        *args = cmd_start;
+        return NULL;
+}
+
+void cmd_parse(char *linebuffer, int len)
+{
+        char *args;
+        const cmd_t *c = cmd_find(linebuffer, len, &args);
+
+        if (c) {
+                c->handler(args);
+        } else if (skipwhitespace(linebuffer) - linebuffer != len) {
                 printf(" -- Unknown command!\r\n");
-                cmd_help(cmd_start);
+                cmd_help(args);
         }
 }
@@ -26,7 +26,9 @@
 #define COMMANDS_H
 
 void cmd_init(void);
-void cmd_poll(void);
+void cmd_poll(unsigned int timeout_us);
 void cmd_parse(char *linebuffer, int len);
+/* Run console commands queued for the video core (on it) */
+void cmd_service(void);
 
 #endif
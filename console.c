@@ -0,0 +1,144 @@
+/* Console output ring, drained to USB by core 0
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/stdio/driver.h"
+#include "pico/stdio_usb.h"
+#include "hardware/sync.h"
+
+#include "console.h"
+
+/* This replaces stdio_usb as the stdio driver:  printf() puts characters
+ * (after CRLF translation) in the ring, and console_drain() hands them to
+ * stdio_usb's own out_chars.  Input comes straight from stdio_usb.
+ */
+
+#define CONSOLE_RING            8192    /* Power of 2 */
+#define CONSOLE_RING_MASK       (CONSOLE_RING - 1)
+/* How long core 1 waits, without the ring draining, before dropping: */
+#define CONSOLE_WAIT_US         200000
+
+static char             ring[CONSOLE_RING];
+static volatile unsigned int ring_head;         /* Writers, under ring_lock */
+static volatile unsigned int ring_tail;         /* Core 0 */
+static spin_lock_t      *ring_lock;
+static volatile bool    core1_wait;
+static volatile unsigned int dropped;           /* Core 1's, for lack of space */
+static unsigned int     dropped_reported;
+
+static unsigned int     console_put(const char *buf, unsigned int len)
+{
+        uint32_t irqs = spin_lock_blocking(ring_lock);
+        unsigned int h = ring_head;
+        unsigned int space = CONSOLE_RING - (h - ring_tail);
+        unsigned int n = len < space ? len : space;
+
+        for (unsigned int i = 0; i < n; i++)
+                ring[(h + i) & CONSOLE_RING_MASK] = buf[i];
+        __dmb();
+        ring_head = h + n;
+        spin_unlock(ring_lock, irqs);
+        return n;
+}
+
+static void     console_out_chars(const char *buf, int len)
+{
+        uint32_t start = time_us_32();
+
+        while (len > 0) {
+                unsigned int n = console_put(buf, len);
+
+                buf += n;
+                len -= n;
+                if (len == 0)
+                        break;
+                if (get_core_num() == 0) {
+                        console_drain();
+                        continue;
+                }
+                if (n)
+                        start = time_us_32();
+                if (!core1_wait || (time_us_32() - start) > CONSOLE_WAIT_US) {
+                        dropped += len;
+                        break;
+                }
+                tight_loop_contents();
+        }
+}
+
+static int      console_in_chars(char *buf, int len)
+{
+        return stdio_usb.in_chars(buf, len);
+}
+
+static stdio_driver_t console_driver = {
+        .out_chars = console_out_chars,
+        .in_chars = console_in_chars,
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+        .crlf_enabled = PICO_STDIO_DEFAULT_CRLF,
+#endif
+};
+
+void            console_init(void)
+{
+        ring_lock = spin_lock_init(spin_lock_claim_unused(true));
+        stdio_set_driver_enabled(&console_driver, true);
+        stdio_set_driver_enabled(&stdio_usb, false);
+}
+
+void            console_drain(void)
+{
+        unsigned int t = ring_tail;
+        unsigned int h = ring_head;
+
+        __dmb();
+        while (t != h) {
+                unsigned int n = CONSOLE_RING - (t & CONSOLE_RING_MASK);
+
+                if (n > h - t)
+                        n = h - t;
+                stdio_usb.out_chars(&ring[t & CONSOLE_RING_MASK], n);
+                t += n;
+                ring_tail = t;
+        }
+
+        unsigned int d = dropped;
+
+        if (d != dropped_reported) {
+                char msg[48];
+                int len = snprintf(msg, sizeof(msg), "\r\n[%u bytes of output dropped]\r\n",
+                                   d - dropped_reported);
+
+                dropped_reported = d;
+                stdio_usb.out_chars(msg, len);
+        }
+}
+
+void            console_set_wait(bool wait)
+{
+        core1_wait = wait;
+}
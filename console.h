@@ -0,0 +1,49 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdbool.h>
+
+/* Console output, from either core, goes into a ring that core 0 drains
+ * to USB CDC, so the video core never waits on the host.  If the ring's
+ * full, core 0 drains it itself; core 1's output is dropped, unless it's
+ * running a console command (when it waits, for a while).
+ */
+
+#if PICO_ON_DEVICE
+/* Core 0, after stdio_init_all() */
+void            console_init(void);
+/* Core 0:  pass on what's in the ring */
+void            console_drain(void);
+/* Core 1:  wait for space, rather than dropping output */
+void            console_set_wait(bool wait);
+#else
+/* Host build:  stdout */
+static inline void console_set_wait(bool wait) {}
+#endif
+
+#endif
@@ -0,0 +1,168 @@
+/* dvo: video transmitter driver selection, and common support
+ *
+ * Copyright 2022-2023 Matt Evans
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hw.h"
+#include "dvo.h"
+#include "dvo_drv.h"
+#include "vid_i2c.h"
+
+/* Drivers to probe, in order.  If none answers, the first is used anyway
+ * (so its status command can show what's wrong).
+ */
+static const dvo_ops_t *dvo_drivers[] = {
+        &dvo_adv7513_ops,
+        &dvo_tda19988_ops,
+};
+
+static const dvo_ops_t *dvo;
+static dvo_hpd_stats_t  hpd_stats;
+
+void    dvo_bus_scan()
+{
+        printf("--- Bus scan\r\n");
+        for (unsigned int addr = 0; addr < 128; addr++) {
+                int r;
+                uint8_t rxd;
+
+                printf("%02x: ", addr);
+
+                r = vid_i2c_read(addr, &rxd, 1);
+                printf(r < 0 ? "--" : "**");
+
+                printf((addr & 7) == 7 ? "\r\n" : "   ");
+        }
+        printf("--- Done.\r\n");
+}
+
+int     dvo_init()
+{
+        /* Drivers can speed this up, once they know what's there */
+        vid_i2c_init(100*1000);
+        gpio_init(MCU_VID_IRQ);
+        gpio_pull_up(MCU_VID_IRQ);      /* IRQ is open-drain, active low */
+
+        dvo = NULL;
+        for (unsigned int i = 0; i < sizeof(dvo_drivers)/sizeof(dvo_drivers[0]); i++) {
+                if (dvo_drivers[i]->probe()) {
+                        dvo = dvo_drivers[i];
+                        break;
+                }
+        }
+        if (dvo) {
+                printf("DVO: Found %s\r\n", dvo->name);
+        } else {
+                dvo = dvo_drivers[0];
+                printf("*** DVO: No transmitter found, assuming %s\r\n", dvo->name);
+        }
+        return dvo->init();
+}
+
+const char *dvo_name()
+{
+        return dvo ? dvo->name : "none";
+}
+
+int     dvo_status()
+{
+        printf("--- DVO: %s\r\n", dvo_name());
+        if (!dvo)
+                return -1;
+        int r = dvo->status();
+
+        printf("--- HPD: %d plugs, %d unplugs, restore last %dus max %dus\r\n",
+               hpd_stats.plugs, hpd_stats.unplugs, hpd_stats.last_us, hpd_stats.max_us);
+        vid_i2c_status();
+        return r;
+}
+
+int     dvo_set_timing(const dvo_timing_t *t)
+{
+        if (!dvo || !dvo->set_timing)
+                return 0;
+        return dvo->set_timing(t);
+}
+
+int     dvo_audio_config(unsigned int rate)
+{
+        if (!dvo || !dvo->set_audio)
+                return -1;
+        return dvo->set_audio(rate);
+}
+
+int     dvo_mute(bool muted)
+{
+        if (!dvo || !dvo->mute)
+                return -1;
+        return dvo->mute(muted);
+}
+
+int     dvo_edid_read(uint8_t *buf, unsigned int len)
+{
+        if (!dvo || !dvo->edid_read)
+                return -1;
+        return dvo->edid_read(buf, len);
+}
+
+void    dvo_edid_fetch(uint8_t *buf, unsigned int len, dvo_edid_cb_t done)
+{
+        if (!dvo || !dvo->edid_fetch || dvo->edid_fetch(buf, len, done) < 0)
+                done(-1);
+}
+
+void    dvo_edid_poll(void)
+{
+        if (dvo && dvo->edid_poll)
+                dvo->edid_poll();
+}
+
+int     dvo_service_irq(uint32_t irq_time)
+{
+        if (!dvo || !dvo->service_irq)
+                return DVO_HPD_NONE;
+
+        int r = dvo->service_irq();
+
+        if (r == DVO_HPD_UNPLUG) {
+                hpd_stats.unplugs++;
+                printf("DVO: HPD low, monitor disconnected\r\n");
+        } else if (r == DVO_HPD_PLUG) {
+                uint32_t t = time_us_32() - irq_time;
+
+                hpd_stats.plugs++;
+                hpd_stats.last_us = t;
+                if (t > hpd_stats.max_us)
+                        hpd_stats.max_us = t;
+                printf("DVO: HPD high, output restored in %dus\r\n", t);
+        }
+        return r;
+}
+
+void    dvo_get_hpd_stats(dvo_hpd_stats_t *s)
+{
+        *s = hpd_stats;
+}
@@ -25,9 +25,57 @@
 #ifndef DVO_H
 #define DVO_H
 
-/* Interface to video serialiser driver(s) */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Interface to video serialiser driver(s).  The part fitted is probed at
+ * dvo_init(), and calls go to its driver.
+ */
+
+/* Output timing, in output pixels/lines */
+typedef struct {
+        uint32_t        pclk_khz;
+        uint16_t        h_active, h_fp, h_sync, h_bp;
+        uint16_t        v_active, v_fp, v_sync, v_bp;
+} dvo_timing_t;
+
+/* Plug/unplug, from the transmitter's IRQ */
+#define DVO_HPD_NONE    0
+#define DVO_HPD_PLUG    1
+#define DVO_HPD_UNPLUG  2
+
+typedef struct {
+        unsigned int    plugs;
+        unsigned int    unplugs;
+        uint32_t        last_us;        /* IRQ to output restored */
+        uint32_t        max_us;
+} dvo_hpd_stats_t;
 
 int     dvo_init();
+/* Name of the detected part */
+const char *dvo_name();
 int     dvo_status();
+/* Probe every address on the transmitter's I2C bus */
+void    dvo_bus_scan();
+/* Called on each mode change, after the output timing's programmed */
+int     dvo_set_timing(const dvo_timing_t *t);
+/* I2S audio: returns -1 if the rate isn't supported */
+int     dvo_audio_config(unsigned int rate);
+int     dvo_mute(bool muted);
+/* Read the attached monitor's EDID (len up to 256), waiting for it */
+int     dvo_edid_read(uint8_t *buf, unsigned int len);
+/* Or fetch it in the background:  done is called from the main loop
+ * with 0 or -1 (straight away, if the part can't).  A new fetch replaces
+ * one in progress, and an unplug cancels one (done isn't called).  Call
+ * dvo_edid_poll() now and then meanwhile, to time it out.
+ */
+typedef void    (*dvo_edid_cb_t)(int result);
+void    dvo_edid_fetch(uint8_t *buf, unsigned int len, dvo_edid_cb_t done);
+void    dvo_edid_poll(void);
+/* Call when MCU_VID_IRQ is asserted; irq_time is time_us_32() at the
+ * edge, for measuring replug-to-picture time.  Returns DVO_HPD_*.
+ */
+int     dvo_service_irq(uint32_t irq_time);
+void    dvo_get_hpd_stats(dvo_hpd_stats_t *s);
 
 #endif
@@ -27,10 +27,12 @@
  */
 
 #include <stdio.h>
-#include "hardware/i2c.h"
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hw.h"
 #include "dvo.h"
+#include "dvo_drv.h"
+#include "vid_i2c.h"
 #include "dvo_adv7513.h"
 
 
@@ -44,21 +46,52 @@
 
 #define RR(x)		dvo_reg_read(VID_ADDR_MAIN, x)
 
-static void     vid_i2c_init()
+/* The ADV7513 is good for fast-mode I2C */
+#define VID_I2C_HZ              (400*1000)
+/* Longest burst written in one transaction */
+#define DVO_BURST_MAX           32
+
+/* Shadow of the main register map, so that programming a table of
+ * registers only writes those that differ from what the chip holds, in
+ * auto-increment bursts where they're contiguous.  A register is "known"
+ * when the shadow matches the chip, and "dirty" when the shadow has been
+ * set but not yet written.  Status/IRQ registers aren't shadowed:  they're
+ * accessed with dvo_reg_read()/dvo_reg_write(), and the latter forgets any
+ * shadowed value.
+ */
+static uint8_t          dvo_shadow[256];
+static uint32_t         dvo_known[256/32];
+static uint32_t         dvo_dirty[256/32];
+
+static struct {
+        unsigned int    written;        /* Registers written from the shadow */
+        unsigned int    skipped;        /* ...set to the value already held */
+        unsigned int    bursts;         /* I2C transactions to do so */
+        unsigned int    failed;         /* ...that failed */
+} dvo_shadow_stats;
+
+#define BIT_TEST(m, r)          ((m)[(r) >> 5] & (1u << ((r) & 31)))
+#define BIT_SET(m, r)           ((m)[(r) >> 5] |= (1u << ((r) & 31)))
+#define BIT_CLR(m, r)           ((m)[(r) >> 5] &= ~(1u << ((r) & 31)))
+
+static int      dvo_reg_write(uint8_t addr, uint8_t reg, uint8_t val)
 {
-        i2c_init(MCU_VID_I2C, 100*1000);
-        gpio_set_function(MCU_VID_SDA, GPIO_FUNC_I2C);
-        gpio_set_function(MCU_VID_SCL, GPIO_FUNC_I2C);
-        gpio_pull_up(MCU_VID_SDA);      /* Elides external P/U? */
-        gpio_pull_up(MCU_VID_SCL);
+        uint8_t buff[2];
+        buff[0] = reg;
+        buff[1] = val;
+        if (addr == VID_ADDR_MAIN)
+                BIT_CLR(dvo_known, reg);
+        return vid_i2c_write(addr, buff, 2);
 }
 
-static int      dvo_reg_write(uint8_t addr, uint8_t reg, uint8_t val)
+/* The same, queued:  goes out in the background, ahead of any later access */
+static void     dvo_reg_queue(uint8_t reg, uint8_t val)
 {
         uint8_t buff[2];
         buff[0] = reg;
         buff[1] = val;
-        return i2c_write_blocking(MCU_VID_I2C, addr, buff, 2, false);
+        BIT_CLR(dvo_known, reg);
+        vid_i2c_submit(VID_ADDR_MAIN, buff, 2, NULL, 0, NULL, NULL);
 }
 
 /* Returns 0-ff for byte, -1 for error */
@@ -66,104 +99,455 @@ static int	dvo_reg_read(uint8_t addr, uint8_t reg)
 {
 	int r;
 	uint8_t rxd;
-        uint8_t buff[2];
-        buff[0] = reg;
-        r = i2c_write_blocking(MCU_VID_I2C, addr, buff, 1, true); // No stop
-	if (r < 0)
-		return -1;
-	r = i2c_read_blocking(MCU_VID_I2C, addr, &rxd, 1, false);
+        r = vid_i2c_write_read(addr, &reg, 1, &rxd, 1);
 	return r < 0 ? -1 : rxd;
 }
 
-static void     i2c_scan()
+/* Auto-incrementing read of len regs starting at reg */
+static int      dvo_reg_read_burst(uint8_t addr, uint8_t reg, uint8_t *buf, unsigned int len)
 {
-        printf("--- Bus scan\r\n");
-        for (unsigned int addr = 0; addr < 128; addr++) {
-                int r;
-                uint8_t rxd;
+        return vid_i2c_write_read(addr, &reg, 1, buf, len) < 0 ? -1 : 0;
+}
 
-                printf("%02x: ", addr);
+static void     dvo_shadow_invalidate()
+{
+        memset(dvo_known, 0, sizeof(dvo_known));
+        memset(dvo_dirty, 0, sizeof(dvo_dirty));
+}
 
-                r = i2c_read_blocking(MCU_VID_I2C, addr, &rxd, 1, false);
-                printf(r < 0 ? "--" : "**");
+/* Fill the shadow from the chip, in one burst */
+static int      dvo_shadow_load()
+{
+        dvo_shadow_invalidate();
+        if (dvo_reg_read_burst(VID_ADDR_MAIN, 0, dvo_shadow, sizeof(dvo_shadow)) < 0)
+                return -1;
+        memset(dvo_known, 0xff, sizeof(dvo_known));
+        return 0;
+}
+
+/* Queue a write; nothing happens on the bus until dvo_reg_flush() */
+static void     dvo_reg_set(uint8_t reg, uint8_t val)
+{
+        if (BIT_TEST(dvo_known, reg) && !BIT_TEST(dvo_dirty, reg) && dvo_shadow[reg] == val) {
+                dvo_shadow_stats.skipped++;
+                return;
+        }
+        dvo_shadow[reg] = val;
+        BIT_SET(dvo_dirty, reg);
+}
+
+/* Shadowed value, read from the chip if not known */
+static int      dvo_reg_get(uint8_t reg)
+{
+        if (BIT_TEST(dvo_known, reg) || BIT_TEST(dvo_dirty, reg))
+                return dvo_shadow[reg];
+
+        int r = RR(reg);
 
-                printf((addr & 7) == 7 ? "\r\n" : "   ");
+        if (r >= 0) {
+                dvo_shadow[reg] = r;
+                BIT_SET(dvo_known, reg);
         }
-        printf("--- Done.\r\n");
+        return r;
+}
+
+/* A flushed burst failed:  don't know what made it.  arg is the first
+ * register, plus count << 8.
+ */
+static void     dvo_reg_flush_done(int result, void *arg)
+{
+        unsigned int first = (uintptr_t)arg & 0xff;
+        unsigned int n = (uintptr_t)arg >> 8;
+
+        if (result >= 0)
+                return;
+        for (unsigned int i = first; i < first + n; i++)
+                BIT_CLR(dvo_known, i);
+        dvo_shadow_stats.failed++;
 }
 
-int     dvo_init_output()
+/* Queue writes of dirty registers, a contiguous run per transaction.  They
+ * go out in the background, ahead of any later access.
+ */
+static void     dvo_reg_flush()
 {
-	i2c_scan();
+        uint8_t buf[1 + DVO_BURST_MAX];
+        unsigned int reg = 0;
 
-	VDB(" HW rev 0x%02x\r\n", dvo_reg_read(VID_ADDR_MAIN, VIDR_CHIP_REV));
+        while (reg < 256) {
+                if (!BIT_TEST(dvo_dirty, reg)) {
+                        reg++;
+                        continue;
+                }
+                unsigned int n = 0;
 
-	/* FIXME: Should monitor the HPD signal (reg VIDR_STATUS0 bit 6) and release powerdown when high.
-	 * The input HPD value can be overridden using the HPD Control reg; it's useful to wire this high
-	 * so that plug/unplug doesn't need detection/reconfiguration each time.
-	 *
-	 * Currently, I'm hoping this also overrides the fact that some regs are reset when HPD goes low.
+                buf[0] = reg;
+                while (reg < 256 && n < DVO_BURST_MAX && BIT_TEST(dvo_dirty, reg)) {
+                        buf[1 + n++] = dvo_shadow[reg];
+                        BIT_CLR(dvo_dirty, reg);
+                        BIT_SET(dvo_known, reg);
+                        reg++;
+                }
+                vid_i2c_submit(VID_ADDR_MAIN, buf, 1 + n, NULL, 0,
+                               dvo_reg_flush_done, (void *)(uintptr_t)(buf[0] | (n << 8)));
+                dvo_shadow_stats.written += n;
+                dvo_shadow_stats.bursts++;
+        }
+}
+
+/* Registers that are reset whilst HPD is low, so must be rewritten after
+ * every (re)plug.  From the manual's 'quick start' init sequence, plus the
+ * input format and interrupt enables.  The chip only powers up with HPD
+ * high, so VIDR_POWER must go first.
+ */
+static const struct {
+        uint8_t reg;
+        uint8_t val;
+} dvo_output_regs[] = {
+        { VIDR_POWER,           VIDR_POWER_RESVD },
+        { VIDR_MISC0,           VIDR_MISC0_VAL },
+        { VIDR_MISC1,           VIDR_MISC1_VAL },
+        { VIDR_MISC2,           VIDR_MISC2_VAL },
+        { VIDR_PCLK_DIV,        VIDR_PCLK_DIV_RESVD },
+        { VIDR_MISC3,           VIDR_MISC3_VAL },
+        { VIDR_MISC4,           VIDR_MISC4_VAL },
+        { VIDR_MISC5,           VIDR_MISC5_VAL },
+        { VIDR_MISC6,           VIDR_MISC6_VAL },
+        { VIDR_IO_FORMAT,       0x30 },
+        { VIDR_INT_EN0,         VIDR_INT0_HPD | VIDR_INT0_MSEN | VIDR_INT0_EDID_READY },
+};
+
+/* Background EDID fetch state; see adv7513_edid_fetch() */
+enum { EDID_IDLE, EDID_CTRL, EDID_WAIT, EDID_READ };
+
+static struct {
+        int             state;
+        uintptr_t       gen;            /* Callbacks for other fetches are stale */
+        uint8_t         ctrl;
+        uint8_t         *buf;
+        unsigned int    len;
+        uint32_t        wait_start;
+        dvo_edid_cb_t   done;
+} edid_fetch;
+
+/* Last audio config, replayed after a replug */
+static unsigned int     dvo_audio_rate;
+static bool             dvo_audio_muted;
+
+static int      adv7513_set_audio(unsigned int rate);
+static int      adv7513_mute(bool muted);
+static void     adv7513_edid_cancel(void);
+static void     adv7513_edid_ready(void);
+
+static void     dvo_write_output_regs()
+{
+        /* A flush goes in register order, so power up in one of its own: */
+        dvo_reg_set(dvo_output_regs[0].reg, dvo_output_regs[0].val);
+        dvo_reg_flush();
+        for (unsigned int i = 1; i < sizeof(dvo_output_regs)/sizeof(dvo_output_regs[0]); i++)
+                dvo_reg_set(dvo_output_regs[i].reg, dvo_output_regs[i].val);
+        dvo_reg_flush();
+}
+
+static int      adv7513_init_output()
+{
+        if (dvo_shadow_load() < 0) {
+                VDB("*** ADV7513 not responding\r\n");
+                dvo_shadow_invalidate();
+        }
+
+	VDB(" HW rev 0x%02x\r\n", dvo_reg_get(VIDR_CHIP_REV));
+
+	/* HPD comes from the pin, and the transmitter's IRQ (on MCU_VID_IRQ)
+	 * reports plug/unplug.  Some regs are reset when HPD goes low, so
+	 * adv7513_service_irq() replays dvo_output_regs[] on replug.
 	 */
-	dvo_reg_write(VID_ADDR_MAIN, VIDR_HPD_CONTROL, VIDR_HPD_CONTROL_HIGH);
+	dvo_reg_set(VIDR_HPD_CONTROL, VIDR_HPD_CONTROL_HPD);
+	dvo_reg_write(VID_ADDR_MAIN, VIDR_INT0, 0xff);
 
-	/* From the manual's 'quick start' init sequence: */
-	dvo_reg_write(VID_ADDR_MAIN, VIDR_POWER, VIDR_POWER_RESVD);
+	dvo_write_output_regs();
 	sleep_ms(10);
-	dvo_reg_write(VID_ADDR_MAIN, VIDR_MISC0, VIDR_MISC0_VAL);
-	dvo_reg_write(VID_ADDR_MAIN, VIDR_MISC1, VIDR_MISC1_VAL);
-	dvo_reg_write(VID_ADDR_MAIN, VIDR_MISC2, VIDR_MISC2_VAL);
-	dvo_reg_write(VID_ADDR_MAIN, VIDR_PCLK_DIV, VIDR_PCLK_DIV_RESVD);
-	dvo_reg_write(VID_ADDR_MAIN, VIDR_MISC3, VIDR_MISC3_VAL);
-	dvo_reg_write(VID_ADDR_MAIN, VIDR_MISC4, VIDR_MISC4_VAL);
-	dvo_reg_write(VID_ADDR_MAIN, VIDR_MISC5, VIDR_MISC5_VAL);
-	dvo_reg_write(VID_ADDR_MAIN, VIDR_MISC6, VIDR_MISC6_VAL);
-
-	dvo_reg_write(VID_ADDR_MAIN, 0x16, 0x30);
 
         return 0;
 }
 
-int     dvo_init()
+/* Service the transmitter's IRQ.  On replug, this skips everything
+ * adv7513_init_output() does that isn't needed to get the output back
+ * (shadow load, settle delay).
+ */
+static int      adv7513_service_irq()
+{
+        /* Only an EDID fetch that was waiting before INT0 was read can
+         * trust its EDID_READY (rather than a stale one):
+         */
+        bool edid_waiting = edid_fetch.state == EDID_WAIT;
+        int int0 = RR(VIDR_INT0);
+        int status = RR(VIDR_STATUS0);
+
+        if (int0 < 0 || status < 0)
+                return DVO_HPD_NONE;
+        dvo_reg_write(VID_ADDR_MAIN, VIDR_INT0, int0);
+
+        if ((int0 & VIDR_INT0_EDID_READY) && edid_waiting)
+                adv7513_edid_ready();
+
+        if (!(int0 & (VIDR_INT0_HPD | VIDR_INT0_MSEN)))
+                return DVO_HPD_NONE;
+
+        if (!(status & VIDR_STATUS0_HPD)) {
+                /* Whatever HPD low resets is no longer known: */
+                dvo_shadow_invalidate();
+                /* ...and there's no EDID to be had */
+                adv7513_edid_cancel();
+                return DVO_HPD_UNPLUG;
+        }
+
+        /* In case the unplug was missed: */
+        dvo_shadow_invalidate();
+        dvo_write_output_regs();
+        if (dvo_audio_rate) {
+                adv7513_set_audio(dvo_audio_rate);
+                adv7513_mute(dvo_audio_muted);
+        }
+        return DVO_HPD_PLUG;
+}
+
+static bool     adv7513_probe()
+{
+        return dvo_reg_read(VID_ADDR_MAIN, VIDR_CHIP_REV) >= 0;
+}
+
+static int      adv7513_init()
 {
         VDB("+++ DVO adv7513 init:\r\n");
 
-        vid_i2c_init();
+        vid_i2c_set_baud(VID_I2C_HZ);
 
         /* OK... now probe some of dem regs */
-        dvo_init_output();
+        adv7513_init_output();
 
         VDB("    Done\r\n");
+        return 0;
+}
+
+/* Audio clock regeneration N values (HDMI 1.4 table 7-1, for any TMDS
+ * clock without an exact CTS; CTS is measured automatically).
+ */
+static const struct {
+        unsigned int    rate;
+        uint32_t        n;
+        uint8_t         freq;
+} audio_rates[] = {
+        { 32000, 4096, VIDR_I2S_FREQ_32K },
+        { 44100, 6272, VIDR_I2S_FREQ_44K1 },
+        { 48000, 6144, VIDR_I2S_FREQ_48K },
+};
+
+/* Set up I2S audio input, 16-bit stereo at the given rate */
+static int      adv7513_set_audio(unsigned int rate)
+{
+        unsigned int i;
+
+        for (i = 0; i < sizeof(audio_rates)/sizeof(audio_rates[0]); i++) {
+                if (audio_rates[i].rate == rate)
+                        break;
+        }
+        if (i == sizeof(audio_rates)/sizeof(audio_rates[0]))
+                return -1;
+
+        uint32_t n = audio_rates[i].n;
+
+        dvo_audio_rate = rate;
+
+        dvo_reg_set(VIDR_N0, (n >> 16) & 0x0f);
+        dvo_reg_set(VIDR_N1, (n >> 8) & 0xff);
+        dvo_reg_set(VIDR_N2, n & 0xff);
+        dvo_reg_set(VIDR_AUDIO_SRC, VIDR_AUDIO_SRC_I2S | VIDR_AUDIO_SRC_MCLK_256);
+        dvo_reg_set(VIDR_I2S_CFG, VIDR_I2S_CFG_EN0 | VIDR_I2S_CFG_STD);
+        dvo_reg_set(VIDR_I2S_WORDLEN, VIDR_I2S_WORDLEN_16);
+        dvo_reg_set(VIDR_I2S_FREQ,
+                    (dvo_reg_get(VIDR_I2S_FREQ) & ~VIDR_I2S_FREQ_MASK) | audio_rates[i].freq);
+        /* Audio packets are only sent in HDMI mode.  FIXME: DVI sinks (per
+         * EDID) should stay in DVI mode.
+         */
+        dvo_reg_set(VIDR_HDCP_HDMI, dvo_reg_get(VIDR_HDCP_HDMI) | VIDR_HDCP_HDMI_HDMI);
+        dvo_reg_flush();
+        return 0;
+}
+
+#define EDID_TIMEOUT_MS         200
+
+/* The ADV7513 fetches EDID over DDC itself, into memory readable at
+ * VID_ADDR_EDID.  Ask it to re-read (queued), clearing EDID_READY first.
+ */
+static void     adv7513_edid_request(uint8_t ctrl)
+{
+        ctrl &= ~VIDR_EDID_CTRL_REREAD;
+        dvo_reg_queue(VIDR_EDID_ADDR, VID_ADDR_EDID << 1);
+        dvo_reg_queue(VIDR_INT0, VIDR_INT0_EDID_READY);
+        dvo_reg_queue(VIDR_EDID_CTRL, ctrl | VIDR_EDID_CTRL_REREAD);
+        dvo_reg_queue(VIDR_EDID_CTRL, ctrl);
+}
+
+/* Waiting for it, then reading it out in one burst */
+static int      adv7513_edid_read(uint8_t *buf, unsigned int len)
+{
+        int i, r;
+        int ctrl;
+
+        /* This replaces any fetch in the background */
+        adv7513_edid_cancel();
+        ctrl = RR(VIDR_EDID_CTRL);
+        if (ctrl < 0)
+                return -1;
+        adv7513_edid_request(ctrl);
+
+        for (i = 0; i < EDID_TIMEOUT_MS; i++) {
+                r = RR(VIDR_INT0);
+                if (r < 0)
+                        return -1;
+                if (r & VIDR_INT0_EDID_READY)
+                        break;
+                sleep_ms(1);
+        }
+        if (i == EDID_TIMEOUT_MS) {
+                VDB("*** EDID read timeout\r\n");
+                return -1;
+        }
+
+        return dvo_reg_read_burst(VID_ADDR_EDID, 0, buf, len);
+}
+
+/* Or in the background, for replugs, so the main loop carries on whilst
+ * the DDC's read:  a queued read of VIDR_EDID_CTRL, whose callback queues
+ * the request; VIDR_INT0_EDID_READY (an IRQ) then has
+ * adv7513_service_irq() queue the read-out, whose callback reports the
+ * result.  A fetch that's replaced, or cancelled by an unplug, isn't
+ * reported.
+ */
+static void     adv7513_edid_finish(int result)
+{
+        dvo_edid_cb_t done = edid_fetch.done;
+
+        edid_fetch.state = EDID_IDLE;
+        edid_fetch.gen++;
+        done(result);
+}
+
+static void     adv7513_edid_read_done(int result, void *arg)
+{
+        if ((uintptr_t)arg != edid_fetch.gen)
+                return;
+        adv7513_edid_finish(result < 0 ? -1 : 0);
+}
+
+static void     adv7513_edid_ctrl_done(int result, void *arg)
+{
+        if ((uintptr_t)arg != edid_fetch.gen)
+                return;
+        if (result < 0) {
+                adv7513_edid_finish(-1);
+                return;
+        }
+        adv7513_edid_request(edid_fetch.ctrl);
+        edid_fetch.state = EDID_WAIT;
+        edid_fetch.wait_start = time_us_32();
+}
+
+static int      adv7513_edid_fetch(uint8_t *buf, unsigned int len, dvo_edid_cb_t done)
+{
+        static const uint8_t reg = VIDR_EDID_CTRL;
+
+        adv7513_edid_cancel();
+        edid_fetch.state = EDID_CTRL;
+        edid_fetch.buf = buf;
+        edid_fetch.len = len;
+        edid_fetch.done = done;
+        vid_i2c_submit(VID_ADDR_MAIN, &reg, 1, &edid_fetch.ctrl, 1,
+                       adv7513_edid_ctrl_done, (void *)edid_fetch.gen);
+        return 0;
+}
+
+/* From adv7513_service_irq(), with the fetch waiting */
+static void     adv7513_edid_ready(void)
+{
+        static const uint8_t start = 0;
+
+        edid_fetch.state = EDID_READ;
+        vid_i2c_submit(VID_ADDR_EDID, &start, 1, edid_fetch.buf, edid_fetch.len,
+                       adv7513_edid_read_done, (void *)edid_fetch.gen);
+}
+
+/* No EDID_READY (no DDC, or a missed IRQ) */
+static void     adv7513_edid_poll(void)
+{
+        if (edid_fetch.state == EDID_WAIT &&
+            time_us_32() - edid_fetch.wait_start >= EDID_TIMEOUT_MS * 1000) {
+                VDB("*** EDID fetch timeout\r\n");
+                adv7513_edid_finish(-1);
+        }
+}
+
+static void     adv7513_edid_cancel(void)
+{
+        if (edid_fetch.state != EDID_IDLE) {
+                edid_fetch.state = EDID_IDLE;
+                edid_fetch.gen++;
+        }
 }
 
 /* Mute I2S audio */
-int     dvo_mute(bool muted)
+static int      adv7513_mute(bool muted)
 {
+        dvo_audio_muted = muted;
+        dvo_reg_set(VIDR_I2S_CFG, muted ? VIDR_I2S_CFG_STD : (VIDR_I2S_CFG_EN0 | VIDR_I2S_CFG_STD));
+        dvo_reg_flush();
+        return 0;
 }
 
-int	dvo_status()
+static int      adv7513_status()
 {
-	/* Dump regs */
+        uint8_t regs[256];
+
+	/* Dump regs, in one go */
+        if (dvo_reg_read_burst(VID_ADDR_MAIN, 0, regs, sizeof(regs)) < 0) {
+                printf("--- ADV7513 not responding\r\n");
+                return -1;
+        }
         printf("--- ADV7513 reg space:\r\n");
         for (unsigned int addr = 0; addr < 0x100; addr++) {
-                int r;
-                uint8_t rxd;
-
                 printf("%02x: ", addr);
-
-		rxd = RR(addr);
-                printf("%02x ", rxd);
-
+                printf("%02x ", regs[addr]);
                 printf((addr & 15) == 15 ? "\r\n" : "  ");
         }
         printf("--- CTS %06x, SPDIF_SAMP %x\r\n",
-	       ((unsigned int)(RR(VIDR_CTS0) & 0x0f) << 16) |
-	       ((unsigned int)RR(VIDR_CTS1) << 8) |
-	       RR(VIDR_CTS2),
-	       RR(VIDR_CTS0) >> 4);
+	       ((unsigned int)(regs[VIDR_CTS0] & 0x0f) << 16) |
+	       ((unsigned int)regs[VIDR_CTS1] << 8) |
+	       regs[VIDR_CTS2],
+	       regs[VIDR_CTS0] >> 4);
         printf("--- VIC_RPT_RX %02x, VIC_ACTUAL %02x, VIC_AUX_PROG_INFO %02x\r\n",
-	       RR(VIDR_VIC_RPT_RX), RR(VIDR_VIC_ACTUAL), RR(VIDR_VIC_AUX_PROG_INFO));
+	       regs[VIDR_VIC_RPT_RX], regs[VIDR_VIC_ACTUAL], regs[VIDR_VIC_AUX_PROG_INFO]);
         printf("--- STATUS0 %02x, PLL %02x, ENC %02x, DDC %02x\r\n",
-	       RR(VIDR_STATUS0), RR(VIDR_PLL_STATUS), RR(VIDR_ENC_STATUS), RR(VIDR_DDC_STATUS));
+	       regs[VIDR_STATUS0], regs[VIDR_PLL_STATUS], regs[VIDR_ENC_STATUS], regs[VIDR_DDC_STATUS]);
+        printf("--- Shadow: %d regs written in %d bursts (%d failed), %d unchanged skipped\r\n",
+               dvo_shadow_stats.written, dvo_shadow_stats.bursts, dvo_shadow_stats.failed,
+               dvo_shadow_stats.skipped);
 
 	return 0;
 }
+
+/* The ADV7513 takes its timing from the HS/VS/DE inputs, so needs nothing
+ * per mode.
+ */
+const dvo_ops_t dvo_adv7513_ops = {
+        .name = "ADV7513",
+        .probe = adv7513_probe,
+        .init = adv7513_init,
+        .set_audio = adv7513_set_audio,
+        .mute = adv7513_mute,
+        .status = adv7513_status,
+        .edid_read = adv7513_edid_read,
+        .edid_fetch = adv7513_edid_fetch,
+        .edid_poll = adv7513_edid_poll,
+        .service_irq = adv7513_service_irq,
+};
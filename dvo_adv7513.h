@@ -42,11 +42,31 @@
 #define VIDR_VIC_ACTUAL			0x3e
 #define VIDR_VIC_AUX_PROG_INFO		0x3f
 #define VIDR_STATUS0			0x42	/* My name: HPD state, monitor sense, I2S mode det */
+#define 	VIDR_STATUS0_HPD		0x40
+#define 	VIDR_STATUS0_MSEN		0x20
 #define VIDR_PLL_STATUS			0x9e
 #define VIDR_ENC_STATUS			0xb8
 #define VIDR_DDC_STATUS			0xc8
 
 /* Control regs */
+#define VIDR_N0				0x01	/* Bits 3:0 = N[19:16] */
+#define VIDR_N1				0x02
+#define VIDR_N2				0x03
+#define VIDR_AUDIO_SRC			0x0a
+#define 	VIDR_AUDIO_SRC_CTS_MANUAL	0x80
+#define 	VIDR_AUDIO_SRC_I2S		0x00	/* Bits 6:4 */
+#define 	VIDR_AUDIO_SRC_MCLK_256		0x01
+#define VIDR_I2S_CFG			0x0c
+#define 	VIDR_I2S_CFG_EN_MASK		0x3c	/* One bit per I2S input */
+#define 	VIDR_I2S_CFG_EN0		0x04
+#define 	VIDR_I2S_CFG_STD		0x00	/* Bits 1:0 = format */
+#define VIDR_I2S_WORDLEN		0x14	/* Bits 3:0 */
+#define 	VIDR_I2S_WORDLEN_16		0x02
+#define VIDR_I2S_FREQ			0x15	/* Bits 7:4 */
+#define 	VIDR_I2S_FREQ_44K1		0x00
+#define 	VIDR_I2S_FREQ_48K		0x20
+#define 	VIDR_I2S_FREQ_32K		0x30
+#define 	VIDR_I2S_FREQ_MASK		0xf0
 #define VIDR_IO_FORMAT			0x16
 #define 	VIDR_IO_FORMAT_422		0x80
 #define 	VIDR_IO_FORMAT_DEPTH_12		0x20
@@ -72,6 +92,16 @@
 #define 	VIDR_MISC3_VAL			0xa4
 #define VIDR_MISC4			0xa3
 #define 	VIDR_MISC4_VAL			0xa4
+#define VIDR_EDID_ADDR			0x43	/* I2C address (8-bit) of EDID memory */
+#define VIDR_INT_EN0			0x94	/* Same bits as VIDR_INT0 */
+#define VIDR_INT0			0x96	/* Write 1 to clear */
+#define 	VIDR_INT0_HPD			0x80
+#define 	VIDR_INT0_MSEN			0x40
+#define 	VIDR_INT0_EDID_READY		0x04
+#define VIDR_HDCP_HDMI			0xaf
+#define 	VIDR_HDCP_HDMI_HDMI		0x02	/* HDMI (vs DVI) mode */
+#define VIDR_EDID_CTRL			0xc9
+#define 	VIDR_EDID_CTRL_REREAD		0x10
 #define VIDR_HPD_CONTROL		0xd6
 #define 	VIDR_HPD_CONTROL_CDC		0x40
 #define 	VIDR_HPD_CONTROL_HPD		0x80
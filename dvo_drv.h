@@ -0,0 +1,58 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DVO_DRV_H
+#define DVO_DRV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dvo.h"
+
+/* Interface from dvo.c to the transmitter drivers.  Optional ops are NULL
+ * when the part doesn't need (or support) them.
+ */
+typedef struct {
+        const char      *name;
+        /* Is this part on the bus?  Called with the bus at 100kHz. */
+        bool            (*probe)(void);
+        int             (*init)(void);
+        int             (*set_timing)(const dvo_timing_t *t);     /* Optional */
+        int             (*set_audio)(unsigned int rate);          /* Optional */
+        int             (*mute)(bool muted);                      /* Optional */
+        int             (*status)(void);
+        int             (*edid_read)(uint8_t *buf, unsigned int len); /* Optional */
+        /* Start one in the background (see dvo_edid_fetch()); -1 if it
+         * can't be, in which case done isn't called.  Optional.
+         */
+        int             (*edid_fetch)(uint8_t *buf, unsigned int len, dvo_edid_cb_t done);
+        /* Time out a background fetch; optional */
+        void            (*edid_poll)(void);
+        /* Returns DVO_HPD_* */
+        int             (*service_irq)(void);                     /* Optional */
+} dvo_ops_t;
+
+extern const dvo_ops_t dvo_adv7513_ops;
+extern const dvo_ops_t dvo_tda19988_ops;
+
+#endif
@@ -27,10 +27,11 @@
  */
 
 #include <stdio.h>
-#include "hardware/i2c.h"
 #include "pico/stdlib.h"
 #include "hw.h"
 #include "dvo.h"
+#include "dvo_drv.h"
+#include "vid_i2c.h"
 #include "dvo_tda19988.h"
 
 
@@ -43,21 +44,22 @@
 #endif
 
 
-static void     vid_i2c_init()
-{
-        i2c_init(MCU_VID_I2C, 100*1000);
-        gpio_set_function(MCU_VID_SDA, GPIO_FUNC_I2C);
-        gpio_set_function(MCU_VID_SCL, GPIO_FUNC_I2C);
-        gpio_pull_up(MCU_VID_SDA);      /* Elides external P/U? */
-        gpio_pull_up(MCU_VID_SCL);
-}
-
 static int      dvo_reg_write(uint8_t addr, uint8_t reg, uint8_t val)
 {
         uint8_t buff[2];
         buff[0] = reg;
         buff[1] = val;
-        return i2c_write_blocking(MCU_VID_I2C, addr, buff, 2, false);
+        return vid_i2c_write(addr, buff, 2);
+}
+
+/* Write a 16-bit value to a (current page) register pair, MSB first */
+static int      dvo_reg_write16(uint8_t reg, unsigned int val)
+{
+        uint8_t buff[3];
+        buff[0] = reg;
+        buff[1] = val >> 8;
+        buff[2] = val & 0xff;
+        return vid_i2c_write(VID_ADDR_HDMI, buff, 3);
 }
 
 static void     dvo_testcard()
@@ -71,7 +73,61 @@ static void     dvo_testcard()
         dvo_reg_write(VID_ADDR_HDMI, 0xf0, 0x00);             /* RPT_CNTRL */
 }
 
-int     dvo_init_output()
+/* Program the timing generator for a mode.  It's used to place the
+ * HDMI data islands, so must match the input; these are the tda998x
+ * (Linux) driver's derivations, for progressive modes.  The serialiser
+ * divider depends on the pixel clock, too.
+ */
+static int      tda19988_set_timing(const dvo_timing_t *t)
+{
+        unsigned int n_pix = t->h_active + t->h_fp + t->h_sync + t->h_bp;
+        unsigned int n_line = t->v_active + t->v_fp + t->v_sync + t->v_bp;
+        unsigned int hs_pix_s = t->h_fp;
+        unsigned int hs_pix_e = t->h_fp + t->h_sync;
+        unsigned int vwin_s = n_line - t->v_active - 1;
+        unsigned int div = 0;
+
+        VDB("TDA timing: %dx%d, total %dx%d, %dkHz\n",
+            t->h_active, t->v_active, n_pix, n_line, t->pclk_khz);
+
+        if (t->pclk_khz) {
+                unsigned int d = 148500 / t->pclk_khz;
+
+                while (d > 1 && div < 4) {
+                        d >>= 1;
+                        div++;
+                }
+        }
+        dvo_reg_write(VID_ADDR_HDMI, TDA_REG_PAGE, TDA_PAGE_PLL);
+        dvo_reg_write(VID_ADDR_HDMI, TDA_REG_PLL_SERIAL_2, div);
+        dvo_reg_write(VID_ADDR_HDMI, TDA_REG_PAGE, 0);
+
+        dvo_reg_write(VID_ADDR_HDMI, TDA_REG_VIDFORMAT, 0);
+        dvo_reg_write16(TDA_REG_REFPIX, 3 + hs_pix_s);
+        dvo_reg_write16(TDA_REG_REFLINE, 1 + t->v_fp);
+        dvo_reg_write16(TDA_REG_NPIX, n_pix);
+        dvo_reg_write16(TDA_REG_NLINE, n_line);
+        dvo_reg_write16(TDA_REG_VS_LINE_STRT_1, t->v_fp);
+        dvo_reg_write16(TDA_REG_VS_PIX_STRT_1, hs_pix_s);
+        dvo_reg_write16(TDA_REG_VS_LINE_END_1, t->v_fp + t->v_sync);
+        dvo_reg_write16(TDA_REG_VS_PIX_END_1, hs_pix_s);
+        dvo_reg_write16(TDA_REG_HS_PIX_START, hs_pix_s);
+        dvo_reg_write16(TDA_REG_HS_PIX_STOP, hs_pix_e);
+        dvo_reg_write16(TDA_REG_VWIN_START_1, vwin_s);
+        dvo_reg_write16(TDA_REG_VWIN_END_1, vwin_s + t->v_active);
+        dvo_reg_write16(TDA_REG_DE_START, n_pix - t->h_active);
+        dvo_reg_write16(TDA_REG_DE_STOP, n_pix);
+        return 0;
+}
+
+/* Until the first mode's set, plain VGA */
+static const dvo_timing_t tda_default_timing = {
+        .pclk_khz = 25175,
+        .h_active = 640, .h_fp = 16, .h_sync = 96, .h_bp = 48,
+        .v_active = 480, .v_fp = 10, .v_sync = 2, .v_bp = 33,
+};
+
+static int      tda19988_init_output()
 {
         // Set up VGA, "putthrough" mode
         dvo_reg_write(VID_ADDR_CEC, 0xff, 0x87);              /* Enable clocks */
@@ -81,74 +137,9 @@ int     dvo_init_output()
         dvo_reg_write(VID_ADDR_HDMI, 0xe4, 0);                /* Test mode off */
         dvo_reg_write(VID_ADDR_HDMI, 0xf0, 0x00);             /* RPT_CNTRL */
 
-        unsigned int c_refpix;
-        unsigned int c_refline;
-        unsigned int c_xpix, c_ypix;
-        unsigned int c_vs_start, c_vs_start_pixel, c_vs_end, c_vs_end_pixel;
-        unsigned int c_hs_start_pixel;
-        unsigned int c_vwin_start, c_vwin_end;
-        unsigned int c_de_start_pixel, c_de_end_pixel;
-
-        /* These work for plain VGA (hfp 16, hsw 96, hbp 44, vfp 10, vsw 2, vbp 31),
-         * but also seem to work for 640x512 with the same porch sizes...!
-         *
-         * errrrrrrrr.... 800x600 also works.  WTAF, why does the TDA even need these
-         * things programmed?  (Nobody else requires it :P )
-         * 1152x896@50Hz (125MHz pclk) also works, with the exact same parameters.
-         *
-         * These magic resolution numbers are inspired by the NXP-published
-         * LPC example code.
-         */
-        c_refpix = 857;
-        c_refline = 4;
-        c_xpix = 798;
-        c_ypix = 555;
-        c_vs_start = 10;
-        c_vs_start_pixel = 36;
-        c_vs_end = 12;
-        c_vs_end_pixel = 36;
-        c_hs_start_pixel = 16;
-        c_vwin_start = 36;
-        c_vwin_end = 555;
-        c_de_start_pixel = 160;
-        c_de_end_pixel = 800;
-
-        dvo_reg_write(VID_ADDR_HDMI, 0xa0, 0);                /* Video format 0 = VGA */
-
-        dvo_reg_write(VID_ADDR_HDMI, 0xa1, c_refpix >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xa2, c_refpix & 0xff);
-        dvo_reg_write(VID_ADDR_HDMI, 0xa3, c_refline >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xa4, c_refline & 0xff);
-
-        dvo_reg_write(VID_ADDR_HDMI, 0xa5, c_xpix >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xa6, c_xpix & 0xff);
-        dvo_reg_write(VID_ADDR_HDMI, 0xa7, c_ypix >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xa8, c_ypix & 0xff);
-
-        dvo_reg_write(VID_ADDR_HDMI, 0xa9, c_vs_start >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xaa, c_vs_start & 0xff);
-        dvo_reg_write(VID_ADDR_HDMI, 0xab, c_vs_start_pixel >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xac, c_vs_start_pixel & 0xff);
-
-        dvo_reg_write(VID_ADDR_HDMI, 0xad, c_vs_end >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xae, c_vs_end & 0xff);
-        dvo_reg_write(VID_ADDR_HDMI, 0xaf, c_vs_end_pixel >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xb0, c_vs_end_pixel & 0xff);
-
-        dvo_reg_write(VID_ADDR_HDMI, 0xb9, c_hs_start_pixel >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xba, c_hs_start_pixel & 0xff);
-
-        dvo_reg_write(VID_ADDR_HDMI, 0xbd, c_vwin_start >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xbe, c_vwin_start & 0xff);
-        dvo_reg_write(VID_ADDR_HDMI, 0xbf, c_vwin_end >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xc0, c_vwin_end & 0xff);
-
-        dvo_reg_write(VID_ADDR_HDMI, 0xc5, c_de_start_pixel >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xc6, c_de_start_pixel & 0xff);
-        dvo_reg_write(VID_ADDR_HDMI, 0xc7, c_de_end_pixel >> 8);
-        dvo_reg_write(VID_ADDR_HDMI, 0xc8, c_de_end_pixel & 0xff);
-
-        dvo_reg_write(VID_ADDR_HDMI, 0xcb, 0x7c);             /* TBG_CNTRL1 ??? */
+        tda19988_set_timing(&tda_default_timing);
+
+        dvo_reg_write(VID_ADDR_HDMI, TDA_REG_TBG_CNTRL_1, 0x7c); /* TBG_CNTRL_1 ??? */
         dvo_reg_write(VID_ADDR_HDMI, 0x20, 0x23);             /* swapA=2, swapB=3 */
         dvo_reg_write(VID_ADDR_HDMI, 0x21, 0x45);             /* swapC=4, swapD=5 */
         dvo_reg_write(VID_ADDR_HDMI, 0x22, 0x01);             /* swapE=0, swapF=1 */
@@ -159,22 +150,24 @@ int     dvo_init_output()
         return 0;
 }
 
-int     dvo_init()
+/* The CEC core answers without its clocks enabled */
+static bool     tda19988_probe()
 {
-        VDB("+++ video_tda19988 init:\n");
+        uint8_t rxd;
 
-        vid_i2c_init();
+        return vid_i2c_read(VID_ADDR_CEC, &rxd, 1) >= 0;
+}
+
+static int      tda19988_init()
+{
+        VDB("+++ video_tda19988 init:\n");
 
         /* OK... now probe some of dem regs */
 //        dvo_testcard();
-        dvo_init_output();
+        tda19988_init_output();
 
         VDB("    Done\n");
-}
-
-/* Mute I2S audio */
-int     dvo_mute(bool muted)
-{
+        return 0;
 }
 
 /* Misc:
@@ -183,7 +176,16 @@ int     dvo_mute(bool muted)
  * - EDID?
  */
 
-int	dvo_status()
+static int      tda19988_status()
 {
 	return 0;
 }
+
+/* FIXME: audio, EDID and hot-plug aren't wired up for this part */
+const dvo_ops_t dvo_tda19988_ops = {
+        .name = "TDA19988",
+        .probe = tda19988_probe,
+        .init = tda19988_init,
+        .set_timing = tda19988_set_timing,
+        .status = tda19988_status,
+};
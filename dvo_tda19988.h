@@ -33,4 +33,28 @@
 
 #define TDA_REG_PAGE            0xff
 
+/* Page 0: video input/timing generator.  16-bit values are MSB first, at
+ * the given register and the next.
+ */
+#define TDA_REG_VIDFORMAT       0xa0
+#define TDA_REG_REFPIX          0xa1
+#define TDA_REG_REFLINE         0xa3
+#define TDA_REG_NPIX            0xa5
+#define TDA_REG_NLINE           0xa7
+#define TDA_REG_VS_LINE_STRT_1  0xa9
+#define TDA_REG_VS_PIX_STRT_1   0xab
+#define TDA_REG_VS_LINE_END_1   0xad
+#define TDA_REG_VS_PIX_END_1    0xaf
+#define TDA_REG_HS_PIX_START    0xb9
+#define TDA_REG_HS_PIX_STOP     0xbb
+#define TDA_REG_VWIN_START_1    0xbd
+#define TDA_REG_VWIN_END_1      0xbf
+#define TDA_REG_DE_START        0xc5
+#define TDA_REG_DE_STOP         0xc7
+#define TDA_REG_TBG_CNTRL_1     0xcb
+
+/* Page 2: PLL */
+#define TDA_PAGE_PLL            2
+#define TDA_REG_PLL_SERIAL_2    0x01    /* 3:0 = serialiser divider (log2) */
+
 #endif
@@ -0,0 +1,116 @@
+/* Monitor EDID fetch and cache
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include "edid.h"
+#include "dvo.h"
+#include "events.h"
+#include "video.h"
+
+static uint8_t          edid_raw[EDID_LEN];
+static edid_info_t      edid;
+static unsigned int     edid_reads;
+static unsigned int     edid_parses;
+static int              edid_fetch_result;
+
+/* Given the result of reading edid_raw */
+static bool     edid_apply(int result)
+{
+        bool was_valid = edid.valid;
+
+        edid_reads++;
+        if (result < 0) {
+                edid.valid = false;
+        } else if (edid_same(edid_raw, EDID_LEN, &edid)) {
+                /* Most hotplugs are the same monitor coming back */
+                return false;
+        } else if (edid_parse(edid_raw, EDID_LEN, &edid) == 0) {
+                edid_parses++;
+        }
+        if (!was_valid && !edid.valid)
+                return false;
+        /* Modes were derived for a different (or no) monitor */
+        video_modecache_flush();
+        return true;
+}
+
+bool    edid_update(void)
+{
+        return edid_apply(dvo_edid_read(edid_raw, EDID_LEN));
+}
+
+static void     edid_fetch_done(int result)
+{
+        edid_fetch_result = result;
+        event_post(EVT_EDID);
+}
+
+void    edid_fetch(void)
+{
+        dvo_edid_fetch(edid_raw, EDID_LEN, edid_fetch_done);
+}
+
+bool    edid_fetched(void)
+{
+        return edid_apply(edid_fetch_result);
+}
+
+const edid_info_t *edid_get(void)
+{
+        return edid.valid ? &edid : NULL;
+}
+
+const edid_dtd_t *edid_find_dtd(unsigned int hactive, unsigned int vactive)
+{
+        return edid.valid ? edid_info_find_dtd(&edid, hactive, vactive) : NULL;
+}
+
+void    edid_dump(void)
+{
+        printf("EDID: %d reads, %d parsed\r\n", edid_reads, edid_parses);
+        if (!edid.valid) {
+                printf("EDID: none\r\n");
+                return;
+        }
+        printf("EDID: \"%s\", %s, checksums %02x %02x\r\n",
+               edid.name, edid.hdmi ? "HDMI" : "DVI",
+               edid.checksum[0], edid.checksum[1]);
+        if (edid.has_range)
+                printf("  Range: V %d-%dHz, H %d-%dkHz, pclk max %dMHz\r\n",
+                       edid.vmin_hz, edid.vmax_hz, edid.hmin_khz, edid.hmax_khz,
+                       edid.max_pclk_khz / 1000);
+        for (unsigned int i = 0; i < edid.num_dtds; i++) {
+                const edid_dtd_t *t = &edid.dtd[i];
+
+                printf("  %d: %dx%d%s %d.%03dMHz, h %d/%d/%d, v %d/%d/%d\r\n",
+                       i, t->hactive, t->vactive,
+                       (t->flags & EDID_DTD_INTERLACED) ? "i" : "",
+                       t->pclk_khz / 1000, t->pclk_khz % 1000,
+                       t->hfp, t->hsync, t->hbp, t->vfp, t->vsync, t->vbp);
+        }
+}
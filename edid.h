@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EDID_H
+#define EDID_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* EDID (base block plus first extension) parsed down to what the mode
+ * selector needs:  the detailed timings and the range limits.
+ */
+
+#define EDID_BLOCK_LEN          128
+#define EDID_LEN                (EDID_BLOCK_LEN * 2)
+#define EDID_MAX_DTDS           8
+
+#define EDID_DTD_INTERLACED     0x01
+#define EDID_DTD_HSYNC_POS      0x02
+#define EDID_DTD_VSYNC_POS      0x04
+
+typedef struct {
+        uint32_t        pclk_khz;
+        uint16_t        hactive, hfp, hsync, hbp;
+        uint16_t        vactive, vfp, vsync, vbp;
+        uint8_t         flags;
+} edid_dtd_t;
+
+typedef struct {
+        bool            valid;
+        bool            hdmi;                   /* CEA HDMI VSDB present */
+        bool            has_range;
+        uint16_t        vmin_hz, vmax_hz;       /* Range limits */
+        uint16_t        hmin_khz, hmax_khz;
+        uint32_t        max_pclk_khz;
+        unsigned int    num_dtds;               /* First is preferred */
+        edid_dtd_t      dtd[EDID_MAX_DTDS];
+        char            name[14];
+        /* Identifies the blob, for caching: */
+        uint8_t         id[8];                  /* Manufacturer, product, serial */
+        uint8_t         checksum[2];            /* Of each block */
+} edid_info_t;
+
+/* Parse len (128 or 256) bytes; returns 0, or -1 if the base block is bad */
+int             edid_parse(const uint8_t *edid, unsigned int len, edid_info_t *info);
+/* True if the blob is the one info was parsed from */
+bool            edid_same(const uint8_t *edid, unsigned int len, const edid_info_t *info);
+/* Identifies the monitor (or 0 for none), e.g. for what was solved for it */
+uint32_t        edid_info_hash(const edid_info_t *info);
+/* A (progressive) detailed timing in info with this active area, or NULL */
+const edid_dtd_t *edid_info_find_dtd(const edid_info_t *info, unsigned int hactive,
+                                     unsigned int vactive);
+
+/* Fetch from the attached monitor, re-parsing only if it changed.
+ * Returns true if it changed.
+ */
+bool            edid_update(void);
+/* The same in the background:  EVT_EDID is posted when the fetch is
+ * done, then edid_fetched() does the rest
+ */
+void            edid_fetch(void);
+bool            edid_fetched(void);
+/* The current monitor's EDID, or NULL if none/invalid */
+const edid_info_t *edid_get(void);
+/* A detailed timing with this active area, or NULL */
+const edid_dtd_t *edid_find_dtd(unsigned int hactive, unsigned int vactive);
+void            edid_dump(void);
+
+#endif
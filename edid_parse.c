@@ -0,0 +1,204 @@
+/* EDID parsing
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include "edid.h"
+
+/* This is kept free of hardware dependencies, so that it can be run over
+ * EDID blobs on a host.
+ */
+
+static const uint8_t edid_header[8] = { 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00 };
+
+static bool     edid_block_ok(const uint8_t *b)
+{
+        uint8_t sum = 0;
+
+        for (unsigned int i = 0; i < EDID_BLOCK_LEN; i++)
+                sum += b[i];
+        return sum == 0;
+}
+
+/* 18-byte detailed timing descriptor; false if it's a display descriptor,
+ * or a timing whose porches and sync don't fit in its blanking (which
+ * would leave a negative back porch).
+ */
+static bool     edid_parse_dtd(const uint8_t *d, edid_dtd_t *t)
+{
+        unsigned int pclk = d[0] | (d[1] << 8);
+
+        if (pclk == 0)
+                return false;
+
+        unsigned int hblank = d[3] | ((d[4] & 0x0f) << 8);
+        unsigned int vblank = d[6] | ((d[7] & 0x0f) << 8);
+        unsigned int hfp = d[8] | ((d[11] & 0xc0) << 2);
+        unsigned int hsync = d[9] | ((d[11] & 0x30) << 4);
+        unsigned int vfp = (d[10] >> 4) | ((d[11] & 0x0c) << 2);
+        unsigned int vsync = (d[10] & 0x0f) | ((d[11] & 0x03) << 4);
+
+        if (hfp + hsync > hblank || vfp + vsync > vblank)
+                return false;
+
+        t->pclk_khz = pclk * 10;
+        t->hactive = d[2] | ((d[4] & 0xf0) << 4);
+        t->vactive = d[5] | ((d[7] & 0xf0) << 4);
+        t->hfp = hfp;
+        t->hsync = hsync;
+        t->hbp = hblank - hfp - hsync;
+        t->vfp = vfp;
+        t->vsync = vsync;
+        t->vbp = vblank - vfp - vsync;
+        t->flags = 0;
+        if (d[17] & 0x80)
+                t->flags |= EDID_DTD_INTERLACED;
+        if ((d[17] & 0x18) == 0x18) {           /* Digital separate sync */
+                if (d[17] & 0x04)
+                        t->flags |= EDID_DTD_VSYNC_POS;
+                if (d[17] & 0x02)
+                        t->flags |= EDID_DTD_HSYNC_POS;
+        }
+        return true;
+}
+
+static void     edid_parse_descriptor(const uint8_t *d, edid_info_t *info)
+{
+        switch (d[3]) {
+        case 0xfd: {            /* Range limits; EDID 1.4 adds +255 offsets */
+                uint8_t ofs = d[4];
+
+                info->has_range = true;
+                info->vmin_hz = d[5] + ((ofs & 0x01) ? 255 : 0);
+                info->vmax_hz = d[6] + ((ofs & 0x02) ? 255 : 0);
+                info->hmin_khz = d[7] + ((ofs & 0x04) ? 255 : 0);
+                info->hmax_khz = d[8] + ((ofs & 0x08) ? 255 : 0);
+                info->max_pclk_khz = d[9] * 10000;
+                break;
+        }
+        case 0xfc:              /* Name, 0x0a-terminated */
+                for (unsigned int i = 0; i < 13 && d[5 + i] != 0x0a; i++)
+                        info->name[i] = d[5 + i];
+                break;
+        default:
+                break;
+        }
+}
+
+static void     edid_add_dtd(const uint8_t *d, edid_info_t *info)
+{
+        if (info->num_dtds < EDID_MAX_DTDS &&
+            edid_parse_dtd(d, &info->dtd[info->num_dtds]))
+                info->num_dtds++;
+        else if (d[0] == 0 && d[1] == 0)
+                edid_parse_descriptor(d, info);
+}
+
+/* CEA-861 extension:  look for the HDMI VSDB, and pick up extra DTDs */
+static void     edid_parse_cea(const uint8_t *b, edid_info_t *info)
+{
+        unsigned int dtd_start = b[2];
+
+        if (dtd_start < 4 || dtd_start > EDID_BLOCK_LEN - 1)
+                return;
+
+        for (unsigned int i = 4; i < dtd_start; ) {
+                unsigned int tag = b[i] >> 5;
+                unsigned int len = b[i] & 0x1f;
+
+                if (tag == 3 && len >= 3 && i + 3 < dtd_start &&
+                    b[i+1] == 0x03 && b[i+2] == 0x0c && b[i+3] == 0x00)
+                        info->hdmi = true;
+                i += len + 1;
+        }
+        for (unsigned int i = dtd_start; i + 18 <= EDID_BLOCK_LEN - 1; i += 18) {
+                if (b[i] == 0 && b[i+1] == 0)
+                        break;
+                edid_add_dtd(&b[i], info);
+        }
+}
+
+int     edid_parse(const uint8_t *edid, unsigned int len, edid_info_t *info)
+{
+        memset(info, 0, sizeof(*info));
+
+        if (len < EDID_BLOCK_LEN || memcmp(edid, edid_header, sizeof(edid_header)) != 0 ||
+            !edid_block_ok(edid))
+                return -1;
+
+        memcpy(info->id, &edid[8], sizeof(info->id));
+        info->checksum[0] = edid[EDID_BLOCK_LEN - 1];
+
+        /* Four 18-byte descriptors, from 54 */
+        for (unsigned int i = 54; i < 126; i += 18)
+                edid_add_dtd(&edid[i], info);
+
+        if (edid[126] > 0 && len >= EDID_LEN && edid_block_ok(&edid[EDID_BLOCK_LEN])) {
+                info->checksum[1] = edid[EDID_LEN - 1];
+                if (edid[EDID_BLOCK_LEN] == 0x02)
+                        edid_parse_cea(&edid[EDID_BLOCK_LEN], info);
+        }
+        info->valid = true;
+        return 0;
+}
+
+bool    edid_same(const uint8_t *edid, unsigned int len, const edid_info_t *info)
+{
+        return info->valid && len >= EDID_BLOCK_LEN &&
+                memcmp(&edid[8], info->id, sizeof(info->id)) == 0 &&
+                edid[EDID_BLOCK_LEN - 1] == info->checksum[0] &&
+                (len < EDID_LEN || edid[126] == 0 ||
+                 edid[EDID_LEN - 1] == info->checksum[1]);
+}
+
+/* FNV-1a over the identity bytes */
+uint32_t        edid_info_hash(const edid_info_t *info)
+{
+        uint32_t h = 2166136261u;
+
+        if (!info || !info->valid)
+                return 0;
+        for (unsigned int i = 0; i < sizeof(info->id); i++) {
+                h ^= info->id[i];
+                h *= 16777619u;
+        }
+        for (unsigned int i = 0; i < sizeof(info->checksum); i++) {
+                h ^= info->checksum[i];
+                h *= 16777619u;
+        }
+        return h;
+}
+
+const edid_dtd_t *edid_info_find_dtd(const edid_info_t *info, unsigned int hactive,
+                                     unsigned int vactive)
+{
+        for (unsigned int i = 0; i < info->num_dtds; i++) {
+                const edid_dtd_t *t = &info->dtd[i];
+
+                if (t->hactive == hactive && t->vactive == vactive &&
+                    !(t->flags & EDID_DTD_INTERLACED))
+                        return t;
+        }
+        return NULL;
+}
@@ -0,0 +1,79 @@
+/* ArcDVI: event flags for the main loop
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "events.h"
+#if !PICO_ON_DEVICE
+#include "fpga_sim.h"
+#endif
+
+
+static volatile uint32_t pending;
+static spin_lock_t      *evt_lock;
+
+void            events_init(void)
+{
+        evt_lock = spin_lock_init(spin_lock_claim_unused(true));
+        pending = 0;
+}
+
+void            event_post(uint32_t ev)
+{
+        uint32_t irqs = spin_lock_blocking(evt_lock);
+        pending |= ev;
+        spin_unlock(evt_lock, irqs);
+        /* Wake a sleeper (this core or the other) */
+        __sev();
+}
+
+uint32_t        event_take(uint32_t mask)
+{
+        uint32_t irqs = spin_lock_blocking(evt_lock);
+        uint32_t ev = pending & mask;
+        pending &= ~ev;
+        spin_unlock(evt_lock, irqs);
+        return ev;
+}
+
+uint32_t        event_pending(void)
+{
+        return pending;
+}
+
+void            event_wait(void)
+{
+        /* A post between the test and the WFE leaves the event register
+         * set, so the WFE falls straight through:
+         */
+#if PICO_ON_DEVICE
+        if (!pending)
+                __wfe();
+#else
+        /* Host build: simulated time moves on instead */
+        fpga_sim_idle();
+#endif
+}
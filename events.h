@@ -0,0 +1,51 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdint.h>
+
+/* Pending-work flags, posted from IRQs (or the other core) and consumed
+ * by the main loop, which sleeps while there's nothing to do.
+ */
+#define EVT_VIDC_RECONFIG       0x00000001      /* FPGA IRQ: VIDC timing written */
+#define EVT_VIDC_POLL           0x00000002      /* Periodic fallback check */
+#define EVT_CLI_CMD             0x00000004      /* Console line queued by core 0 */
+#define EVT_CAPTURE             0x00000008      /* Drain the parallel bus capture ring */
+#define EVT_DVO_IRQ             0x00000010      /* Video transmitter IRQ: hot-plug */
+#define EVT_VID_I2C             0x00000020      /* Transmitter I2C transaction(s) done */
+#define EVT_MODE_SAVE           0x00000040      /* Record the new mode in flash */
+#define EVT_EDID                0x00000080      /* Background EDID fetch done */
+
+void            events_init(void);
+/* Safe from IRQ context: */
+void            event_post(uint32_t ev);
+/* Returns (and clears) any of the events in mask that are pending */
+uint32_t        event_take(uint32_t mask);
+uint32_t        event_pending(void);
+/* Sleep until something's posted (or any interrupt occurs) */
+void            event_wait(void);
+
+#endif
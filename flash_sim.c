@@ -0,0 +1,113 @@
+/* Model of the mode store's NOR flash, for the host build
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <stdbool.h>
+
+#include "flash_sim.h"
+
+#define FLASH_SIM_SIZE  (FLASH_SIM_SECTORS * FLASH_SIM_SECTOR_SIZE)
+
+static uint8_t          flash[FLASH_SIM_SIZE] = {
+        [0 ... FLASH_SIM_SIZE - 1] = 0xff
+};
+static flash_sim_stats_t stats[FLASH_SIM_SECTORS];
+
+static unsigned int     cut_ops;        /* 0 if none scheduled */
+static bool             powered = true;
+
+/* Returns the fraction (of 2) of the next operation that happens */
+static unsigned int     flash_sim_op(uint32_t offset)
+{
+        flash_sim_stats_t *st = &stats[(offset / FLASH_SIM_SECTOR_SIZE) % FLASH_SIM_SECTORS];
+
+        if (!powered) {
+                st->lost++;
+                return 0;
+        }
+        if (cut_ops && --cut_ops == 0) {
+                powered = false;
+                st->lost++;
+                return 1;
+        }
+        return 2;
+}
+
+const uint8_t   *flash_sim_data(uint32_t offset)
+{
+        return &flash[offset % FLASH_SIM_SIZE];
+}
+
+void            flash_sim_program(uint32_t offset, const void *data, size_t len)
+{
+        const uint8_t *d = data;
+
+        offset %= FLASH_SIM_SIZE;
+        if (offset + len > FLASH_SIM_SIZE)
+                len = FLASH_SIM_SIZE - offset;
+        flash_sim_stats_t *st = &stats[offset / FLASH_SIM_SECTOR_SIZE];
+
+        len = len * flash_sim_op(offset) / 2;
+        st->programs++;
+
+        for (size_t i = 0; i < len; i++) {
+                if (d[i] & ~flash[offset + i])
+                        st->overwrites++;
+                flash[offset + i] &= d[i];
+        }
+}
+
+void            flash_sim_erase(uint32_t offset)
+{
+        offset = (offset % FLASH_SIM_SIZE) & ~(FLASH_SIM_SECTOR_SIZE - 1);
+        size_t len = FLASH_SIM_SECTOR_SIZE * flash_sim_op(offset) / 2;
+
+        stats[offset / FLASH_SIM_SECTOR_SIZE].erases++;
+        memset(&flash[offset], 0xff, len);
+}
+
+void            flash_sim_power_cut(unsigned int ops)
+{
+        cut_ops = ops;
+}
+
+void            flash_sim_power_on(void)
+{
+        cut_ops = 0;
+        powered = true;
+}
+
+void            flash_sim_reset(void)
+{
+        flash_sim_power_on();
+        memset(flash, 0xff, sizeof(flash));
+        memset(stats, 0, sizeof(stats));
+}
+
+void            flash_sim_get_stats(unsigned int sector, flash_sim_stats_t *st)
+{
+        *st = stats[sector % FLASH_SIM_SECTORS];
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FLASH_SIM_H
+#define FLASH_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Host build only:  a model of the NOR flash behind the mode store (see
+ * modestore.c).  Erasing sets a sector to 0xff, and programming can only
+ * clear bits.  A power cut can be scheduled in the middle of a write, to
+ * check the store survives one.
+ */
+
+#define FLASH_SIM_SECTOR_SIZE   4096
+#define FLASH_SIM_PAGE_SIZE     256
+#define FLASH_SIM_SECTORS       2
+
+typedef struct {
+        unsigned int    programs;
+        unsigned int    erases;         /* Per sector */
+        unsigned int    lost;           /* Operations cut short, or dropped */
+        unsigned int    overwrites;     /* Bytes programmed needing a 0 bit set to 1 */
+} flash_sim_stats_t;
+
+const uint8_t   *flash_sim_data(uint32_t offset);
+void            flash_sim_program(uint32_t offset, const void *data, size_t len);
+/* Erases the sector containing offset */
+void            flash_sim_erase(uint32_t offset);
+/* The power fails part-way through the ops'th program or erase from now
+ * (1 being the next):  it's half done, and none after it happen at all.
+ */
+void            flash_sim_power_cut(unsigned int ops);
+/* Power's back (and nothing is scheduled) */
+void            flash_sim_power_on(void);
+/* Back to blank flash, and clear the stats */
+void            flash_sim_reset(void);
+void            flash_sim_get_stats(unsigned int sector, flash_sim_stats_t *st);
+
+#endif
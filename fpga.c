@@ -30,7 +30,10 @@
 #include "hardware/clocks.h"
 #include "hardware/gpio.h"
 #include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 #include "fpga.h"
+#include "fpga_xfer.h"
 
 
 #define DEBUG 1
@@ -55,6 +58,8 @@
         gpio_set_dir(x, GPIO_OUT);      \
         } while (0)
 
+static void     fpga_dma_init(void);
+
 void    fpga_init()
 {
         FDB("+++ FPGA init\n");
@@ -88,6 +93,8 @@ void    fpga_init()
         GPIO_INIT_IN_PU(MCU_FPGA_STROBE);
         GPIO_INIT_IN_PU(MCU_FPGA_VALID);		/* Really a misc framing signal */
 
+        fpga_dma_init();
+
         FDB("    Done\n");
 }
 
@@ -149,35 +156,73 @@ void    fpga_reset()
         gpio_put(MCU_FPGA_nRESET, 1);
 }
 
-uint32_t        fpga_read32(unsigned int addr)
+/******************************************************************************/
+/* DMA backend for the transaction queue (fpga_xfer.c)
+ *
+ * A pair of DMA channels shifts a transaction's bytes out/in, and the
+ * RX channel's completion IRQ raises SS and completes it, which starts
+ * the next.  The CPU doesn't touch the bus per-byte.
+ */
+
+static int              dma_tx;
+static int              dma_rx;
+static uint8_t          rx_discard;
+
+static void     fpga_dma_start(uint8_t *buf, unsigned int len, bool write)
 {
-        uint8_t packet[4];
-        uint32_t rdata;
+        dma_channel_config c;
 
-        packet[0] = (0 << 6) | ((addr >> 6) & 0x3f);
-        packet[1] = (addr << 2) & 0xff;
         gpio_put(MCU_FPGA_SS, 0);
-        spi_write_blocking(spi0, &packet[0], 2);
-        spi_read_blocking(spi0, 0, &packet[0], 4);
-        gpio_put(MCU_FPGA_SS, 1);
 
-        rdata = ((uint32_t)packet[0] << 24) | ((uint32_t)packet[1] << 16) |
-                ((uint32_t)packet[2] << 8) | packet[3];
-        return rdata;
+        /* RX: reads land in the transaction's buffer (over the TX bytes,
+         * which have always been sent by then), writes are discarded:
+         */
+        c = dma_channel_get_default_config(dma_rx);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_dreq(&c, spi_get_dreq(spi0, false));
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, !write);
+        dma_channel_configure(dma_rx, &c,
+                              write ? &rx_discard : buf,
+                              &spi_get_hw(spi0)->dr,
+                              len, false);
+
+        c = dma_channel_get_default_config(dma_tx);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_dreq(&c, spi_get_dreq(spi0, true));
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        dma_channel_configure(dma_tx, &c,
+                              &spi_get_hw(spi0)->dr,
+                              buf,
+                              len, false);
+
+        dma_start_channel_mask((1u << dma_tx) | (1u << dma_rx));
 }
 
-void            fpga_write32(unsigned int addr, uint32_t data)
+static void     fpga_dma_irq(void)
 {
-        uint8_t packet[6];
-        uint32_t rdata;
-
-        packet[0] = (1 << 6) | ((addr >> 6) & 0x3f);
-        packet[1] = (addr << 2) & 0xff;
-        packet[2] = data >> 24;
-        packet[3] = data >> 16;
-        packet[4] = data >> 8;
-        packet[5] = data;
-        gpio_put(MCU_FPGA_SS, 0);
-        spi_write_blocking(spi0, &packet[0], 6);
+        if (!dma_channel_get_irq0_status(dma_rx))
+                return;
+        dma_channel_acknowledge_irq0(dma_rx);
+
         gpio_put(MCU_FPGA_SS, 1);
+        fpga_xfer_complete();
+}
+
+static const fpga_xfer_backend_t dma_backend = {
+        .start = fpga_dma_start,
+};
+
+static void     fpga_dma_init(void)
+{
+        dma_tx = dma_claim_unused_channel(true);
+        dma_rx = dma_claim_unused_channel(true);
+
+        dma_channel_set_irq0_enabled(dma_rx, true);
+        irq_add_shared_handler(DMA_IRQ_0, fpga_dma_irq,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+
+        fpga_xfer_init(&dma_backend);
 }
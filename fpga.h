@@ -26,6 +26,7 @@
 #define FPGA_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /* Generic-ish FPGA helpers */
 
@@ -38,8 +39,58 @@ bool            fpga_is_ready();
 /* Returns to uninitialised state: */
 void            fpga_reset();
 
-/* Payload register I/O */
+/* The FPGA's SPI responder is meant to stream consecutive registers while
+ * SS is held low, so a contiguous range can be transferred with one
+ * address header.  That auto-increment isn't confirmed on all bitstreams,
+ * so it's off unless built with FPGA_SPI_BURST=1 (a CMake option); without
+ * it, each word is its own transaction.
+ */
+#ifndef FPGA_SPI_BURST
+#define FPGA_SPI_BURST          0
+#endif
+
+/* Asynchronous register I/O:
+ * Transactions are queued, and run back-to-back by DMA in submission
+ * order.  Each covers up to FPGA_XFER_WORDS consecutive registers; a
+ * longer submission is split into several, and its ticket is the last's.
+ * Read data is valid (and writes have happened) once the returned ticket
+ * is done; the optional callback is then called from IRQ context.
+ * For writes, data is copied at submission.
+ */
+#define FPGA_XFER_MAX_WORDS     16
+
+#if FPGA_SPI_BURST
+#define FPGA_XFER_WORDS         FPGA_XFER_MAX_WORDS
+#else
+#define FPGA_XFER_WORDS         1
+#endif
+
+typedef unsigned int fpga_ticket_t;
+typedef void (*fpga_xfer_cb_t)(void *arg);
+
+fpga_ticket_t   fpga_xfer_submit(unsigned int addr, uint32_t *data, unsigned int count,
+                                 bool write, fpga_xfer_cb_t cb, void *arg);
+bool            fpga_xfer_done(fpga_ticket_t t);
+void            fpga_xfer_wait(fpga_ticket_t t);
+/* Wait for everything submitted so far */
+void            fpga_xfer_fence(void);
+
+/* Payload register I/O (blocking) */
 uint32_t        fpga_read32(unsigned int addr);
 void            fpga_write32(unsigned int addr, uint32_t data);
+/* Transfer count words at consecutive addresses, in as few transactions
+ * as FPGA_XFER_WORDS allows
+ */
+void            fpga_read_burst(unsigned int addr, uint32_t *data, unsigned int count);
+void            fpga_write_burst(unsigned int addr, const uint32_t *data, unsigned int count);
+
+/* Register I/O accounting */
+typedef struct {
+        unsigned int    transactions;
+        unsigned int    bytes;          /* On the wire, including headers */
+} fpga_spi_stats_t;
+
+void            fpga_spi_get_stats(fpga_spi_stats_t *stats);
+void            fpga_spi_clear_stats(void);
 
 #endif
@@ -0,0 +1,528 @@
+/* fpga_sim: host-side model of the FPGA register file, and scenario runner
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fpga.h"
+#include "fpga_sim.h"
+#include "fpga_xfer.h"
+#include "commands.h"
+#include "events.h"
+#include "video.h"
+#include "vidc_regs.h"
+#include "pll.h"
+#include "hw.h"
+
+/* Scenario scripts are text, one command per line; '#' starts a comment.
+ *
+ *   vidc <word> [<word>...]    VIDC bus writes, as the Arc makes them (hex,
+ *                              register in bits 31:26, as in trace dumps)
+ *   wait <ms>                  Let time pass
+ *   frames <n>                 Let n VIDC frames pass
+ *   cmd <line>                 Run a console command (once the firmware's
+ *                              idle)
+ *   irq <0|1>                  Connect the FPGA reconfig IRQ (default 1);
+ *                              with 0, only the fallback poll sees changes
+ *   lock <us>                  PLL lock time (default 200us)
+ *   echo <text>                Print a marker in the log
+ *
+ * VIDC register writes happen 1us apart.  The script's read up front, and
+ * then runs as simulated time passes.
+ */
+
+#define SIM_SCRIPT_LINES        4096
+#define SIM_LINE_MAX            160
+
+/* Cost of a register access, roughly as for 10MHz SPI */
+#define SIM_XFER_NS             2000
+#define SIM_BYTE_NS             800
+#define SIM_VIDC_WRITE_NS       1000
+/* The firmware's fallback poll timer (VIDC_FALLBACK_POLL_MS) */
+#define SIM_POLL_NS             (250ull * 1000000)
+/* Until VIDC's programmed: */
+#define SIM_DEFAULT_FRAME_NS    (20ull * 1000000)
+
+#define SYNC_REQ                0x01
+#define SYNC_ACK                0x02
+#define SYNC_RECONFIG_ACK       0x04
+#define SYNC_RECONFIG           0x08
+#define SYNC_FLYBACK            0x10
+
+#define SIMLOG(fmt, x...)       printf("SIM %6u.%03ums: " fmt "\r\n", \
+                                       (unsigned int)(now_ns / 1000000), \
+                                       (unsigned int)(now_ns / 1000) % 1000, ##x)
+
+static uint32_t         vidc[128];
+static uint32_t         vido[16];
+static uint32_t         ctrl[8];
+
+static uint64_t         now_ns;
+static uint64_t         frame_start_ns;
+static uint64_t         poll_next_ns = SIM_POLL_NS;
+
+/* PLL config chain */
+static uint32_t         pll_shift;
+static bool             pll_clocked;
+static bool             pll_cfg_ok = true;
+static uint32_t         pll_khz = PLL_REF_KHZ;  /* Bitstream's default */
+static uint64_t         pll_lock_ns;
+static unsigned int     pll_lock_us = 200;
+
+static bool             irq_connected = true;
+static uint64_t         sync_req_ns;
+
+/* Script */
+static char             (*script)[SIM_LINE_MAX];
+static unsigned int     script_lines;
+static unsigned int     script_pc;
+static uint64_t         script_wake_ns;
+static bool             in_script;
+
+static struct {
+        unsigned int    frames;
+        unsigned int    vidc_writes;
+        unsigned int    reconfig_irqs;
+        unsigned int    syncs;
+        uint64_t        sync_total_ns;
+        unsigned int    pll_loads;
+        unsigned int    pll_bad;
+        unsigned int    commands;
+        unsigned int    xfers;
+        unsigned int    xfer_bytes;
+} sim_stats;
+
+static void     sim_advance(uint64_t ns);
+
+/******************************************************************************/
+/* VIDC frame timing, decoded as video_solve() does */
+
+typedef struct {
+        uint64_t        frame_ns;
+        uint64_t        line_ns;
+        unsigned int    vdsr, vder;     /* Display lines */
+} sim_frame_t;
+
+static void     sim_frame_geometry(sim_frame_t *f)
+{
+        static const unsigned int pix_rates[] = { 8, 12, 16, 24 };
+        unsigned int hcr = ((vidc[VIDC_H_CYC/4] >> 14) & 0x3ff)*2 + 2;
+        unsigned int vcr = ((vidc[VIDC_V_CYC/4] >> 14) & 0x3ff) + 1;
+        unsigned int mhz = pix_rates[vidc[VIDC_CONTROL/4] & 3];
+
+        f->vdsr = ((vidc[VIDC_V_DISP_START/4] >> 14) & 0x3ff) + 1;
+        f->vder = ((vidc[VIDC_V_DISP_END/4] >> 14) & 0x3ff) + 1;
+
+        if (vidc[VIDC_H_CYC/4] == 0 || vidc[VIDC_V_CYC/4] == 0 || f->vder <= f->vdsr) {
+                /* Not programmed yet; 50Hz, with 10% flyback */
+                f->frame_ns = SIM_DEFAULT_FRAME_NS;
+                f->line_ns = SIM_DEFAULT_FRAME_NS / 100;
+                f->vdsr = 5;
+                f->vder = 95;
+                return;
+        }
+        f->line_ns = (uint64_t)hcr * 1000 / mhz;
+        f->frame_ns = f->line_ns * vcr;
+}
+
+static bool     sim_flyback(void)
+{
+        sim_frame_t f;
+
+        sim_frame_geometry(&f);
+        unsigned int line = (now_ns - frame_start_ns) / f.line_ns;
+
+        return line < f.vdsr || line >= f.vder;
+}
+
+/* Start of a VIDC frame:  the FPGA takes a new output config here */
+static void     sim_frame(void)
+{
+        sim_stats.frames++;
+        if (!!(vido[VIDO_REG_SYNC] & SYNC_REQ) != !!(vido[VIDO_REG_SYNC] & SYNC_ACK)) {
+                vido[VIDO_REG_SYNC] ^= SYNC_ACK;
+                sim_stats.syncs++;
+                sim_stats.sync_total_ns += now_ns - sync_req_ns;
+        }
+}
+
+/******************************************************************************/
+/* Registers */
+
+static void     sim_vidc_write(uint32_t w)
+{
+        unsigned int r = VIDC_WRITE_REG(w);
+
+        vidc[r/4] = w & 0x00ffffff;
+        sim_stats.vidc_writes++;
+
+        /* The FPGA flags HCR/VCR writes, until acked */
+        if (r == VIDC_H_CYC || r == VIDC_V_CYC) {
+                bool was = !!(vido[VIDO_REG_SYNC] & SYNC_RECONFIG) !=
+                        !!(vido[VIDO_REG_SYNC] & SYNC_RECONFIG_ACK);
+
+                if (!was) {
+                        vido[VIDO_REG_SYNC] ^= SYNC_RECONFIG;
+                        if (irq_connected) {
+                                sim_stats.reconfig_irqs++;
+                                event_post(EVT_VIDC_RECONFIG);
+                        }
+                }
+        }
+}
+
+static void     sim_pll_decode(uint32_t w)
+{
+        unsigned int divr = w & 0xf;
+        unsigned int divf = (w >> 4) & 0x7f;
+        unsigned int divq = (w >> 11) & 0x7;
+        uint32_t pfd = PLL_REF_KHZ / (divr + 1);
+        uint32_t vco = pfd * (divf + 1);
+
+        pll_cfg_ok = divq >= 1 && divq <= 6 &&
+                pfd >= PLL_PFD_MIN_KHZ && pfd <= PLL_PFD_MAX_KHZ &&
+                vco >= PLL_VCO_MIN_KHZ && vco <= PLL_VCO_MAX_KHZ &&
+                (vco >> divq) >= PLL_OUT_MIN_KHZ && (vco >> divq) <= PLL_OUT_MAX_KHZ;
+        if (pll_cfg_ok) {
+                pll_khz = vco >> divq;
+                SIMLOG("PLL config %07x: %d kHz", w, pll_khz);
+        } else {
+                sim_stats.pll_bad++;
+                SIMLOG("PLL config %07x out of range (PFD %d, VCO %d kHz), won't lock",
+                       w, pfd, vco);
+        }
+}
+
+static void     sim_ctrl_write(uint32_t v)
+{
+        uint32_t old = ctrl[CTRL_REG];
+
+        v &= ~(CR_PLL_DATAO | CR_PLL_LOCK);
+        ctrl[CTRL_REG] = v;
+
+        if (!(v & CR_PLL_NRESET)) {
+                /* Config shifts in, MSB first, at rising PLL_CLK */
+                if ((v & CR_PLL_CLK) && !(old & CR_PLL_CLK)) {
+                        pll_shift = ((pll_shift << 1) | !!(v & CR_PLL_DATA)) & 0x3ffffff;
+                        pll_clocked = true;
+                }
+        } else if (!(old & CR_PLL_NRESET)) {
+                /* Out of reset: a new config, if one was shifted in */
+                if (pll_clocked) {
+                        pll_clocked = false;
+                        sim_stats.pll_loads++;
+                        sim_pll_decode(pll_shift);
+                }
+                pll_lock_ns = now_ns + (uint64_t)pll_lock_us * 1000;
+        }
+}
+
+static uint32_t sim_read(unsigned int addr)
+{
+        if (addr < FPGA_VO(0))
+                return addr < 128 ? vidc[addr] : 0;
+        if (addr < FPGA_CTRL(0)) {
+                unsigned int r = addr - FPGA_VO(0);
+
+                if (r == VIDO_REG_SYNC)
+                        return (vido[r] & ~SYNC_FLYBACK) | (sim_flyback() ? SYNC_FLYBACK : 0);
+                return r < 16 ? vido[r] : 0;
+        }
+        unsigned int r = addr - FPGA_CTRL(0);
+
+        if (r == CTRL_REG) {
+                uint32_t v = ctrl[CTRL_REG];
+
+                if (pll_shift & (1 << 25))
+                        v |= CR_PLL_DATAO;
+                if ((v & CR_PLL_BYPASS) ||
+                    ((v & CR_PLL_NRESET) && pll_cfg_ok && now_ns >= pll_lock_ns))
+                        v |= CR_PLL_LOCK;
+                return v;
+        }
+        return r < 8 ? ctrl[r] : 0;
+}
+
+static void     sim_write(unsigned int addr, uint32_t v)
+{
+        if (addr < FPGA_VO(0))
+                return;                 /* VIDC's read-only from this side */
+        if (addr < FPGA_CTRL(0)) {
+                unsigned int r = addr - FPGA_VO(0);
+
+                if (r == VIDO_REG_SYNC) {
+                        if ((v ^ vido[r]) & SYNC_REQ)
+                                sync_req_ns = now_ns;
+                        vido[r] = (vido[r] & ~(SYNC_REQ | SYNC_RECONFIG_ACK)) |
+                                (v & (SYNC_REQ | SYNC_RECONFIG_ACK));
+                        /* The IRQ's a level: still set if VIDC's been written since */
+                        if (irq_connected && !!(vido[r] & SYNC_RECONFIG) != !!(vido[r] & SYNC_RECONFIG_ACK))
+                                event_post(EVT_VIDC_RECONFIG);
+                } else if (r < 16) {
+                        vido[r] = v;
+                }
+                return;
+        }
+        unsigned int r = addr - FPGA_CTRL(0);
+
+        if (r == CTRL_REG)
+                sim_ctrl_write(v);
+        else if (r != CTRL_ID && r < 8)
+                ctrl[r] = v;
+}
+
+/******************************************************************************/
+/* Transaction queue backend (see fpga_xfer.c):  each completes within
+ * start(), after taking as long as it would on the wire.
+ */
+static void     sim_xfer_start(uint8_t *buf, unsigned int len, bool write)
+{
+        unsigned int addr = ((buf[0] & 0x3f) << 6) | (buf[1] >> 2);
+
+        for (unsigned int i = 0; i < (len - 2) / 4; i++) {
+                uint8_t *p = &buf[2 + i*4];
+
+                if (write) {
+                        sim_write(addr + i, ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+                                  ((uint32_t)p[2] << 8) | p[3]);
+                } else {
+                        uint32_t d = sim_read(addr + i);
+
+                        p[0] = d >> 24;
+                        p[1] = d >> 16;
+                        p[2] = d >> 8;
+                        p[3] = d;
+                }
+        }
+        sim_stats.xfers++;
+        sim_stats.xfer_bytes += len;
+        sim_advance(SIM_XFER_NS + len * SIM_BYTE_NS);
+        fpga_xfer_complete();
+}
+
+static const fpga_xfer_backend_t sim_backend = {
+        .start = sim_xfer_start,
+};
+
+/******************************************************************************/
+/* fpga.h interface */
+
+void    fpga_init()
+{
+        SIMLOG("FPGA init (simulated)");
+        fpga_xfer_init(&sim_backend);
+}
+
+int     fpga_load(uint8_t *bitstream, unsigned int len)
+{
+        return 0;
+}
+
+bool    fpga_is_ready()
+{
+        return true;
+}
+
+void    fpga_reset()
+{
+}
+
+/******************************************************************************/
+/* Scenario */
+
+int     fpga_sim_load(const char *path)
+{
+        FILE *f = fopen(path, "r");
+        char line[SIM_LINE_MAX];
+
+        if (!f) {
+                perror(path);
+                return -1;
+        }
+        script = calloc(SIM_SCRIPT_LINES, SIM_LINE_MAX);
+        script_lines = 0;
+        while (fgets(line, sizeof(line), f)) {
+                char *p = strchr(line, '#');
+
+                if (p)
+                        *p = '\0';
+                p = line + strlen(line);
+                while (p > line && (p[-1] == '\n' || p[-1] == '\r' || p[-1] == ' ' || p[-1] == '\t'))
+                        *--p = '\0';
+                p = line;
+                while (*p == ' ' || *p == '\t')
+                        p++;
+                if (*p == '\0')
+                        continue;
+                if (script_lines == SIM_SCRIPT_LINES) {
+                        fprintf(stderr, "%s: too many lines\n", path);
+                        fclose(f);
+                        return -1;
+                }
+                strcpy(script[script_lines++], p);
+        }
+        fclose(f);
+        return 0;
+}
+
+static void     sim_script_error(const char *line)
+{
+        fprintf(stderr, "Scenario line %d: can't parse '%s'\n", script_pc, line);
+        exit(1);
+}
+
+/* Run script lines due by now.  Commands are only run with idle true
+ * (from the main loop's wait), as they can't be run in the middle of a
+ * register access; other lines just change the model.
+ */
+static void     sim_script_run(bool idle)
+{
+        if (in_script)
+                return;
+        in_script = true;
+
+        while (script_pc < script_lines && now_ns >= script_wake_ns) {
+                char *line = script[script_pc];
+                char *arg = line;
+
+                while (*arg && *arg != ' ' && *arg != '\t')
+                        arg++;
+                while (*arg == ' ' || *arg == '\t')
+                        arg++;
+
+                if (strncmp(line, "cmd", 3) == 0) {
+                        if (!idle)
+                                break;
+                        char buf[SIM_LINE_MAX];
+
+                        script_pc++;
+                        SIMLOG("> %s", arg);
+                        sim_stats.commands++;
+                        strcpy(buf, arg);
+                        cmd_parse(buf, strlen(buf));
+                        continue;
+                }
+
+                script_pc++;
+                if (strncmp(line, "vidc", 4) == 0) {
+                        char *end;
+
+                        do {
+                                uint32_t w = strtoul(arg, &end, 16);
+
+                                if (end == arg)
+                                        sim_script_error(line);
+                                sim_vidc_write(w);
+                                sim_advance(SIM_VIDC_WRITE_NS);
+                                arg = end;
+                                while (*arg == ' ' || *arg == '\t')
+                                        arg++;
+                        } while (*arg);
+                } else if (strncmp(line, "wait", 4) == 0) {
+                        script_wake_ns = now_ns + strtoull(arg, NULL, 0) * 1000000;
+                } else if (strncmp(line, "frames", 6) == 0) {
+                        sim_frame_t f;
+
+                        sim_frame_geometry(&f);
+                        script_wake_ns = now_ns + strtoull(arg, NULL, 0) * f.frame_ns;
+                } else if (strncmp(line, "irq", 3) == 0) {
+                        irq_connected = !!atoi(arg);
+                } else if (strncmp(line, "lock", 4) == 0) {
+                        pll_lock_us = atoi(arg);
+                } else if (strncmp(line, "echo", 4) == 0) {
+                        SIMLOG("%s", arg);
+                } else {
+                        sim_script_error(line);
+                }
+        }
+        in_script = false;
+}
+
+static void     sim_advance(uint64_t ns)
+{
+        sim_frame_t f;
+        uint64_t end = now_ns + ns;
+
+        /* Frame by frame, as the geometry changes when VIDC's written */
+        while (1) {
+                sim_frame_geometry(&f);
+                if (frame_start_ns + f.frame_ns > end)
+                        break;
+                frame_start_ns += f.frame_ns;
+                now_ns = frame_start_ns;
+                sim_frame();
+        }
+        now_ns = end;
+
+        if (now_ns >= poll_next_ns) {
+                poll_next_ns = now_ns + SIM_POLL_NS;
+                event_post(EVT_VIDC_POLL);
+        }
+        sim_script_run(false);
+}
+
+static void     sim_summary(void)
+{
+        double cpu = (double)clock() / CLOCKS_PER_SEC;
+
+        SIMLOG("End of scenario");
+        printf("Simulated %u.%03us (%d VIDC frames) in %.3fs host CPU\r\n",
+               (unsigned int)(now_ns / 1000000000), (unsigned int)(now_ns / 1000000) % 1000,
+               sim_stats.frames, cpu);
+        printf("\t%d VIDC writes, %d reconfig IRQs, %d commands\r\n",
+               sim_stats.vidc_writes, sim_stats.reconfig_irqs, sim_stats.commands);
+        printf("\t%d FPGA transactions, %d bytes\r\n", sim_stats.xfers, sim_stats.xfer_bytes);
+        printf("\t%d output syncs (avg %d us to ack), %d PLL loads (%d bad)\r\n",
+               sim_stats.syncs,
+               sim_stats.syncs ? (unsigned int)(sim_stats.sync_total_ns / sim_stats.syncs / 1000) : 0,
+               sim_stats.pll_loads, sim_stats.pll_bad);
+}
+
+void    fpga_sim_idle(void)
+{
+        sim_script_run(true);
+        if (event_pending())
+                return;
+
+        if (script_pc == script_lines) {
+                sim_summary();
+                exit(0);
+        }
+        /* Skip ahead to the next thing that happens */
+        uint64_t next = poll_next_ns;
+
+        if (script_wake_ns > now_ns && script_wake_ns < next)
+                next = script_wake_ns;
+        if (next > now_ns)
+                sim_advance(next - now_ns);
+        sim_script_run(true);
+}
+
+uint64_t        fpga_sim_time_us(void)
+{
+        return now_ns / 1000;
+}
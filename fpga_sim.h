@@ -0,0 +1,50 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FPGA_SIM_H
+#define FPGA_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Host build only:  a model of the FPGA's register file, standing in for
+ * fpga.c, so the video control plane can run on Linux.  It models the
+ * VIDC bank (written by a scenario script, as the Arc would), the VIDO
+ * registers including the VIDO_REG_SYNC handshake/flyback/reconfig bits,
+ * and CTRL_REG's PLL config chain and lock.
+ *
+ * Time is simulated:  each register access takes a little of it, and the
+ * main loop's idle wait skips ahead to the next thing that happens.
+ */
+
+/* Read a scenario script; returns -1 if it can't be read */
+int             fpga_sim_load(const char *path);
+/* Called when the firmware's idle.  Moves time on to the next event, or
+ * exits (with a summary) at the end of the scenario.
+ */
+void            fpga_sim_idle(void);
+/* Simulated time, in microseconds since start */
+uint64_t        fpga_sim_time_us(void);
+
+#endif
@@ -0,0 +1,238 @@
+/* FPGA register transaction queue
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include "hardware/sync.h"
+#include "fpga.h"
+#include "fpga_xfer.h"
+
+/* Register transactions are queued as descriptors, each of which is
+ * one SS-low transfer (an address header then 1-FPGA_XFER_WORDS words).
+ * The backend runs the descriptor at the tail; on its completion, read
+ * data is unpacked and the callback run, then the next descriptor is
+ * started.  (In that order so callbacks stay in order when a backend
+ * completes within start().)  On the device, the backend is DMA (fpga.c) and completion is
+ * from its IRQ; in the host build it's the simulated FPGA (fpga_sim.c).
+ *
+ * Tickets are sequence numbers: a ticket is complete once the tail
+ * has passed it.  The queue is protected by a spinlock so both cores
+ * (and the IRQ) can submit.
+ */
+
+#define XQ_SIZE         16      /* Power of 2 */
+#define XQ_MASK         (XQ_SIZE - 1)
+
+typedef struct {
+        uint32_t        *data;          /* Destination, for reads */
+        unsigned int    count;
+        bool            write;
+        fpga_xfer_cb_t  cb;
+        void            *arg;
+        unsigned int    len;            /* Bytes on the wire */
+        uint8_t         buf[2 + 4*FPGA_XFER_WORDS];
+} fpga_xfer_t;
+
+static const fpga_xfer_backend_t *xq_backend;
+static fpga_xfer_t      xq[XQ_SIZE];
+static volatile unsigned int xq_head;   /* Next to be submitted */
+static volatile unsigned int xq_tail;   /* Next to complete */
+static volatile bool    xq_busy;
+static spin_lock_t      *xq_lock;
+
+/* SPI traffic counters, for measuring the cost of register accesses: */
+static fpga_spi_stats_t spi_stats;
+
+void            fpga_xfer_init(const fpga_xfer_backend_t *backend)
+{
+        xq_lock = spin_lock_init(spin_lock_claim_unused(true));
+        xq_backend = backend;
+}
+
+static void     fpga_spi_header(uint8_t *packet, unsigned int addr, int write)
+{
+        packet[0] = ((write ? 1 : 0) << 6) | ((addr >> 6) & 0x3f);
+        packet[1] = (addr << 2) & 0xff;
+}
+
+/* Start the descriptor at the tail, if idle */
+static void     fpga_xfer_kick(void)
+{
+        uint32_t irqs = spin_lock_blocking(xq_lock);
+
+        if (xq_busy || xq_tail == xq_head) {
+                spin_unlock(xq_lock, irqs);
+                return;
+        }
+        /* Busy keeps the tail (and this descriptor) ours until completion */
+        fpga_xfer_t *x = &xq[xq_tail & XQ_MASK];
+
+        xq_busy = true;
+        spi_stats.transactions++;
+        spi_stats.bytes += x->len;
+        spin_unlock(xq_lock, irqs);
+
+        xq_backend->start(x->buf, x->len, x->write);
+}
+
+void            fpga_xfer_complete(void)
+{
+        fpga_xfer_t *x = &xq[xq_tail & XQ_MASK];
+        fpga_xfer_cb_t cb = x->cb;
+        void *arg = x->arg;
+
+        if (!x->write) {
+                for (unsigned int i = 0; i < x->count; i++) {
+                        uint8_t *p = &x->buf[2 + i*4];
+                        x->data[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+                                ((uint32_t)p[2] << 8) | p[3];
+                }
+        }
+
+        uint32_t irqs = spin_lock_blocking(xq_lock);
+
+        xq_tail++;
+        xq_busy = false;
+        spin_unlock(xq_lock, irqs);
+
+        if (cb)
+                cb(arg);
+        /* Wake anything waiting on a ticket */
+        __sev();
+        fpga_xfer_kick();
+}
+
+/* Queue one descriptor of up to FPGA_XFER_WORDS */
+static fpga_ticket_t    fpga_xfer_queue(unsigned int addr, uint32_t *data, unsigned int count,
+                                        bool write, fpga_xfer_cb_t cb, void *arg)
+{
+        fpga_ticket_t t;
+        uint32_t irqs;
+
+        /* Wait for a free slot: */
+        while (1) {
+                irqs = spin_lock_blocking(xq_lock);
+                if ((xq_head - xq_tail) < XQ_SIZE)
+                        break;
+                spin_unlock(xq_lock, irqs);
+                __wfe();
+        }
+
+        fpga_xfer_t *x = &xq[xq_head & XQ_MASK];
+
+        x->data = data;
+        x->count = count;
+        x->write = write;
+        x->cb = cb;
+        x->arg = arg;
+        x->len = 2 + count*4;
+        fpga_spi_header(x->buf, addr, write);
+        for (unsigned int i = 0; i < count; i++) {
+                uint8_t *p = &x->buf[2 + i*4];
+                uint32_t d = write ? data[i] : 0;
+                p[0] = d >> 24;
+                p[1] = d >> 16;
+                p[2] = d >> 8;
+                p[3] = d;
+        }
+
+        t = xq_head++;
+        spin_unlock(xq_lock, irqs);
+
+        fpga_xfer_kick();
+        return t;
+}
+
+/* More than FPGA_XFER_WORDS is split into several transactions; the
+ * callback's on the last, and its ticket is returned.
+ */
+fpga_ticket_t   fpga_xfer_submit(unsigned int addr, uint32_t *data, unsigned int count,
+                                 bool write, fpga_xfer_cb_t cb, void *arg)
+{
+        while (count > FPGA_XFER_WORDS) {
+                fpga_xfer_queue(addr, data, FPGA_XFER_WORDS, write, NULL, NULL);
+                addr += FPGA_XFER_WORDS;
+                data += FPGA_XFER_WORDS;
+                count -= FPGA_XFER_WORDS;
+        }
+        return fpga_xfer_queue(addr, data, count, write, cb, arg);
+}
+
+bool            fpga_xfer_done(fpga_ticket_t t)
+{
+        return (int)(xq_tail - t) > 0;
+}
+
+void            fpga_xfer_wait(fpga_ticket_t t)
+{
+        while (!fpga_xfer_done(t))
+                __wfe();
+}
+
+void            fpga_xfer_fence(void)
+{
+        fpga_xfer_wait(xq_head - 1);
+}
+
+/******************************************************************************/
+/* Blocking register I/O, on top of the queue */
+
+uint32_t        fpga_read32(unsigned int addr)
+{
+        uint32_t rdata;
+
+        fpga_xfer_wait(fpga_xfer_submit(addr, &rdata, 1, false, NULL, NULL));
+        return rdata;
+}
+
+void            fpga_write32(unsigned int addr, uint32_t data)
+{
+        fpga_xfer_wait(fpga_xfer_submit(addr, &data, 1, true, NULL, NULL));
+}
+
+void            fpga_read_burst(unsigned int addr, uint32_t *data, unsigned int count)
+{
+        if (count == 0)
+                return;
+        fpga_xfer_wait(fpga_xfer_submit(addr, data, count, false, NULL, NULL));
+}
+
+void            fpga_write_burst(unsigned int addr, const uint32_t *data, unsigned int count)
+{
+        if (count == 0)
+                return;
+        fpga_xfer_wait(fpga_xfer_submit(addr, (uint32_t *)data, count, true, NULL, NULL));
+}
+
+void            fpga_spi_get_stats(fpga_spi_stats_t *stats)
+{
+        *stats = spi_stats;
+}
+
+void            fpga_spi_clear_stats(void)
+{
+        spi_stats.transactions = 0;
+        spi_stats.bytes = 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FPGA_XFER_H
+#define FPGA_XFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Backend interface for the register transaction queue (fpga_xfer.c),
+ * which implements the queue and register I/O parts of fpga.h.
+ *
+ * start() puts one transaction on the wire:  len bytes of buf, an
+ * address header then the data words, big-endian.  For reads, the
+ * bytes clocked in replace buf's (past the header).  When it's done,
+ * the backend calls fpga_xfer_complete(), from IRQ context or from
+ * within start() itself.
+ */
+typedef struct {
+        void    (*start)(uint8_t *buf, unsigned int len, bool write);
+} fpga_xfer_backend_t;
+
+void    fpga_xfer_init(const fpga_xfer_backend_t *backend);
+void    fpga_xfer_complete(void);
+
+#endif
@@ -78,7 +78,7 @@
 #define MCU_FPGA_CLK            24      /* Out, GPOUT2 */
 #define MCU_FPGA_CLK_OUTPUT	CLOCKS_CLK_GPOUT1_CTRL_AUXSRC_VALUE_CLK_SYS
 
-/* MCLK on 20, PWM2A */
+#define MCU_VID_I2S_MCLK        20      /* Out, PWM2A */
 
 /* Video serialiser config interface */
 #define MCU_VID_IRQ             21      /* In */
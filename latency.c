@@ -0,0 +1,129 @@
+/* latency: mode-switch pipeline latency tracepoints
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include "latency.h"
+#if !PICO_ON_DEVICE
+#include "fpga_sim.h"
+#endif
+
+
+static const char *lat_names[LAT_NUM_STAGES] = {
+        [LAT_MODE_CHANGE]       = "mode_change",
+        [LAT_SETTLE]            = "settle",
+        [LAT_FLYBACK]           = "flyback",
+        [LAT_SOLVE]             = "solve",
+        [LAT_PLL_SHIFT]         = "pll_shift",
+        [LAT_PLL_LOCK]          = "pll_lock",
+        [LAT_VIDO_WRITE]        = "vido_write",
+        [LAT_SYNC]              = "sync",
+        [LAT_DVO]               = "dvo",
+};
+
+static lat_stat_t       lat_stats[LAT_NUM_STAGES];
+static uint32_t         lat_start[LAT_NUM_STAGES];
+static uint32_t         lat_open;       /* Bitmap of begun stages */
+
+static inline uint32_t  lat_now(void)
+{
+#if PICO_ON_DEVICE
+        return time_us_32();
+#else
+        return (uint32_t)fpga_sim_time_us();
+#endif
+}
+
+void            lat_begin(lat_stage_t s)
+{
+        lat_start[s] = lat_now();
+        lat_open |= 1 << s;
+}
+
+void            lat_end(lat_stage_t s)
+{
+        uint32_t us = lat_now() - lat_start[s];
+        lat_stat_t *st = &lat_stats[s];
+
+        if (!(lat_open & (1 << s)))
+                return;
+        lat_open &= ~(1 << s);
+
+        unsigned int b = us ? 32 - __builtin_clz(us) : 0;
+
+        if (b >= LAT_BUCKETS)
+                b = LAT_BUCKETS - 1;
+        st->hist[b]++;
+        if (st->count == 0 || us < st->min_us)
+                st->min_us = us;
+        if (us > st->max_us)
+                st->max_us = us;
+        st->total_us += us;
+        st->count++;
+}
+
+void            lat_cancel(lat_stage_t s)
+{
+        lat_open &= ~(1 << s);
+}
+
+void            lat_get(lat_stage_t s, lat_stat_t *st)
+{
+        *st = lat_stats[s];
+}
+
+void            lat_clear(void)
+{
+        memset(lat_stats, 0, sizeof(lat_stats));
+        lat_open = 0;
+}
+
+void            lat_status(void)
+{
+        printf("Stage          count      min      avg      max (us)\r\n");
+        for (unsigned int i = 0; i < LAT_NUM_STAGES; i++) {
+                const lat_stat_t *st = &lat_stats[i];
+
+                printf("%-12s %7d %8d %8d %8d\r\n", lat_names[i], st->count,
+                       st->min_us, st->count ? st->total_us / st->count : 0, st->max_us);
+        }
+}
+
+void            lat_dump(void)
+{
+        printf("LAT %d %d %d\r\n", LAT_FORMAT_VERSION, LAT_NUM_STAGES, LAT_BUCKETS);
+        for (unsigned int i = 0; i < LAT_NUM_STAGES; i++) {
+                const lat_stat_t *st = &lat_stats[i];
+
+                printf("%s %d %d %d %d", lat_names[i], st->count, st->min_us,
+                       st->count ? st->total_us / st->count : 0, st->max_us);
+                for (unsigned int b = 0; b < LAT_BUCKETS; b++)
+                        printf(" %d", st->hist[b]);
+                printf("\r\n");
+        }
+        printf("END\r\n");
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Mode-switch pipeline latency tracepoints.
+ *
+ * Each stage is timed (in microseconds, from the RP2040 timer) from its
+ * LAT_BEGIN() to its LAT_END(), which may be in different functions; an
+ * END without a BEGIN is ignored, and a repeated BEGIN restarts the
+ * stage.  LAT_CANCEL() drops a begun stage without counting it (e.g. a
+ * reconfig that turned out not to change the mode).  Per stage, the count,
+ * min/avg/max and a log2 histogram are kept.  In the host build, times are
+ * the simulator's.
+ *
+ * LATENCY_TRACE is a CMake option (default ON).  With it off, latency.c
+ * isn't built, the tracepoints compile away, and there's no 'lat' command.
+ *
+ * Dump format (text, one record per line):
+ *      "LAT <version> <stages> <buckets>"
+ *      then per stage:
+ *      "<name> <count> <min_us> <avg_us> <max_us> <bucket 0> ... <bucket n-1>"
+ *      then "END".
+ * Bucket 0 counts 0us, bucket i counts [2^(i-1), 2^i) us, and the last
+ * bucket also counts everything longer.
+ */
+
+#ifndef LATENCY_TRACE
+#define LATENCY_TRACE           1
+#endif
+
+#define LAT_BUCKETS             20              /* Up to ~0.5s */
+#define LAT_FORMAT_VERSION      1
+
+typedef enum {
+        LAT_MODE_CHANGE = 0,    /* VIDC reconfig seen, to output synced */
+        LAT_SETTLE,             /* Reconfig seen, to VIDC stable */
+        LAT_FLYBACK,            /* Waiting for flyback before probing */
+        LAT_SOLVE,              /* Mode cache lookup/solver */
+        LAT_PLL_SHIFT,          /* PLL reset and config shift-in */
+        LAT_PLL_LOCK,           /* PLL reset release to lock */
+        LAT_VIDO_WRITE,         /* VIDO register writes */
+        LAT_SYNC,               /* Sync request to ack */
+        LAT_DVO,                /* Transmitter timing update */
+        LAT_NUM_STAGES
+} lat_stage_t;
+
+typedef struct {
+        uint32_t        count;
+        uint32_t        min_us;
+        uint32_t        max_us;
+        uint32_t        total_us;
+        uint32_t        hist[LAT_BUCKETS];
+} lat_stat_t;
+
+#if LATENCY_TRACE
+#define LAT_BEGIN(s)            lat_begin(s)
+#define LAT_END(s)              lat_end(s)
+#define LAT_CANCEL(s)           lat_cancel(s)
+
+void            lat_begin(lat_stage_t s);
+void            lat_end(lat_stage_t s);
+void            lat_cancel(lat_stage_t s);
+void            lat_get(lat_stage_t s, lat_stat_t *st);
+void            lat_clear(void);
+void            lat_status(void);
+/* Machine-readable, for a host tool */
+void            lat_dump(void);
+#else
+#define LAT_BEGIN(s)            do { } while (0)
+#define LAT_END(s)              do { } while (0)
+#define LAT_CANCEL(s)           do { } while (0)
+#endif
+
+#endif
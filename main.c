@@ -26,15 +26,33 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <stdlib.h>
 #include "pico/stdlib.h"
+#if PICO_ON_DEVICE
+#include "pico/multicore.h"
+#include "hardware/gpio.h"
+#endif
 
 #include "version.h"
 #include "fpga.h"
+#include "regcache.h"
 #include "hw.h"
 #include "dvo.h"
 #include "vidc_regs.h"
 #include "commands.h"
+#include "events.h"
+#include "console.h"
+#include "modestore.h"
 #include "video.h"
+#include "video_loop.h"
+#include "audio.h"
+#include "vidc_sound.h"
+#include "capture.h"
+#include "edid.h"
+#if !PICO_ON_DEVICE
+#include "fpga_sim.h"
+#include "sim_sweep.h"
+#endif
 
 
 /******************************************************************************/
@@ -43,6 +61,13 @@ extern uint8_t fpga_bitstream[];
 extern unsigned int fpga_bitstream_length;
 uint8_t flag_autoprobe_mode = 1;
 uint8_t flag_test_mode = 0;
+/* Detect VIDC reconfiguration from the FPGA IRQ, rather than polling: */
+uint8_t flag_irq_mode = 1;
+
+/* In IRQ mode, still check occasionally in case an edge is missed (or the
+ * bitstream doesn't drive the IRQ):
+ */
+#define VIDC_FALLBACK_POLL_MS   250
 
 /******************************************************************************/
 
@@ -53,7 +78,7 @@ uint8_t flag_test_mode = 0;
  */
 static void     cfg_init(void)
 {
-#ifdef MCU_CFG1
+#if defined(MCU_CFG1) && PICO_ON_DEVICE
         /* Only 1 switch is required at this time. */
         gpio_init(MCU_CFG1);
         gpio_set_dir(MCU_CFG1, GPIO_IN);
@@ -73,7 +98,7 @@ static void     cfg_init(void)
 /* Return config DIP switch values */
 uint32_t        cfg_get(void)
 {
-#ifdef MCU_CFG1
+#if defined(MCU_CFG1) && PICO_ON_DEVICE
         return (gpio_get(MCU_CFG1) ? 0 : 1) |
                 (gpio_get(MCU_CFG2) ? 0 : 2) |
                 (gpio_get(MCU_CFG3) ? 0 : 4) |
@@ -83,60 +108,137 @@ uint32_t        cfg_get(void)
 #endif
 }
 
-static void     vidc_config_poll(void)
+#if PICO_ON_DEVICE
+static void     gpio_irq(unsigned int gpio, uint32_t events)
 {
-        uint32_t s = fpga_read32(FPGA_VO(VIDO_REG_SYNC));
-
-        int status = !!(s & 8);
-        int ack = !!(s & 4);
-
-        if (status != ack) {
-                // FIXME: Delay a frame or so, so that all writes have Probably Happened
-                printf("<VIDC RECONFIG %08x>\r\n", s);
-                fpga_write32(FPGA_VO(VIDO_REG_SYNC), s ^ 4); // Flip ack, enables further detection.
-
-                if (flag_autoprobe_mode)
-                        video_probe_mode(false);
+        if (gpio == MCU_FPGA_IRQ) {
+                event_post(EVT_VIDC_RECONFIG);
+        } else if (gpio == MCU_VID_IRQ) {
+                video_loop_dvo_irq();
         }
 }
+#endif
 
-int main()
+#if PICO_ON_DEVICE
+static bool     vidc_fallback_poll(repeating_timer_t *rt)
 {
-	stdio_init_all();
+        event_post(EVT_VIDC_POLL);
+        return true;
+}
+#endif
 
-	printf("ArcDVI version " BUILD_VERSION " (" BUILD_SHA "), built " BUILD_TIME "\n");
+/* Core 1 owns the video control plane:  the FPGA (and its SPI bus, and the
+ * register cache), VIDC monitoring, mode probing and output programming.
+ * Console commands that need the FPGA are handed over from core 0 and run
+ * here, so nothing else touches it.  Output goes back to core 0 through
+ * the console ring (console.c).
+ */
+static void     video_core_main(void)
+{
+#if PICO_ON_DEVICE
+        repeating_timer_t poll_timer;
+#endif
 
-        cmd_init();
-        cfg_init();
         fpga_init();
 
         printf("FPGA: Bitstream %d bytes at %p, programming:\n",
                fpga_bitstream_length, fpga_bitstream);
         int r = fpga_load(fpga_bitstream, fpga_bitstream_length);
         printf(" -> Return value %d\n", r);
+        regcache_init();
 
         sleep_ms(10);
 
-	if (fpga_read32(FPGA_CTRL(CTRL_ID)) & CTRL_ID_TEST)
+	if (regcache_read(FPGA_CTRL(CTRL_ID)) & CTRL_ID_TEST)
 		flag_test_mode = 1;
 
         dvo_init();
+        edid_update();
         video_init();
+        audio_init(AUDIO_RATE_DEFAULT);
+        vidc_sound_init();
+        capture_init();
 
 	/* If we're in test mode, initialise output to a sane mode: */
 	if (flag_test_mode)
 		video_set_mode(VMODE_1152);
+        else
+                video_restore_mode();
 
-        /* Active hot-spinning loop to poll various services (monitor regs,
-         * interactive UART IO, update OSD, etc.)
+#if PICO_ON_DEVICE
+        /* The FPGA raises IRQ when VIDC's HCR/VCR have been written.  GPIO
+         * IRQs are per-core, so this is enabled from (and taken on) core 1:
          */
-        while (1) {
-                /* Poll user IO */
-                cmd_poll();
+        gpio_set_irq_enabled_with_callback(MCU_FPGA_IRQ, GPIO_IRQ_EDGE_RISE, true, gpio_irq);
+        /* The transmitter's IRQ (active low) reports monitor hot-plug: */
+        gpio_set_irq_enabled(MCU_VID_IRQ, GPIO_IRQ_EDGE_FALL, true);
+        if (!gpio_get(MCU_VID_IRQ))
+                event_post(EVT_DVO_IRQ);
+        add_repeating_timer_ms(VIDC_FALLBACK_POLL_MS, vidc_fallback_poll, NULL, &poll_timer);
+#endif
+
+        /* Main loop to service various things (monitor regs, console
+         * commands, update OSD, etc.); see video_loop.c
+         */
+        while (1)
+                video_loop_dispatch();
+}
 
-		if (!flag_test_mode)
-			vidc_config_poll();
+#if PICO_ON_DEVICE
+/* Core 0 owns USB CDC and the console, and runs the commands that don't
+ * need the FPGA, so a slow or busy console can't hold up mode switches.
+ */
+int main()
+{
+	stdio_init_all();
+        console_init();
+
+	printf("ArcDVI version " BUILD_VERSION " (" BUILD_SHA "), built " BUILD_TIME "\n");
+
+        cmd_init();
+        events_init();
+        modestore_init();
+        cfg_init();
+
+        /* Core 1 writes flash (mode store), so must be able to park this
+         * core whilst XIP is unavailable:
+         */
+        multicore_lockout_victim_init();
+        multicore_launch_core1(video_core_main);
+
+        while (1) {
+                /* Pass on output (from both cores), and poll user IO */
+                console_drain();
+                cmd_poll(1000);
         }
 
 	return 0;
 }
+#else
+/* Host build:  the video core runs against the FPGA simulator, driven by a
+ * scenario script (see fpga_sim.c).  Or, sweep the mode derivation (see
+ * sim_sweep.c).
+ */
+int main(int argc, char *argv[])
+{
+        if (argc >= 2 && argv[1][0] == '-')
+                return sim_sweep_main(argc - 1, argv + 1);
+        if (argc != 2) {
+                fprintf(stderr, "Syntax: %s <scenario> | -s [<golden>] | -S <golden> | -l\n",
+                        argv[0]);
+                return 1;
+        }
+        if (fpga_sim_load(argv[1]) < 0)
+                return 1;
+
+	printf("ArcDVI version " BUILD_VERSION " (" BUILD_SHA "), built " BUILD_TIME ", simulated\n");
+
+        cmd_init();
+        events_init();
+        modestore_init();
+        cfg_init();
+        video_core_main();
+
+        return 0;
+}
+#endif
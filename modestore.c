@@ -0,0 +1,387 @@
+/* ArcDVI: flash-backed store of known modes
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+#if PICO_ON_DEVICE
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#endif
+
+#include "modestore.h"
+#include "video_solve.h"
+#if !PICO_ON_DEVICE
+#include "flash_sim.h"
+#endif
+
+
+/* The store lives in the last two sectors of flash.  Each sector has a
+ * header page (written last, so a sector only becomes valid once it's
+ * complete) followed by one record per page.  Records are appended
+ * until the sector is full, then the most recent distinct modes are
+ * compacted into the other sector, which then takes over with a newer
+ * generation number.  This spreads erases over both sectors, and a
+ * power loss at any point leaves either the old sector, or the new one,
+ * intact.  A torn record fails its CRC and is skipped.
+ *
+ * A record also says which monitor (EDID hash) and which version of the
+ * solver the mode was derived for.  Records for anything else are
+ * ignored, and dropped at the next compaction.
+ */
+
+#define MS_SECTORS      2
+#if PICO_ON_DEVICE
+#define MS_BASE         (PICO_FLASH_SIZE_BYTES - MS_SECTORS*FLASH_SECTOR_SIZE)
+#else
+/* Host build:  the store's in RAM (see flash_sim.c), so starts empty each run */
+#define FLASH_SECTOR_SIZE       FLASH_SIM_SECTOR_SIZE
+#define FLASH_PAGE_SIZE         FLASH_SIM_PAGE_SIZE
+#define MS_BASE         0
+#endif
+#define MS_PAGES        (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)   /* Incl. header */
+#define MS_KEEP         8       /* Distinct modes kept when compacting */
+
+#define MS_MAGIC_SECTOR 0x534d4441      /* "ADMS" */
+#define MS_MAGIC_REC    0x524d4441      /* "ADMR" */
+/* Changes if the record layout does, which invalidates the store: */
+#define MS_VERSION      ((1 << 16) | sizeof(ms_record_t))
+
+typedef struct {
+        uint32_t        magic;
+        uint32_t        version;
+        uint32_t        generation;
+        uint32_t        crc;
+} ms_header_t;
+
+typedef struct {
+        uint32_t        magic;
+        uint32_t        seq;
+        uint32_t        edid_hash;
+        uint32_t        solver;         /* VSOLVE_VERSION */
+        vidc_timing_t   key;
+        video_mode_t    mode;
+        uint32_t        crc;
+} ms_record_t;
+
+static int              active = -1;    /* Sector in use, or -1 if none */
+static uint32_t         generation;
+static unsigned int     next_page;      /* First free page in active sector */
+static const ms_record_t *last;         /* Most recent record (in XIP), any monitor */
+
+
+static uint32_t ms_crc(const void *data, size_t len)
+{
+        const uint8_t *p = data;
+        uint32_t crc = ~0;
+
+        while (len--) {
+                crc ^= *p++;
+                for (int i = 0; i < 8; i++)
+                        crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+        return ~crc;
+}
+
+static const void *ms_page(int sector, unsigned int page)
+{
+#if PICO_ON_DEVICE
+        return (const void *)(uintptr_t)(XIP_BASE + MS_BASE + sector*FLASH_SECTOR_SIZE +
+                              page*FLASH_PAGE_SIZE);
+#else
+        return flash_sim_data(MS_BASE + sector*FLASH_SECTOR_SIZE + page*FLASH_PAGE_SIZE);
+#endif
+}
+
+static bool     ms_blank(const void *p, size_t len)
+{
+        const uint8_t *b = p;
+
+        while (len--) {
+                if (*b++ != 0xff)
+                        return false;
+        }
+        return true;
+}
+
+static bool     ms_header_valid(int sector)
+{
+        const ms_header_t *h = ms_page(sector, 0);
+
+        return h->magic == MS_MAGIC_SECTOR && h->version == MS_VERSION &&
+                h->crc == ms_crc(h, offsetof(ms_header_t, crc));
+}
+
+static bool     ms_record_valid(const ms_record_t *r)
+{
+        return r->magic == MS_MAGIC_REC &&
+                r->crc == ms_crc(r, offsetof(ms_record_t, crc));
+}
+
+/* Valid, and derived by this solver for this monitor */
+static bool     ms_record_usable(const ms_record_t *r, uint32_t edid_hash)
+{
+        return ms_record_valid(r) && r->edid_hash == edid_hash &&
+                r->solver == VSOLVE_VERSION;
+}
+
+/* Flash writes: the XIP cache is flushed by the SDK afterwards.  Once the
+ * other core is running, it must be parked (in RAM) as well.
+ */
+#if PICO_ON_DEVICE
+static uint32_t ms_flash_begin(void)
+{
+        if (multicore_lockout_victim_is_initialized(get_core_num() ^ 1))
+                multicore_lockout_start_blocking();
+        return save_and_disable_interrupts();
+}
+
+static void     ms_flash_end(uint32_t irqs)
+{
+        restore_interrupts(irqs);
+        if (multicore_lockout_victim_is_initialized(get_core_num() ^ 1))
+                multicore_lockout_end_blocking();
+}
+
+static void     ms_program(int sector, unsigned int page, const void *data, size_t len)
+{
+        uint8_t buf[FLASH_PAGE_SIZE];
+
+        memset(buf, 0xff, sizeof(buf));
+        memcpy(buf, data, len);
+
+        uint32_t irqs = ms_flash_begin();
+        flash_range_program(MS_BASE + sector*FLASH_SECTOR_SIZE + page*FLASH_PAGE_SIZE,
+                            buf, FLASH_PAGE_SIZE);
+        ms_flash_end(irqs);
+}
+
+static void     ms_erase(int sector)
+{
+        uint32_t irqs = ms_flash_begin();
+        flash_range_erase(MS_BASE + sector*FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+        ms_flash_end(irqs);
+}
+#else
+static void     ms_program(int sector, unsigned int page, const void *data, size_t len)
+{
+        flash_sim_program(MS_BASE + sector*FLASH_SECTOR_SIZE + page*FLASH_PAGE_SIZE,
+                          data, len);
+}
+
+static void     ms_erase(int sector)
+{
+        flash_sim_erase(MS_BASE + sector*FLASH_SECTOR_SIZE);
+}
+#endif
+
+/* Find the latest record, and the append point, in the active sector */
+static void     ms_scan(void)
+{
+        last = NULL;
+        next_page = MS_PAGES;
+
+        if (active < 0)
+                return;
+
+        for (unsigned int p = 1; p < MS_PAGES; p++) {
+                const ms_record_t *r = ms_page(active, p);
+
+                if (ms_blank(r, FLASH_PAGE_SIZE)) {
+                        next_page = p;
+                        break;
+                }
+                if (ms_record_valid(r))
+                        last = r;
+        }
+}
+
+void            modestore_init(void)
+{
+        active = -1;
+        generation = 0;
+
+        for (int s = 0; s < MS_SECTORS; s++) {
+                const ms_header_t *h = ms_page(s, 0);
+
+                if (ms_header_valid(s) &&
+                    (active < 0 || (int32_t)(h->generation - generation) > 0)) {
+                        active = s;
+                        generation = h->generation;
+                }
+        }
+        ms_scan();
+}
+
+static void     ms_fill_record(ms_record_t *r, uint32_t seq, uint32_t edid_hash,
+                               const vidc_timing_t *key, const video_mode_t *m)
+{
+        memset(r, 0, sizeof(*r));
+        r->magic = MS_MAGIC_REC;
+        r->seq = seq;
+        r->edid_hash = edid_hash;
+        r->solver = VSOLVE_VERSION;
+        r->key = *key;
+        r->mode = *m;
+        r->crc = ms_crc(r, offsetof(ms_record_t, crc));
+}
+
+/* Move the most recent distinct modes for this monitor (plus the new one)
+ * into the other sector.
+ */
+static void     ms_compact(uint32_t edid_hash, const vidc_timing_t *key,
+                           const video_mode_t *m)
+{
+        ms_record_t keep[MS_KEEP];
+        unsigned int nkeep = 0;
+        int target = (active < 0) ? 0 : (active + 1) % MS_SECTORS;
+
+        /* Newest first, skipping duplicates and the mode being saved: */
+        for (int p = (active < 0) ? 0 : MS_PAGES - 1; p > 0 && nkeep < MS_KEEP - 1; p--) {
+                const ms_record_t *r = ms_page(active, p);
+                bool dup = false;
+
+                if (!ms_record_usable(r, edid_hash) ||
+                    memcmp(&r->key, key, sizeof(*key)) == 0)
+                        continue;
+                for (unsigned int i = 0; i < nkeep; i++) {
+                        if (memcmp(&keep[i].key, &r->key, sizeof(*key)) == 0)
+                                dup = true;
+                }
+                if (!dup)
+                        keep[nkeep++] = *r;
+        }
+
+        ms_erase(target);
+
+        /* Oldest first, so the new mode is last: */
+        unsigned int page = 1;
+        for (int i = nkeep - 1; i >= 0; i--) {
+                ms_record_t r;
+
+                ms_fill_record(&r, page, edid_hash, &keep[i].key, &keep[i].mode);
+                ms_program(target, page++, &r, sizeof(r));
+        }
+        ms_record_t r;
+        ms_fill_record(&r, page, edid_hash, key, m);
+        ms_program(target, page++, &r, sizeof(r));
+
+        /* Finally, the header makes this sector the valid one: */
+        ms_header_t h;
+        h.magic = MS_MAGIC_SECTOR;
+        h.version = MS_VERSION;
+        h.generation = generation + 1;
+        h.crc = ms_crc(&h, offsetof(ms_header_t, crc));
+        ms_program(target, 0, &h, sizeof(h));
+
+        active = target;
+        generation = h.generation;
+        ms_scan();
+}
+
+void            modestore_save(uint32_t edid_hash, const vidc_timing_t *key,
+                               const video_mode_t *m)
+{
+        if (last && ms_record_usable(last, edid_hash) &&
+            memcmp(&last->key, key, sizeof(*key)) == 0 &&
+            memcmp(&last->mode, m, sizeof(*m)) == 0)
+                return;         /* Already the last-used mode */
+
+        if (active < 0 || next_page >= MS_PAGES) {
+                ms_compact(edid_hash, key, m);
+        } else {
+                ms_record_t r;
+
+                ms_fill_record(&r, last ? last->seq + 1 : 1, edid_hash, key, m);
+                ms_program(active, next_page, &r, sizeof(r));
+                ms_scan();
+        }
+}
+
+bool            modestore_last(uint32_t edid_hash, vidc_timing_t *key, video_mode_t *m)
+{
+        if (active < 0)
+                return false;
+
+        for (unsigned int p = next_page - 1; p > 0; p--) {
+                const ms_record_t *r = ms_page(active, p);
+
+                if (ms_record_usable(r, edid_hash)) {
+                        *key = r->key;
+                        *m = r->mode;
+                        return true;
+                }
+        }
+        return false;
+}
+
+void            modestore_foreach(uint32_t edid_hash,
+                                  void (*fn)(const vidc_timing_t *key,
+                                             const video_mode_t *m))
+{
+        if (active < 0)
+                return;
+
+        for (unsigned int p = 1; p < next_page; p++) {
+                const ms_record_t *r = ms_page(active, p);
+
+                if (ms_record_usable(r, edid_hash))
+                        fn(&r->key, &r->mode);
+        }
+}
+
+void            modestore_erase(void)
+{
+        for (int s = 0; s < MS_SECTORS; s++)
+                ms_erase(s);
+        modestore_init();
+}
+
+void            modestore_dump(void)
+{
+        if (active < 0) {
+                printf("Mode store: empty\r\n");
+                return;
+        }
+        printf("Mode store: sector %d, generation %d, %d/%d pages used\r\n",
+               active, generation, next_page - 1, MS_PAGES - 1);
+        for (unsigned int p = 1; p < next_page; p++) {
+                const ms_record_t *r = ms_page(active, p);
+
+                if (!ms_record_valid(r)) {
+                        printf("  %2d: (invalid)\r\n", p);
+                        continue;
+                }
+                printf("  %2d: seq %d, hash %08x, EDID %08x, solver %d, %dx%d, "
+                       "pclk %d.%03d MHz%s\r\n",
+                       p, r->seq, vidc_timing_hash(&r->key), r->edid_hash, r->solver,
+                       r->mode.vido[VIDO_REG_RES_X] & 0x7ff,
+                       r->mode.vido[VIDO_REG_RES_Y] & 0x7ff,
+                       r->mode.pclk_khz / 1000, r->mode.pclk_khz % 1000,
+                       r == last ? " (last used)" : "");
+        }
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODESTORE_H
+#define MODESTORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vidc_regs.h"
+#include "video.h"
+
+/* Flash-backed store of resolved modes, keyed by VIDC timing.  The most
+ * recently saved entry is the last-used mode, restored at boot.  Modes are
+ * stored against the monitor they were solved for (edid_info_hash()) and
+ * the solver's VSOLVE_VERSION, and are only returned for the same.
+ */
+
+void            modestore_init(void);
+/* Get the most recently saved mode; false if there's none */
+bool            modestore_last(uint32_t edid_hash, vidc_timing_t *key, video_mode_t *m);
+/* Calls fn for each stored mode, oldest first */
+void            modestore_foreach(uint32_t edid_hash,
+                                  void (*fn)(const vidc_timing_t *key,
+                                             const video_mode_t *m));
+/* Record a mode as being in use (writes flash if it's not already the last).
+ * Writing flash stalls both cores, for milliseconds if a sector's erased,
+ * so this is best kept off the mode-change path.
+ */
+void            modestore_save(uint32_t edid_hash, const vidc_timing_t *key,
+                               const video_mode_t *m);
+void            modestore_erase(void);
+void            modestore_dump(void);
+
+#endif
@@ -0,0 +1,165 @@
+/* iCE40 PLL coefficient solver
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stddef.h>
+#include "pll.h"
+
+/* Loop filter range, by PFD frequency (as per icepll) */
+static unsigned int     pll_filter_range(uint32_t pfd_khz)
+{
+        if (pfd_khz < 17000)
+                return 1;
+        else if (pfd_khz < 26000)
+                return 2;
+        else if (pfd_khz < 44000)
+                return 3;
+        else if (pfd_khz < 66000)
+                return 4;
+        else if (pfd_khz < 101000)
+                return 5;
+        else
+                return 6;
+}
+
+/* Visit every legal DIVR/DIVF/DIVQ combination that produces an output
+ * within [lo, hi].  The callback returns true to keep the candidate as the
+ * new best.  Iteration order is DIVR, DIVQ, DIVF ascending, and the first
+ * of equally-good candidates wins, which reproduces the hand-picked
+ * values used previously (e.g. 96MHz = 0/31/3, 36MHz = 0/23/4).
+ */
+typedef bool (*pll_better_t)(uint32_t fout, uint32_t best, uint32_t arg);
+
+static bool     pll_search(uint32_t fin_khz, uint32_t lo, uint32_t hi,
+                           pll_better_t better, uint32_t arg, pll_coeffs_t *c)
+{
+        bool found = false;
+
+        for (unsigned int divr = 0; divr < 16; divr++) {
+                uint32_t pfd = fin_khz / (divr + 1);
+
+                if (pfd < PLL_PFD_MIN_KHZ || pfd > PLL_PFD_MAX_KHZ)
+                        continue;
+                for (unsigned int divq = 1; divq <= 6; divq++) {
+                        for (unsigned int divf = 0; divf < 128; divf++) {
+                                uint32_t vco = pfd * (divf + 1);
+
+                                if (vco < PLL_VCO_MIN_KHZ)
+                                        continue;
+                                if (vco > PLL_VCO_MAX_KHZ)
+                                        break;
+                                /* Use the exact ratio rather than the truncated PFD */
+                                uint32_t fout = (fin_khz * (divf + 1)) /
+                                        ((divr + 1) << divq);
+
+                                if (fout < lo || fout > hi)
+                                        continue;
+                                if (found && !better(fout, c->fout_khz, arg))
+                                        continue;
+                                c->divr = divr;
+                                c->divf = divf;
+                                c->divq = divq;
+                                c->filter = pll_filter_range(pfd);
+                                c->fout_khz = fout;
+                                found = true;
+                        }
+                }
+        }
+        return found;
+}
+
+static uint32_t abs_diff(uint32_t a, uint32_t b)
+{
+        return a > b ? a - b : b - a;
+}
+
+static bool     pll_closer(uint32_t fout, uint32_t best, uint32_t target)
+{
+        return abs_diff(fout, target) < abs_diff(best, target);
+}
+
+static bool     pll_lower(uint32_t fout, uint32_t best, uint32_t unused)
+{
+        (void)unused;
+        return fout < best;
+}
+
+bool    pll_solve(uint32_t fin_khz, uint32_t target_khz, pll_coeffs_t *c)
+{
+        return pll_search(fin_khz, PLL_OUT_MIN_KHZ, PLL_OUT_MAX_KHZ,
+                          pll_closer, target_khz, c);
+}
+
+bool    pll_solve_min(uint32_t fin_khz, uint32_t min_khz, uint32_t max_khz,
+                      pll_coeffs_t *c)
+{
+        if (min_khz < PLL_OUT_MIN_KHZ)
+                min_khz = PLL_OUT_MIN_KHZ;
+        if (max_khz > PLL_OUT_MAX_KHZ)
+                max_khz = PLL_OUT_MAX_KHZ;
+        return pll_search(fin_khz, min_khz, max_khz, pll_lower, 0, c);
+}
+
+/* The search is ~10K iterations, which is noticeable when done per mode
+ * change; the handful of clocks actually used are remembered.
+ */
+bool    pll_lookup(pll_memo_t *memo, uint32_t target_khz, pll_coeffs_t *c)
+{
+        for (unsigned int i = 0; memo && i < PLL_MEMO_ENTRIES; i++) {
+                if (memo->e[i].c.fout_khz != 0 &&
+                    memo->e[i].target_khz == target_khz) {
+                        *c = memo->e[i].c;
+                        return true;
+                }
+        }
+        if (!pll_solve(PLL_REF_KHZ, target_khz, c))
+                return false;
+        if (memo) {
+                memo->e[memo->next].target_khz = target_khz;
+                memo->e[memo->next].c = *c;
+                memo->next = (memo->next + 1) % PLL_MEMO_ENTRIES;
+        }
+        return true;
+}
+
+/* From Yosys's documentation, for ICE40HX the word consists of:
+ * [   25] FSEnet                               1 (Simple)
+ * [24:23] pllout1Sel                           0 (Genclk. doc'd 2 but only 0 works)
+ * [   22] Source Clock (0=Pad, 1=Fabric)       1 (fabric)
+ * [   21] ShiftReg[0]                          0 (Mode 0, not used)
+ * [20:19] pllout2Sel                           0 (Genclk, doc'd 2 but only 0 works)
+ * [18:17] delaymuxsel                          0 (Delay)
+ * [16:14] FILTER_RANGE
+ * [13:11] DIVQ
+ * [10: 4] DIVF
+ * [ 3: 0] DIVR
+ */
+uint32_t        pll_config_word(const pll_coeffs_t *c)
+{
+        return (1 << 25) | (0 << 23) | (1 << 22) | (0 << 19) |
+                ((uint32_t)c->filter << 14) |
+                ((uint32_t)c->divq << 11) |
+                ((uint32_t)c->divf << 4) |
+                c->divr;
+}
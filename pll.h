@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PLL_H
+#define PLL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* iCE40HX SB_PLL40 coefficient solver.
+ *
+ * This is pure arithmetic (no hardware access, no printf) so that it
+ * can be built and checked on a host as well as on the RP2040.
+ */
+
+/* Reference clock into the PLL (from the FPGA fabric) */
+#define PLL_REF_KHZ             24000
+
+/* Datasheet limits: */
+#define PLL_PFD_MIN_KHZ         10000
+#define PLL_PFD_MAX_KHZ         133000
+#define PLL_VCO_MIN_KHZ         533000
+#define PLL_VCO_MAX_KHZ         1066000
+#define PLL_OUT_MIN_KHZ         16000
+#define PLL_OUT_MAX_KHZ         275000
+
+typedef struct {
+        uint8_t         divr;           /* 0-15 */
+        uint8_t         divf;           /* 0-127 */
+        uint8_t         divq;           /* 1-6 */
+        uint8_t         filter;         /* FILTER_RANGE, 1-6 */
+        uint32_t        fout_khz;       /* Achieved output frequency */
+} pll_coeffs_t;
+
+/* Find the coefficients giving the closest achievable output to
+ * target_khz.  Returns false if nothing is in range at all.
+ */
+bool            pll_solve(uint32_t fin_khz, uint32_t target_khz, pll_coeffs_t *c);
+/* Find the lowest achievable output that's >= min_khz and <= max_khz */
+bool            pll_solve_min(uint32_t fin_khz, uint32_t min_khz, uint32_t max_khz,
+                              pll_coeffs_t *c);
+/* Solutions remembered by pll_lookup(); owned by the caller, and zeroed
+ * to start with.
+ */
+#define PLL_MEMO_ENTRIES        8
+
+typedef struct {
+        struct {
+                uint32_t        target_khz;
+                pll_coeffs_t    c;
+        } e[PLL_MEMO_ENTRIES];
+        unsigned int    next;
+} pll_memo_t;
+
+/* As pll_solve(), from PLL_REF_KHZ, memoised in memo (unless NULL) */
+bool            pll_lookup(pll_memo_t *memo, uint32_t target_khz, pll_coeffs_t *c);
+/* The 26-bit word shifted into the PLL config chain */
+uint32_t        pll_config_word(const pll_coeffs_t *c);
+
+#endif
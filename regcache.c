@@ -0,0 +1,227 @@
+/* ArcDVI: FPGA register shadow cache
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include "fpga.h"
+#include "regcache.h"
+#include "video.h"
+#include "hw.h"
+
+
+#define VIDC_WORDS      64      /* VIDC regs 0x000-0x0ff */
+#define VIDO_WORDS      16
+#define CTRL_WORDS      8
+
+/* Registers that must always be read from the FPGA: */
+#define VIDO_VOLATILE   (1 << VIDO_REG_SYNC)
+#define CTRL_VOLATILE   (~(1 << CTRL_ID))  /* Only the ID is constant */
+
+static uint32_t         vidc_shadow[VIDC_WORDS];
+static bool             vidc_valid;
+
+static uint32_t         vido_shadow[VIDO_WORDS];
+static uint32_t         vido_valid;     /* Bitmap */
+
+static uint32_t         ctrl_shadow[CTRL_WORDS];
+static uint32_t         ctrl_valid;     /* Bitmap */
+
+static regcache_stats_t stats[RC_NUM_BANKS];
+
+
+void            regcache_init(void)
+{
+        regcache_invalidate();
+        regcache_clear_stats();
+}
+
+void            regcache_invalidate_vidc(void)
+{
+        vidc_valid = false;
+}
+
+void            regcache_invalidate(void)
+{
+        vidc_valid = false;
+        vido_valid = 0;
+        ctrl_valid = 0;
+}
+
+/* Look up a word in a write-through bank */
+static uint32_t regcache_bank_read(regcache_bank_t b, unsigned int addr,
+                                   uint32_t *shadow, uint32_t *valid,
+                                   unsigned int r, uint32_t volatile_mask)
+{
+        if (volatile_mask & (1 << r)) {
+                stats[b].uncached++;
+                return fpga_read32(addr);
+        }
+        if (*valid & (1 << r)) {
+                stats[b].hits++;
+        } else {
+                stats[b].misses++;
+                shadow[r] = fpga_read32(addr);
+                *valid |= 1 << r;
+        }
+        return shadow[r];
+}
+
+uint32_t        regcache_read(unsigned int addr)
+{
+        if (addr < FPGA_VIDC(VIDC_WORDS)) {
+                if (vidc_valid) {
+                        stats[RC_BANK_VIDC].hits++;
+                } else {
+                        /* Snapshot the whole bank, it's all needed on a mode change */
+                        stats[RC_BANK_VIDC].misses++;
+                        fpga_read_burst(FPGA_VIDC(0), vidc_shadow, VIDC_WORDS);
+                        vidc_valid = true;
+                }
+                return vidc_shadow[addr - FPGA_VIDC(0)];
+        } else if (addr >= FPGA_VO(0) && addr < FPGA_VO(VIDO_WORDS)) {
+                return regcache_bank_read(RC_BANK_VIDO, addr, vido_shadow, &vido_valid,
+                                          addr - FPGA_VO(0), VIDO_VOLATILE);
+        } else if (addr >= FPGA_CTRL(0) && addr < FPGA_CTRL(CTRL_WORDS)) {
+                return regcache_bank_read(RC_BANK_CTRL, addr, ctrl_shadow, &ctrl_valid,
+                                          addr - FPGA_CTRL(0), CTRL_VOLATILE);
+        }
+        return fpga_read32(addr);
+}
+
+void            regcache_write(unsigned int addr, uint32_t data)
+{
+        fpga_write32(addr, data);
+
+        if (addr < FPGA_VIDC(VIDC_WORDS)) {
+                vidc_valid = false;
+        } else if (addr >= FPGA_VO(0) && addr < FPGA_VO(VIDO_WORDS)) {
+                unsigned int r = addr - FPGA_VO(0);
+
+                vido_shadow[r] = data;
+                vido_valid |= 1 << r;
+        } else if (addr >= FPGA_CTRL(0) && addr < FPGA_CTRL(CTRL_WORDS)) {
+                unsigned int r = addr - FPGA_CTRL(0);
+
+                ctrl_shadow[r] = data;
+                ctrl_valid |= 1 << r;
+                /* Video logic reset might reset the output regs too: */
+                if (r == CTRL_REG && (data & CR_RESET))
+                        vido_valid = 0;
+        }
+}
+
+void            regcache_write_burst(unsigned int addr, const uint32_t *data,
+                                     unsigned int count)
+{
+        fpga_write_burst(addr, data, count);
+
+        if (addr >= FPGA_VO(0) && (addr + count) <= FPGA_VO(VIDO_WORDS)) {
+                for (unsigned int i = 0; i < count; i++) {
+                        unsigned int r = addr - FPGA_VO(0) + i;
+
+                        vido_shadow[r] = data[i];
+                        vido_valid |= 1 << r;
+                }
+        } else {
+                /* Not expected elsewhere; just don't trust the shadows */
+                regcache_invalidate();
+        }
+}
+
+unsigned int    regcache_write_changed(unsigned int addr, const uint32_t *data,
+                                       unsigned int count, unsigned int *changed)
+{
+        unsigned int base = addr - FPGA_VO(0);
+        unsigned int written = 0;
+        unsigned int nchanged = 0;
+        unsigned int i = 0;
+
+        /* Changed words go in runs, none spanning a volatile reg.  With
+         * bursts, a run goes from the first to last changed word between
+         * volatile regs, rewriting any unchanged ones in between (as that's
+         * cheaper than another transaction); without, each word is its own
+         * transaction anyway, so a run ends at any unchanged word.
+         */
+        while (i < count) {
+                int first = -1, last = -1;
+
+                for (; i < count && !(VIDO_VOLATILE & (1 << (base + i))); i++) {
+                        unsigned int r = base + i;
+
+                        if ((vido_valid & (1 << r)) && vido_shadow[r] == data[i]) {
+#if !FPGA_SPI_BURST
+                                if (first >= 0) {
+                                        regcache_write_burst(addr + first, &data[first],
+                                                             last - first + 1);
+                                        written += last - first + 1;
+                                        first = -1;
+                                }
+#endif
+                                continue;
+                        }
+                        if (first < 0)
+                                first = i;
+                        last = i;
+                        nchanged++;
+                }
+                if (first >= 0) {
+                        regcache_write_burst(addr + first, &data[first], last - first + 1);
+                        written += last - first + 1;
+                }
+                i++;    /* Skip the volatile reg */
+        }
+        if (changed)
+                *changed = nchanged;
+        return written;
+}
+
+void            regcache_modify(unsigned int addr, uint32_t clear, uint32_t set)
+{
+        uint32_t v;
+
+        /* A volatile reg's shadow is the last value written, which is
+         * what's wanted for RMW of its writable bits:
+         */
+        if (addr >= FPGA_CTRL(0) && addr < FPGA_CTRL(CTRL_WORDS) &&
+            (ctrl_valid & (1 << (addr - FPGA_CTRL(0))))) {
+                stats[RC_BANK_CTRL].hits++;
+                v = ctrl_shadow[addr - FPGA_CTRL(0)];
+        } else {
+                v = regcache_read(addr);
+        }
+        regcache_write(addr, (v & ~clear) | set);
+}
+
+void            regcache_get_stats(regcache_bank_t bank, regcache_stats_t *s)
+{
+        *s = stats[bank];
+}
+
+void            regcache_clear_stats(void)
+{
+        memset(stats, 0, sizeof(stats));
+}
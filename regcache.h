@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef REGCACHE_H
+#define REGCACHE_H
+
+#include <stdint.h>
+
+/* Shadow cache of FPGA registers, to avoid redundant SPI reads.
+ *
+ * VIDO/CTRL registers are write-through; volatile registers (e.g.
+ * VIDO_REG_SYNC, CTRL_REG's status bits) always go to the FPGA.  The VIDC
+ * bank is snapshotted in one go on first use, and is valid until
+ * invalidated (when the VIDC reconfig status bit toggles).
+ */
+
+typedef enum {
+        RC_BANK_VIDC = 0,
+        RC_BANK_VIDO,
+        RC_BANK_CTRL,
+        RC_NUM_BANKS
+} regcache_bank_t;
+
+typedef struct {
+        unsigned int    hits;
+        unsigned int    misses;
+        unsigned int    uncached;       /* Volatile reg reads */
+} regcache_stats_t;
+
+void            regcache_init(void);
+uint32_t        regcache_read(unsigned int addr);
+void            regcache_write(unsigned int addr, uint32_t data);
+void            regcache_write_burst(unsigned int addr, const uint32_t *data,
+                                     unsigned int count);
+/* For VIDO:  write the words that differ from the shadow (all of them, if
+ * it's not valid), in as few transactions as possible; with FPGA_SPI_BURST,
+ * unchanged words between changed ones are rewritten to join bursts.
+ * Volatile regs (VIDO_REG_SYNC) in the range are skipped.  Returns the
+ * number of words written, and the number that differed in *changed (if
+ * not NULL).
+ */
+unsigned int    regcache_write_changed(unsigned int addr, const uint32_t *data,
+                                       unsigned int count, unsigned int *changed);
+/* Read-modify-write, using the shadow value if there is one: */
+void            regcache_modify(unsigned int addr, uint32_t clear, uint32_t set);
+void            regcache_invalidate_vidc(void);
+void            regcache_invalidate(void);
+void            regcache_get_stats(regcache_bank_t bank, regcache_stats_t *stats);
+void            regcache_clear_stats(void);
+
+#endif
@@ -0,0 +1,120 @@
+/* Sample rate conversion
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "resample.h"
+
+/* Control loop gains for resample_trim(); with a level error e frames,
+ * the trim is e*KP plus the accumulated error >> KI_SHIFT, in ppm.
+ */
+#define TRIM_KP_PPM             4
+#define TRIM_KI_SHIFT           6
+#define TRIM_INTEGRAL_MAX       (RESAMPLE_TRIM_MAX_PPM << TRIM_KI_SHIFT)
+
+void            resample_init(resample_t *rs)
+{
+        rs->step_nominal = RESAMPLE_ONE;
+        rs->step = RESAMPLE_ONE;
+        rs->phase = 0;
+        rs->prev = 0;
+        rs->integral = 0;
+        rs->trim_ppm = 0;
+}
+
+void            resample_set_rate(resample_t *rs, uint32_t in_num, uint32_t in_den,
+                                  uint32_t out_hz)
+{
+        rs->step_nominal = (uint32_t)((((uint64_t)in_num) << 16) /
+                                      ((uint64_t)in_den * out_hz));
+        if (rs->step_nominal == 0)
+                rs->step_nominal = 1;
+        rs->step = rs->step_nominal;
+        rs->integral = 0;
+        rs->trim_ppm = 0;
+}
+
+/* Interpolate each 16-bit half between a and b, by phase (Q16) */
+static inline uint32_t  lerp(uint32_t a, uint32_t b, uint32_t phase)
+{
+        int32_t f = phase >> 1;         /* Q15, so the product fits */
+        int32_t al = (int16_t)a, ar = (int16_t)(a >> 16);
+        int32_t bl = (int16_t)b, br = (int16_t)(b >> 16);
+        int32_t l = al + (((bl - al) * f) >> 15);
+        int32_t r = ar + (((br - ar) * f) >> 15);
+
+        return ((uint32_t)(uint16_t)r << 16) | (uint16_t)l;
+}
+
+unsigned int    resample_run(resample_t *rs, const uint32_t *in, unsigned int *nin,
+                             uint32_t *out, unsigned int max_out)
+{
+        unsigned int i = 0, n = 0;
+        uint32_t phase = rs->phase;
+        uint32_t prev = rs->prev;
+
+        while (i < *nin) {
+                uint32_t cur = in[i];
+
+                /* Output frames that fall between prev and cur: */
+                while (phase < RESAMPLE_ONE) {
+                        if (n == max_out)
+                                goto done;
+                        out[n++] = lerp(prev, cur, phase);
+                        phase += rs->step;
+                }
+                phase -= RESAMPLE_ONE;
+                prev = cur;
+                i++;
+        }
+done:
+        rs->phase = phase;
+        rs->prev = prev;
+        *nin = i;
+        return n;
+}
+
+/* PI control:  a fuller buffer than target means the output is being
+ * consumed more slowly than it's made, so step up (fewer output frames).
+ */
+void            resample_trim(resample_t *rs, unsigned int level, unsigned int target)
+{
+        int32_t err = (int32_t)level - (int32_t)target;
+        int32_t ppm;
+
+        rs->integral += err;
+        if (rs->integral > TRIM_INTEGRAL_MAX)
+                rs->integral = TRIM_INTEGRAL_MAX;
+        else if (rs->integral < -TRIM_INTEGRAL_MAX)
+                rs->integral = -TRIM_INTEGRAL_MAX;
+
+        ppm = err * TRIM_KP_PPM + (rs->integral >> TRIM_KI_SHIFT);
+        if (ppm > RESAMPLE_TRIM_MAX_PPM)
+                ppm = RESAMPLE_TRIM_MAX_PPM;
+        else if (ppm < -RESAMPLE_TRIM_MAX_PPM)
+                ppm = -RESAMPLE_TRIM_MAX_PPM;
+
+        rs->trim_ppm = ppm;
+        rs->step = rs->step_nominal +
+                (int32_t)(((int64_t)rs->step_nominal * ppm) / 1000000);
+}
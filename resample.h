@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include <stdint.h>
+
+/* Linear-interpolating sample rate converter for 16-bit stereo frames
+ * (R<<16 | L), in Q16.16 fixed point.  Work per output frame is constant.
+ *
+ * The step can be trimmed by a few thousand ppm to track a buffer level,
+ * absorbing the drift between the input and output clocks.
+ */
+
+#define RESAMPLE_ONE            (1 << 16)
+#define RESAMPLE_TRIM_MAX_PPM   5000
+
+typedef struct {
+        uint32_t        step_nominal;   /* Input frames per output frame, Q16.16 */
+        uint32_t        step;           /* ...trimmed */
+        uint32_t        phase;          /* Position after prev, Q16.16 */
+        uint32_t        prev;           /* Last input frame */
+        int32_t         integral;       /* Level error accumulator */
+        int32_t         trim_ppm;
+} resample_t;
+
+void            resample_init(resample_t *rs);
+/* Input rate as a fraction (e.g. 1000000/period) */
+void            resample_set_rate(resample_t *rs, uint32_t in_num, uint32_t in_den,
+                                  uint32_t out_hz);
+/* Convert up to nin input frames into at most max_out output frames.
+ * Returns the number of output frames; *nin is updated to the number of
+ * input frames consumed.
+ */
+unsigned int    resample_run(resample_t *rs, const uint32_t *in, unsigned int *nin,
+                             uint32_t *out, unsigned int max_out);
+/* Adjust the step from the output buffer level (frames), aiming for target */
+void            resample_trim(resample_t *rs, unsigned int level, unsigned int target);
+
+#endif
@@ -0,0 +1,525 @@
+/* adv7513_test: the ADV7513 driver's register shadow, on a simulated part (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Builds in the driver itself, for its shadow and statistics: */
+#include "dvo_adv7513.c"
+#include "vid_i2c_xfer.h"
+#include "events.h"
+
+/* The simulated ADV7513 sits behind the I2C queue (vid_i2c_xfer.c), as a
+ * bus backend completing each transaction at once.  It has:
+ *
+ * - The main map, auto-incrementing for reads and writes, with
+ *   read-only status registers and INT0 write-1-to-clear.
+ * - Power-down:  the part powers up (VIDR_POWER's PDOWN cleared) only
+ *   with HPD high, and until then only VIDR_POWER, VIDR_HPD_CONTROL and
+ *   VIDR_INT0 take writes.  HPD going low resets the registers the driver
+ *   replays on replug (dvo_output_regs[] and the audio setup), powering
+ *   down again, and raises VIDR_INT0_HPD.
+ * - EDID:  toggling VIDR_EDID_CTRL_REREAD fetches an EDID into the map at
+ *   VIDR_EDID_ADDR, and raises VIDR_INT0_EDID_READY (as DDC takes a
+ *   while, only when sim_ddc_ready() is called, for background fetches).
+ *
+ * Every register write is counted, so the checks can say what the shadow
+ * saved, as well as what the part ends up holding.
+ */
+
+#define SIM_CHIP_REV    0x13
+
+static uint8_t          sim_regs[256];
+static uint8_t          sim_edid[256];
+static uint8_t          sim_ptr;
+static bool             sim_hpd;
+static unsigned int     sim_writes[256];
+static unsigned int     sim_transactions;
+static unsigned int     sim_reads;              /* Read transactions */
+static unsigned int     sim_max_wlen;
+static unsigned int     sim_lost;               /* Writes ignored, powered down */
+static unsigned int     sim_nak_writes;         /* NAK this many writes */
+static int              sim_nak_reads = -1;     /* NAK reads of this register */
+static unsigned int     sim_baud;
+static bool             sim_ddc_defer;          /* Hold EDID_READY back */
+static bool             sim_ddc_busy;
+
+static unsigned int     checked, failed;
+
+#define CHECK(cond, what)                                               \
+        do {                                                            \
+                checked++;                                              \
+                if (!(cond)) {                                          \
+                        printf("FAIL: %s: %s\n", what, #cond);          \
+                        failed++;                                       \
+                }                                                       \
+        } while (0)
+
+static uint8_t          sim_power_on[256];
+
+/* Power-on values of the registers the driver reads back or preserves */
+static void     sim_reset_map(void)
+{
+        memset(sim_power_on, 0, sizeof(sim_power_on));
+        sim_power_on[VIDR_CHIP_REV] = SIM_CHIP_REV;
+        sim_power_on[VIDR_POWER] = VIDR_POWER_PDOWN | VIDR_POWER_RESVD;
+        sim_power_on[VIDR_I2S_CFG] = 0xbc;
+        sim_power_on[VIDR_I2S_FREQ] = 0x05;     /* Low bits must survive */
+        sim_power_on[VIDR_HDCP_HDMI] = 0x04;    /* ...and these */
+        memcpy(sim_regs, sim_power_on, sizeof(sim_regs));
+        sim_regs[VIDR_STATUS0] = sim_hpd ? VIDR_STATUS0_HPD : 0;
+}
+
+/* What HPD low resets */
+static void     sim_reset_hpd(void)
+{
+        static const uint8_t audio_regs[] = {
+                VIDR_N0, VIDR_N1, VIDR_N2, VIDR_AUDIO_SRC, VIDR_I2S_CFG,
+                VIDR_I2S_WORDLEN, VIDR_I2S_FREQ, VIDR_HDCP_HDMI,
+        };
+
+        for (unsigned int i = 0; i < sizeof(dvo_output_regs)/sizeof(dvo_output_regs[0]); i++)
+                sim_regs[dvo_output_regs[i].reg] = sim_power_on[dvo_output_regs[i].reg];
+        for (unsigned int i = 0; i < sizeof(audio_regs); i++)
+                sim_regs[audio_regs[i]] = sim_power_on[audio_regs[i]];
+}
+
+static bool     sim_powered(void)
+{
+        return !(sim_regs[VIDR_POWER] & VIDR_POWER_PDOWN);
+}
+
+static void     sim_write(uint8_t reg, uint8_t val)
+{
+        sim_writes[reg]++;
+        switch (reg) {
+        case VIDR_CHIP_REV:
+        case VIDR_STATUS0:
+                break;
+        case VIDR_INT0:
+                sim_regs[reg] &= ~val;
+                break;
+        case VIDR_POWER:
+                sim_regs[reg] = val;
+                if (!sim_hpd)
+                        sim_regs[reg] |= VIDR_POWER_PDOWN;
+                break;
+        case VIDR_HPD_CONTROL:
+                sim_regs[reg] = val;
+                break;
+        case VIDR_EDID_CTRL:
+                if (!sim_powered()) {
+                        sim_lost++;
+                        break;
+                }
+                if ((val & VIDR_EDID_CTRL_REREAD) && !(sim_regs[reg] & VIDR_EDID_CTRL_REREAD) &&
+                    sim_regs[VIDR_EDID_ADDR] == (VID_ADDR_EDID << 1)) {
+                        if (sim_ddc_defer)
+                                sim_ddc_busy = true;
+                        else
+                                sim_regs[VIDR_INT0] |= VIDR_INT0_EDID_READY;
+                }
+                sim_regs[reg] = val;
+                break;
+        default:
+                if (!sim_powered())
+                        sim_lost++;
+                else
+                        sim_regs[reg] = val;
+                break;
+        }
+}
+
+static int      sim_run(uint8_t addr, const uint8_t *wr, unsigned int wlen,
+                        uint8_t *rd, unsigned int rlen)
+{
+        uint8_t *map = addr == VID_ADDR_MAIN ? sim_regs : sim_edid;
+
+        sim_transactions++;
+        if (addr != VID_ADDR_MAIN && addr != VID_ADDR_EDID)
+                return -1;
+        if (wlen && sim_nak_writes) {
+                sim_nak_writes--;
+                return -1;
+        }
+        if (rlen && wlen == 1 && map == sim_regs && wr[0] == sim_nak_reads)
+                return -1;
+        if (wlen > sim_max_wlen)
+                sim_max_wlen = wlen;
+        for (unsigned int i = 0; i < wlen; i++) {
+                if (i == 0)
+                        sim_ptr = wr[0];
+                else if (map == sim_regs)
+                        sim_write(sim_ptr++, wr[i]);
+                else
+                        sim_ptr++;              /* EDID's read-only */
+        }
+        if (rlen)
+                sim_reads++;
+        for (unsigned int i = 0; i < rlen; i++)
+                rd[i] = map[sim_ptr++];
+        return wlen + rlen;
+}
+
+static void     sim_start(uint8_t addr, const uint8_t *wr, unsigned int wlen,
+                          uint8_t *rd, unsigned int rlen)
+{
+        vid_i2c_xfer_complete(sim_run(addr, wr, wlen, rd, rlen));
+}
+
+static const vid_i2c_backend_t sim_bus = {
+        .start = sim_start,
+};
+
+static void     sim_set_hpd(bool hpd)
+{
+        sim_hpd = hpd;
+        if (!hpd) {
+                sim_reset_hpd();
+                sim_regs[VIDR_STATUS0] &= ~VIDR_STATUS0_HPD;
+        } else {
+                sim_regs[VIDR_STATUS0] |= VIDR_STATUS0_HPD;
+        }
+        sim_regs[VIDR_INT0] |= VIDR_INT0_HPD;
+}
+
+/* The DDC read's done */
+static void     sim_ddc_ready(void)
+{
+        if (sim_ddc_busy)
+                sim_regs[VIDR_INT0] |= VIDR_INT0_EDID_READY;
+        sim_ddc_busy = false;
+}
+
+static void     sim_clear_counts(void)
+{
+        memset(sim_writes, 0, sizeof(sim_writes));
+        sim_transactions = 0;
+        sim_reads = 0;
+        sim_max_wlen = 0;
+        sim_lost = 0;
+}
+
+static unsigned int     sim_total_writes(void)
+{
+        unsigned int n = 0;
+
+        for (unsigned int i = 0; i < 256; i++)
+                n += sim_writes[i];
+        return n;
+}
+
+/* The queue's other halves, which the driver doesn't need here: */
+void            event_post(uint32_t events)
+{
+}
+
+void            vid_i2c_set_baud(unsigned int baud)
+{
+        vid_i2c_fence();
+        sim_baud = baud;
+}
+
+/* What the part should hold, for the output to work */
+static bool     output_regs_ok(void)
+{
+        for (unsigned int i = 0; i < sizeof(dvo_output_regs)/sizeof(dvo_output_regs[0]); i++) {
+                if (sim_regs[dvo_output_regs[i].reg] != dvo_output_regs[i].val) {
+                        printf("  reg %02x: %02x, not %02x\n", dvo_output_regs[i].reg,
+                               sim_regs[dvo_output_regs[i].reg], dvo_output_regs[i].val);
+                        return false;
+                }
+        }
+        return sim_powered() && (sim_regs[VIDR_HPD_CONTROL] & VIDR_HPD_CONTROL_HPD);
+}
+
+static bool     audio_regs_ok(unsigned int n, uint8_t freq, bool muted)
+{
+        return sim_regs[VIDR_N0] == ((n >> 16) & 0x0f) &&
+                sim_regs[VIDR_N1] == ((n >> 8) & 0xff) &&
+                sim_regs[VIDR_N2] == (n & 0xff) &&
+                sim_regs[VIDR_I2S_FREQ] == (freq | 0x05) &&
+                sim_regs[VIDR_HDCP_HDMI] == (0x04 | VIDR_HDCP_HDMI_HDMI) &&
+                sim_regs[VIDR_I2S_WORDLEN] == VIDR_I2S_WORDLEN_16 &&
+                sim_regs[VIDR_I2S_CFG] == (muted ? VIDR_I2S_CFG_STD :
+                                           (VIDR_I2S_CFG_EN0 | VIDR_I2S_CFG_STD));
+}
+
+static void     test_init(void)
+{
+        sim_hpd = true;
+        sim_reset_map();
+        sim_clear_counts();
+        CHECK(dvo_adv7513_ops.probe(), "probe");
+        CHECK(dvo_adv7513_ops.init() == 0, "init");
+        vid_i2c_fence();
+        CHECK(sim_baud == VID_I2C_HZ, "init: baud");
+        CHECK(output_regs_ok(), "init");
+        CHECK(sim_lost == 0, "init: writes whilst powered down");
+        /* The probe, one burst to load the shadow, and the rev from it */
+        CHECK(sim_reads == 2, "init: shadow loaded in one burst");
+        CHECK(sim_max_wlen <= 1 + DVO_BURST_MAX, "init: burst length");
+
+        /* Again, with the part already set up:  nothing's rewritten */
+        sim_clear_counts();
+        dvo_adv7513_ops.init();
+        vid_i2c_fence();
+        CHECK(sim_total_writes() == 1 && sim_writes[VIDR_INT0] == 1, "re-init skips");
+}
+
+static void     test_audio(void)
+{
+        sim_clear_counts();
+        CHECK(dvo_adv7513_ops.set_audio(48000) == 0, "48k");
+        vid_i2c_fence();
+        CHECK(audio_regs_ok(6144, VIDR_I2S_FREQ_48K, false), "48k");
+        /* 6144 is 0x001800:  N0 and N2 are as they were at power-on */
+        CHECK(sim_writes[VIDR_N0] == 0 && sim_writes[VIDR_N1] == 1 &&
+              sim_writes[VIDR_N2] == 0, "48k: changes only");
+
+        sim_clear_counts();
+        dvo_adv7513_ops.set_audio(48000);
+        vid_i2c_fence();
+        CHECK(sim_total_writes() == 0 && sim_transactions == 0, "48k again: nothing");
+
+        sim_clear_counts();
+        dvo_adv7513_ops.set_audio(44100);
+        vid_i2c_fence();
+        CHECK(audio_regs_ok(6272, VIDR_I2S_FREQ_44K1, false), "44.1k");
+        /* 6144 to 6272 (0x001880) changes N2 only, and the rate */
+        CHECK(sim_total_writes() == 2 && sim_writes[VIDR_N2] == 1 &&
+              sim_writes[VIDR_I2S_FREQ] == 1, "44.1k: changes only");
+
+        CHECK(dvo_adv7513_ops.set_audio(22050) == -1, "bad rate");
+
+        sim_clear_counts();
+        dvo_adv7513_ops.mute(true);
+        dvo_adv7513_ops.mute(true);
+        vid_i2c_fence();
+        CHECK(audio_regs_ok(6272, VIDR_I2S_FREQ_44K1, true), "mute");
+        CHECK(sim_total_writes() == 1 && sim_writes[VIDR_I2S_CFG] == 1, "mute once");
+}
+
+/* Unplug resets the part; replug must restore the output, and the audio
+ * as it was (muted).
+ */
+static void     test_replug(void)
+{
+        sim_set_hpd(false);
+        CHECK(dvo_adv7513_ops.service_irq() == DVO_HPD_UNPLUG, "unplug");
+        CHECK(dvo_adv7513_ops.service_irq() == DVO_HPD_NONE, "unplug acked");
+
+        sim_clear_counts();
+        sim_set_hpd(true);
+        CHECK(dvo_adv7513_ops.service_irq() == DVO_HPD_PLUG, "replug");
+        vid_i2c_fence();
+        CHECK(output_regs_ok(), "replug");
+        CHECK(audio_regs_ok(6272, VIDR_I2S_FREQ_44K1, true), "replug audio");
+        CHECK(sim_lost == 0, "replug: writes whilst powered down");
+
+        /* A missed unplug:  the plug alone still restores everything */
+        sim_reset_hpd();
+        sim_set_hpd(true);
+        sim_clear_counts();
+        CHECK(dvo_adv7513_ops.service_irq() == DVO_HPD_PLUG, "missed unplug");
+        vid_i2c_fence();
+        CHECK(output_regs_ok() && audio_regs_ok(6272, VIDR_I2S_FREQ_44K1, true),
+              "missed unplug");
+        CHECK(sim_lost == 0, "missed unplug: writes whilst powered down");
+}
+
+/* A flushed burst that fails leaves its registers unknown, so they're
+ * written again rather than skipped.
+ */
+static void     test_failed_burst(void)
+{
+        dvo_adv7513_ops.mute(false);
+        vid_i2c_fence();
+        sim_clear_counts();
+        sim_nak_writes = 1;
+        dvo_adv7513_ops.mute(true);
+        vid_i2c_fence();
+        CHECK(sim_total_writes() == 0 && dvo_shadow_stats.failed == 1, "NAKed");
+
+        dvo_adv7513_ops.mute(true);
+        vid_i2c_fence();
+        CHECK(sim_writes[VIDR_I2S_CFG] == 1 &&
+              audio_regs_ok(6272, VIDR_I2S_FREQ_44K1, true), "rewritten");
+}
+
+static void     test_edid(void)
+{
+        uint8_t buf[256];
+
+        for (unsigned int i = 0; i < sizeof(sim_edid); i++)
+                sim_edid[i] = i * 7 + 3;
+        memset(buf, 0, sizeof(buf));
+        CHECK(dvo_adv7513_ops.edid_read(buf, sizeof(buf)) == 0, "EDID");
+        CHECK(memcmp(buf, sim_edid, sizeof(buf)) == 0, "EDID");
+        CHECK(sim_regs[VIDR_EDID_ADDR] == (VID_ADDR_EDID << 1), "EDID address");
+
+        /* A failed read of the control or interrupt register fails the
+         * fetch, rather than writing back or reading garbage:
+         */
+        sim_clear_counts();
+        sim_nak_reads = VIDR_EDID_CTRL;
+        CHECK(dvo_adv7513_ops.edid_read(buf, sizeof(buf)) == -1, "EDID: control NAK");
+        CHECK(sim_writes[VIDR_EDID_CTRL] == 0, "EDID: control NAK");
+        sim_clear_counts();
+        sim_nak_reads = VIDR_INT0;
+        memset(buf, 0, sizeof(buf));
+        CHECK(dvo_adv7513_ops.edid_read(buf, sizeof(buf)) == -1, "EDID: INT0 NAK");
+        CHECK(buf[0] == 0, "EDID: INT0 NAK");
+        sim_nak_reads = -1;
+}
+
+static unsigned int     fetch_calls;
+static int              fetch_result;
+
+static void     fetch_done(int result)
+{
+        fetch_calls++;
+        fetch_result = result;
+}
+
+/* In the background, each step runs from a callback (in the main loop,
+ * from vid_i2c_poll()) or the IRQ service, and nothing waits for DDC.
+ */
+static void     test_edid_fetch(void)
+{
+        uint8_t buf[256];
+
+        for (unsigned int i = 0; i < sizeof(sim_edid); i++)
+                sim_edid[i] = i * 5 + 1;
+        memset(buf, 0, sizeof(buf));
+        sim_ddc_defer = true;
+        sim_clear_counts();
+        fetch_calls = 0;
+        CHECK(dvo_adv7513_ops.edid_fetch(buf, sizeof(buf), fetch_done) == 0, "fetch");
+        vid_i2c_poll();
+        CHECK(sim_ddc_busy && sim_reads == 1, "fetch: control read, re-read asked for");
+        CHECK(fetch_calls == 0, "fetch: not done yet");
+        /* An IRQ for something else meanwhile */
+        CHECK(dvo_adv7513_ops.service_irq() == DVO_HPD_NONE, "fetch: other IRQ");
+        vid_i2c_poll();
+        CHECK(fetch_calls == 0 && buf[0] == 0, "fetch: still waiting");
+        sim_ddc_ready();
+        CHECK(dvo_adv7513_ops.service_irq() == DVO_HPD_NONE, "fetch: ready IRQ");
+        vid_i2c_poll();
+        CHECK(fetch_calls == 1 && fetch_result == 0, "fetch: done");
+        CHECK(memcmp(buf, sim_edid, sizeof(buf)) == 0, "fetch: EDID");
+        CHECK(!(sim_regs[VIDR_INT0] & VIDR_INT0_EDID_READY), "fetch: IRQ acked");
+        CHECK(sim_regs[VIDR_INT_EN0] & VIDR_INT0_EDID_READY, "fetch: IRQ enabled");
+
+        /* An IRQ before the request's queued sees INT0 from before it, so
+         * doesn't take a stale EDID_READY as the fetch's:
+         */
+        sim_regs[VIDR_INT0] |= VIDR_INT0_EDID_READY;
+        fetch_calls = 0;
+        dvo_adv7513_ops.edid_fetch(buf, sizeof(buf), fetch_done);
+        dvo_adv7513_ops.service_irq();
+        vid_i2c_poll();
+        CHECK(fetch_calls == 0, "fetch: stale ready ignored");
+        sim_ddc_ready();
+        dvo_adv7513_ops.service_irq();
+        vid_i2c_poll();
+        CHECK(fetch_calls == 1 && fetch_result == 0, "fetch: done after stale");
+
+        /* A new fetch replaces one in progress:  reported once */
+        fetch_calls = 0;
+        dvo_adv7513_ops.edid_fetch(buf, sizeof(buf), fetch_done);
+        vid_i2c_poll();
+        dvo_adv7513_ops.edid_fetch(buf, sizeof(buf), fetch_done);
+        vid_i2c_poll();
+        sim_ddc_ready();
+        dvo_adv7513_ops.service_irq();
+        vid_i2c_poll();
+        CHECK(fetch_calls == 1 && fetch_result == 0, "fetch: replaced");
+        /* ...even once the old one's read-out is queued */
+        fetch_calls = 0;
+        dvo_adv7513_ops.edid_fetch(buf, sizeof(buf), fetch_done);
+        vid_i2c_poll();
+        sim_ddc_ready();
+        dvo_adv7513_ops.service_irq();
+        dvo_adv7513_ops.edid_fetch(buf, sizeof(buf), fetch_done);
+        vid_i2c_poll();
+        CHECK(fetch_calls == 0 && sim_ddc_busy, "fetch: replaced after ready");
+        sim_ddc_ready();
+        dvo_adv7513_ops.service_irq();
+        vid_i2c_poll();
+        CHECK(fetch_calls == 1 && fetch_result == 0, "fetch: replaced after ready");
+
+        /* A failed control read fails it */
+        fetch_calls = 0;
+        sim_nak_reads = VIDR_EDID_CTRL;
+        dvo_adv7513_ops.edid_fetch(buf, sizeof(buf), fetch_done);
+        vid_i2c_poll();
+        sim_nak_reads = -1;
+        CHECK(fetch_calls == 1 && fetch_result == -1 && !sim_ddc_busy, "fetch: control NAK");
+
+        /* No EDID_READY:  timed out */
+        fetch_calls = 0;
+        dvo_adv7513_ops.edid_fetch(buf, sizeof(buf), fetch_done);
+        vid_i2c_poll();
+        dvo_adv7513_ops.edid_poll();
+        CHECK(fetch_calls == 0, "fetch: not timed out yet");
+        sleep_ms(EDID_TIMEOUT_MS);
+        dvo_adv7513_ops.edid_poll();
+        CHECK(fetch_calls == 1 && fetch_result == -1, "fetch: timeout");
+        sim_ddc_ready();
+        dvo_adv7513_ops.service_irq();
+        vid_i2c_poll();
+        CHECK(fetch_calls == 1, "fetch: late ready ignored");
+
+        /* An unplug cancels it */
+        fetch_calls = 0;
+        dvo_adv7513_ops.edid_fetch(buf, sizeof(buf), fetch_done);
+        vid_i2c_poll();
+        sim_set_hpd(false);
+        CHECK(dvo_adv7513_ops.service_irq() == DVO_HPD_UNPLUG, "fetch: unplug");
+        vid_i2c_poll();
+        sleep_ms(EDID_TIMEOUT_MS);
+        dvo_adv7513_ops.edid_poll();
+        CHECK(fetch_calls == 0, "fetch: cancelled by unplug");
+        sim_set_hpd(true);
+        dvo_adv7513_ops.service_irq();
+        vid_i2c_fence();
+        sim_ddc_defer = false;
+        sim_ddc_busy = false;
+}
+
+int     main(void)
+{
+        vid_i2c_xfer_init(&sim_bus);
+        test_init();
+        test_audio();
+        test_replug();
+        test_failed_burst();
+        test_edid();
+        test_edid_fetch();
+        printf("%s: %d checked, %d failed\n", failed ? "FAIL" : "PASS", checked, failed);
+        return failed ? 1 : 0;
+}
@@ -0,0 +1,254 @@
+/* capture_test: capture bus record framing (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "capture.h"
+
+/* Sample streams are built here as the FPGA would send them (a VALID
+ * header, then the payload, each with STROBE), then replayed through
+ * cap_parse(), whole and split at every point; the records it calls back
+ * with are logged, for comparing with what was sent.
+ */
+
+static unsigned int     checked, failed;
+
+#define CHECK(cond, what)                                               \
+        do {                                                            \
+                checked++;                                              \
+                if (!(cond)) {                                          \
+                        printf("FAIL: %s: %s\n", what, #cond);          \
+                        failed++;                                       \
+                }                                                       \
+        } while (0)
+
+#define MAX_SAMPLES     1024
+#define MAX_RECORDS     128
+
+typedef struct {
+        unsigned int    type;
+        unsigned int    len;
+        uint8_t         payload[CAP_REC_MAX_LEN];
+} rec_t;
+
+typedef struct {
+        rec_t           rec[MAX_RECORDS];
+        unsigned int    n;
+} rec_log_t;
+
+static uint16_t         stream[MAX_SAMPLES];
+static unsigned int     stream_len;
+static rec_log_t        sent;
+
+static void     log_record(unsigned int type, const uint8_t *payload,
+                           unsigned int len, void *arg)
+{
+        rec_log_t *log = arg;
+
+        if (log->n < MAX_RECORDS) {
+                log->rec[log->n].type = type;
+                log->rec[log->n].len = len;
+                memcpy(log->rec[log->n].payload, payload, len);
+        }
+        log->n++;
+}
+
+static void     put(uint16_t s)
+{
+        if (stream_len < MAX_SAMPLES)
+                stream[stream_len++] = s | CAP_SAMPLE_STROBE;
+}
+
+/* Send a record; if cut, only the first cut bytes of its payload */
+static void     send(unsigned int type, const uint8_t *payload, unsigned int len,
+                     unsigned int cut)
+{
+        put(CAP_SAMPLE_VALID | (type << 4) | len);
+        for (unsigned int i = 0; i < len && i < cut; i++)
+                put(payload[i]);
+        if (cut >= len) {
+                sent.rec[sent.n].type = type;
+                sent.rec[sent.n].len = len;
+                memcpy(sent.rec[sent.n].payload, payload, len);
+                sent.n++;
+        }
+}
+
+static void     reset(void)
+{
+        stream_len = 0;
+        sent.n = 0;
+}
+
+static bool     same(const rec_log_t *a, const rec_log_t *b)
+{
+        if (a->n != b->n)
+                return false;
+        for (unsigned int i = 0; i < a->n && i < MAX_RECORDS; i++) {
+                if (a->rec[i].type != b->rec[i].type || a->rec[i].len != b->rec[i].len ||
+                    memcmp(a->rec[i].payload, b->rec[i].payload, a->rec[i].len) != 0)
+                        return false;
+        }
+        return true;
+}
+
+/* Every length, 0 to 15, of each type */
+static void     test_lengths(void)
+{
+        uint8_t payload[CAP_REC_MAX_LEN];
+        cap_parser_t p;
+        rec_log_t got = { .n = 0 };
+
+        reset();
+        for (unsigned int type = CAP_REC_SOUND; type <= CAP_REC_FRAME; type++) {
+                for (unsigned int len = 0; len <= CAP_REC_MAX_LEN; len++) {
+                        for (unsigned int i = 0; i < len; i++)
+                                payload[i] = (type << 6) ^ (len << 4) ^ (i * 37);
+                        send(type, payload, len, len);
+                }
+        }
+        cap_parser_init(&p);
+        cap_parse(&p, stream, stream_len, log_record, &got);
+        CHECK(same(&got, &sent), "lengths");
+        CHECK(p.records == 48 && p.resyncs == 0 && p.stray == 0, "lengths");
+        CHECK(!p.in_record, "lengths");
+}
+
+/* Payload bytes with VALID's bit pattern in the data are still payload */
+static void     test_payload_values(void)
+{
+        uint8_t payload[CAP_REC_MAX_LEN];
+        cap_parser_t p;
+        rec_log_t got = { .n = 0 };
+
+        reset();
+        for (unsigned int b = 0; b < 256; b += CAP_REC_MAX_LEN) {
+                for (unsigned int i = 0; i < CAP_REC_MAX_LEN; i++)
+                        payload[i] = b + i;
+                send(CAP_REC_SOUND, payload, CAP_REC_MAX_LEN, CAP_REC_MAX_LEN);
+        }
+        cap_parser_init(&p);
+        cap_parse(&p, stream, stream_len, log_record, &got);
+        CHECK(same(&got, &sent), "payload values");
+}
+
+/* Lost bytes:  a record cut short by the next header is dropped (and
+ * counted), and bytes before the first header are stray; the records
+ * around them still come through.
+ */
+static void     test_resync(void)
+{
+        static const uint8_t wr[6] = { 0x40, 0x00, 0x12, 0x34, 0x01, 0x07 };
+        static const uint8_t snd[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+        cap_parser_t p;
+        rec_log_t got = { .n = 0 };
+
+        reset();
+        put(0x12);                                      /* Stray */
+        put(0x34);
+        send(CAP_REC_VIDC_WRITE, wr, 6, 6);
+        send(CAP_REC_SOUND, snd, 8, 3);                 /* Cut */
+        send(CAP_REC_FRAME, NULL, 0, 0);
+        send(CAP_REC_VIDC_WRITE, wr, 6, 0);             /* Header only */
+        send(CAP_REC_VIDC_WRITE, wr, 4, 4);
+        send(CAP_REC_SOUND, snd, 8, 8);
+        cap_parser_init(&p);
+        cap_parse(&p, stream, stream_len, log_record, &got);
+        CHECK(same(&got, &sent), "resync");
+        CHECK(got.n == 4, "resync");
+        CHECK(p.records == 4 && p.resyncs == 2 && p.stray == 2, "resync");
+
+        /* A record left open at the end is completed by the next feed */
+        static const uint16_t tail[] = {
+                CAP_SAMPLE_STROBE | 0x05, CAP_SAMPLE_STROBE | 0x06,
+                CAP_SAMPLE_STROBE | 0x07, CAP_SAMPLE_STROBE | 0x08,
+        };
+
+        stream_len = 0;
+        send(CAP_REC_SOUND, snd, 8, 4);
+        cap_parse(&p, stream, stream_len, log_record, &got);
+        CHECK(got.n == 4 && p.in_record, "open record");
+        cap_parse(&p, tail, 4, log_record, &got);
+        CHECK(got.n == 5 && !p.in_record && got.rec[4].len == 8 &&
+              memcmp(got.rec[4].payload, snd, 8) == 0, "open record");
+}
+
+/* The ring is drained in whatever pieces the DMA's got to:  splitting the
+ * stream anywhere, into two or many parts, gives the same records.
+ */
+static void     test_split(void)
+{
+        uint8_t payload[CAP_REC_MAX_LEN];
+        uint32_t lfsr = 0xace1;
+        cap_parser_t p;
+        static rec_log_t got;
+        unsigned int bad = 0;
+
+        reset();
+        for (unsigned int r = 0; r < 40; r++) {
+                lfsr = lfsr * 1103515245 + 12345;
+
+                unsigned int len = (lfsr >> 16) % (CAP_REC_MAX_LEN + 1);
+
+                for (unsigned int i = 0; i < len; i++)
+                        payload[i] = lfsr >> (i & 7);
+                send(1 + (lfsr >> 24) % 3, payload, len, len);
+        }
+
+        for (unsigned int at = 0; at <= stream_len; at++) {
+                got.n = 0;
+                cap_parser_init(&p);
+                cap_parse(&p, stream, at, log_record, &got);
+                cap_parse(&p, stream + at, stream_len - at, log_record, &got);
+                if (!same(&got, &sent))
+                        bad++;
+        }
+        CHECK(bad == 0, "split in two");
+
+        for (unsigned int step = 1; step <= 7; step++) {
+                got.n = 0;
+                cap_parser_init(&p);
+                for (unsigned int at = 0; at < stream_len; at += step) {
+                        unsigned int n = stream_len - at < step ? stream_len - at : step;
+
+                        cap_parse(&p, stream + at, n, log_record, &got);
+                }
+                if (!same(&got, &sent))
+                        bad++;
+        }
+        CHECK(bad == 0, "split in pieces");
+}
+
+int     main(void)
+{
+        test_lengths();
+        test_payload_values();
+        test_resync();
+        test_split();
+        printf("%s: %d checked, %d failed\n", failed ? "FAIL" : "PASS", checked, failed);
+        return failed ? 1 : 0;
+}
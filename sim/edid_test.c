@@ -0,0 +1,212 @@
+/* edid_test: EDID parser checks (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "edid.h"
+
+/* EDID blobs are built up here from their fields, so each check says what
+ * it's feeding the parser:  a base block with a DTD, range limits and a
+ * name, a CEA extension with the HDMI VSDB and more DTDs, and broken
+ * variants of each.
+ */
+
+static unsigned int     checked, failed;
+
+#define CHECK(cond, what)                                               \
+        do {                                                            \
+                checked++;                                              \
+                if (!(cond)) {                                          \
+                        printf("FAIL: %s: %s\n", what, #cond);          \
+                        failed++;                                       \
+                }                                                       \
+        } while (0)
+
+static void     make_dtd(uint8_t *d, unsigned int pclk_khz,
+                         unsigned int hact, unsigned int hblank, unsigned int hfp,
+                         unsigned int hsync, unsigned int vact, unsigned int vblank,
+                         unsigned int vfp, unsigned int vsync, uint8_t flags)
+{
+        memset(d, 0, 18);
+        d[0] = (pclk_khz / 10) & 0xff;
+        d[1] = (pclk_khz / 10) >> 8;
+        d[2] = hact & 0xff;
+        d[3] = hblank & 0xff;
+        d[4] = ((hact >> 4) & 0xf0) | ((hblank >> 8) & 0x0f);
+        d[5] = vact & 0xff;
+        d[6] = vblank & 0xff;
+        d[7] = ((vact >> 4) & 0xf0) | ((vblank >> 8) & 0x0f);
+        d[8] = hfp & 0xff;
+        d[9] = hsync & 0xff;
+        d[10] = ((vfp & 0xf) << 4) | (vsync & 0xf);
+        d[11] = ((hfp >> 2) & 0xc0) | ((hsync >> 4) & 0x30) |
+                ((vfp >> 2) & 0x0c) | ((vsync >> 4) & 0x03);
+        d[17] = flags;
+}
+
+static void     make_checksum(uint8_t *b)
+{
+        uint8_t sum = 0;
+
+        for (unsigned int i = 0; i < EDID_BLOCK_LEN - 1; i++)
+                sum += b[i];
+        b[EDID_BLOCK_LEN - 1] = (uint8_t)(0x100 - sum);
+}
+
+/* Base block:  1920x1080@60 preferred, range limits, name; and an
+ * extension block, if ext.
+ */
+static void     make_base(uint8_t *e, bool ext)
+{
+        static const uint8_t header[8] = { 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00 };
+        static const char name[] = "ArcMon\n     ";
+
+        memset(e, 0, EDID_BLOCK_LEN);
+        memcpy(e, header, sizeof(header));
+        e[8] = 0x04; e[9] = 0x43;                       /* Manufacturer */
+        e[10] = 0x34; e[11] = 0x12;                     /* Product */
+        e[12] = 0x78; e[13] = 0x56; e[14] = 0x34; e[15] = 0x12;
+        e[18] = 1; e[19] = 3;
+        make_dtd(&e[54], 148500, 1920, 280, 88, 44, 1080, 45, 4, 5, 0x1e);
+        /* Range limits: 50-75Hz, 30-83kHz, 170MHz */
+        e[72 + 3] = 0xfd;
+        e[72 + 5] = 50; e[72 + 6] = 75; e[72 + 7] = 30; e[72 + 8] = 83; e[72 + 9] = 17;
+        e[90 + 3] = 0xfc;
+        memcpy(&e[90 + 5], name, 13);
+        e[108 + 3] = 0x10;                              /* Dummy */
+        e[126] = ext ? 1 : 0;
+        make_checksum(e);
+}
+
+/* CEA extension:  HDMI VSDB, then the given DTDs */
+static void     make_cea(uint8_t *b, const uint8_t *dtds, unsigned int n)
+{
+        memset(b, 0, EDID_BLOCK_LEN);
+        b[0] = 0x02;
+        b[1] = 0x03;
+        b[4] = (3 << 5) | 5;                            /* VSDB, 5 bytes */
+        b[5] = 0x03; b[6] = 0x0c; b[7] = 0x00; b[8] = 0x10; b[9] = 0x00;
+        b[2] = 10;
+        memcpy(&b[10], dtds, n * 18);
+        make_checksum(b);
+}
+
+static void     test_base(void)
+{
+        uint8_t e[EDID_LEN];
+        edid_info_t info;
+
+        make_base(e, false);
+        CHECK(edid_parse(e, EDID_BLOCK_LEN, &info) == 0, "base");
+        CHECK(info.valid, "base");
+        CHECK(!info.hdmi, "base");
+        CHECK(info.num_dtds == 1, "base");
+
+        const edid_dtd_t *t = &info.dtd[0];
+
+        CHECK(t->pclk_khz == 148500 && t->hactive == 1920 && t->vactive == 1080, "base DTD");
+        CHECK(t->hfp == 88 && t->hsync == 44 && t->hbp == 148, "base DTD");
+        CHECK(t->vfp == 4 && t->vsync == 5 && t->vbp == 36, "base DTD");
+        CHECK(t->flags == (EDID_DTD_HSYNC_POS | EDID_DTD_VSYNC_POS), "base DTD");
+        CHECK(info.has_range && info.vmin_hz == 50 && info.vmax_hz == 75 &&
+              info.hmin_khz == 30 && info.hmax_khz == 83 &&
+              info.max_pclk_khz == 170000, "range");
+        CHECK(strcmp(info.name, "ArcMon") == 0, "name");
+        CHECK(edid_info_find_dtd(&info, 1920, 1080) == t, "find");
+        CHECK(edid_info_find_dtd(&info, 1280, 1024) == NULL, "find");
+        CHECK(edid_same(e, EDID_BLOCK_LEN, &info), "same");
+
+        e[15] ^= 1;
+        make_checksum(e);
+        CHECK(!edid_same(e, EDID_BLOCK_LEN, &info), "different serial");
+
+        e[20] ^= 1;                                     /* Checksum now wrong */
+        CHECK(edid_parse(e, EDID_BLOCK_LEN, &info) == -1, "bad checksum");
+        CHECK(!info.valid, "bad checksum");
+
+        make_base(e, false);
+        e[0] = 0xfe;
+        make_checksum(e);
+        CHECK(edid_parse(e, EDID_BLOCK_LEN, &info) == -1, "bad header");
+}
+
+/* A DTD whose FP + sync exceed its blanking would give a negative (so
+ * wrapped) back porch; it's dropped, and the others still parse.
+ */
+static void     test_bad_dtd(void)
+{
+        uint8_t e[EDID_LEN];
+        uint8_t dtds[3 * 18];
+        edid_info_t info;
+
+        make_base(e, false);
+        make_dtd(&e[54], 65000, 1024, 100, 80, 40, 768, 38, 3, 6, 0x18);
+        make_checksum(e);
+        CHECK(edid_parse(e, EDID_BLOCK_LEN, &info) == 0, "bad H DTD");
+        CHECK(info.num_dtds == 0, "bad H DTD");
+        CHECK(info.has_range, "bad H DTD");
+
+        make_base(e, false);
+        make_dtd(&e[54], 65000, 1024, 320, 24, 136, 768, 8, 3, 6, 0x18);
+        make_checksum(e);
+        CHECK(edid_parse(e, EDID_BLOCK_LEN, &info) == 0, "bad V DTD");
+        CHECK(info.num_dtds == 0, "bad V DTD");
+
+        /* Exactly full blanking is fine (zero back porch) */
+        make_base(e, false);
+        make_dtd(&e[54], 65000, 1024, 160, 24, 136, 768, 9, 3, 6, 0x18);
+        make_checksum(e);
+        CHECK(edid_parse(e, EDID_BLOCK_LEN, &info) == 0, "full blanking");
+        CHECK(info.num_dtds == 1 && info.dtd[0].hbp == 0 && info.dtd[0].vbp == 0,
+              "full blanking");
+
+        /* In the extension too, between good ones */
+        make_base(e, true);
+        make_dtd(&dtds[0], 27000, 720, 144, 12, 64, 576, 49, 5, 5, 0x18);
+        make_dtd(&dtds[18], 25175, 640, 160, 150, 96, 480, 45, 10, 2, 0x18);
+        make_dtd(&dtds[36], 74250, 1280, 370, 110, 40, 720, 30, 5, 5, 0x1e);
+        make_cea(&e[EDID_BLOCK_LEN], dtds, 3);
+        CHECK(edid_parse(e, EDID_LEN, &info) == 0, "CEA");
+        CHECK(info.hdmi, "CEA");
+        CHECK(info.num_dtds == 3, "CEA");
+        CHECK(edid_info_find_dtd(&info, 720, 576) != NULL, "CEA");
+        CHECK(edid_info_find_dtd(&info, 640, 480) == NULL, "CEA bad DTD");
+        CHECK(edid_info_find_dtd(&info, 1280, 720) != NULL, "CEA");
+        CHECK(edid_same(e, EDID_LEN, &info), "CEA same");
+
+        /* A broken extension is ignored, but the base block's kept */
+        e[EDID_BLOCK_LEN + 20] ^= 1;
+        CHECK(edid_parse(e, EDID_LEN, &info) == 0, "bad CEA");
+        CHECK(!info.hdmi && info.num_dtds == 1, "bad CEA");
+}
+
+int     main(void)
+{
+        test_base();
+        test_bad_dtd();
+        printf("%s: %d checked, %d failed\n", failed ? "FAIL" : "PASS", checked, failed);
+        return failed ? 1 : 0;
+}
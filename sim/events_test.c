@@ -0,0 +1,426 @@
+/* events_test: event posting/taking with injected IRQs (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include "hw.h"
+#include "fpga.h"
+#include "dvo.h"
+#include "edid.h"
+#include "events.h"
+#include "video.h"
+#include "fpga_sim.h"
+#include "video_loop.h"
+
+/* The main loop's wait (event_wait()) calls the simulator's idle hook in
+ * the host build; here, that's where IRQs are injected instead.  Each
+ * wait moves time on to the next IRQ (or several, at the same time), and
+ * they post their events, as the GPIO/timer IRQs do on the device.
+ * video_loop_dispatch() takes them and runs its handlers, which are
+ * faked here:  they count their calls, and model just enough (the FPGA's
+ * reconfig status/ack bits, debouncing, HPD) to check the routing.
+ */
+
+#define NSRC            6
+#define RUN_US          2000000
+#define SETTLE_POLLS    3               /* Passes until a reconfig settles */
+
+enum { SRC_VIDC, SRC_POLL, SRC_DVO, SRC_CAPTURE, SRC_CLI, SRC_I2C };
+
+static const uint32_t   src_ev[NSRC] = {
+        EVT_VIDC_RECONFIG, EVT_VIDC_POLL, EVT_DVO_IRQ, EVT_CAPTURE, EVT_CLI_CMD, EVT_VID_I2C,
+};
+/* Mean interval (us); VIDC writes are rarer, as each is logged */
+static const unsigned int src_period[NSRC] = { 10000, 1000, 1000, 1000, 1000, 1000 };
+
+uint8_t flag_autoprobe_mode = 1;
+uint8_t flag_test_mode = 0;
+uint8_t flag_irq_mode = 1;
+
+static bool             inject;
+static uint64_t         now_us;
+static uint64_t         next_us[NSRC];
+static uint32_t         lfsr = 0xace1;
+
+static unsigned int     posted[NSRC];   /* Waits in which it was posted */
+static unsigned int     fired[NSRC];    /* Including coalesced */
+static unsigned int     handled[NSRC];
+static unsigned int     waits, busy_waits;
+
+/* The FPGA's VIDO_REG_SYNC reconfig bits:  status (3) flips when VIDC's
+ * written, and the firmware flips ack (2) to match
+ */
+static uint32_t         sync_reg;
+static unsigned int     vidc_batches;   /* Writes with status == ack before */
+static unsigned int     missed_edges;
+
+static bool             settling;
+static unsigned int     settle_polls, settle_starts, settle_events, settle_commits;
+static unsigned int     rewrites;       /* VIDC written again while settling */
+static unsigned int     idle_settle_polls;
+static unsigned int     saves, saves_settling;
+static unsigned int     plugs, plug_changes, probes;
+/* A background EDID fetch completes this many waits after it's started */
+static unsigned int     fetch_waits;
+static unsigned int     fetches, fetches_replaced, fetched;
+static unsigned int     reconfigs_fetching;     /* Handled meanwhile */
+
+static unsigned int     checked, failed;
+
+#define CHECK(cond, what)                                               \
+        do {                                                            \
+                checked++;                                              \
+                if (!(cond)) {                                          \
+                        printf("FAIL: %s: %s\n", what, #cond);          \
+                        failed++;                                       \
+                }                                                       \
+        } while (0)
+
+static unsigned int     rnd(unsigned int n)
+{
+        lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xb400);
+        return lfsr % n;
+}
+
+uint64_t        fpga_sim_time_us(void)
+{
+        return now_us;
+}
+
+/* Fakes for what video_loop.c calls */
+
+uint32_t        fpga_read32(unsigned int addr)
+{
+        return addr == FPGA_VO(VIDO_REG_SYNC) ? sync_reg : 0;
+}
+
+void            fpga_write32(unsigned int addr, uint32_t data)
+{
+        if (addr == FPGA_VO(VIDO_REG_SYNC))
+                sync_reg = (sync_reg & ~4) | (data & 4);
+}
+
+void    regcache_invalidate_vidc(void)
+{
+}
+
+void    cmd_service(void)
+{
+        handled[SRC_CLI]++;
+}
+
+void    capture_poll(void)
+{
+        handled[SRC_CAPTURE]++;
+}
+
+void    vid_i2c_poll(void)
+{
+        handled[SRC_I2C]++;
+}
+
+int     dvo_service_irq(uint32_t irq_time)
+{
+        handled[SRC_DVO]++;
+        switch (rnd(4)) {
+        case 0:
+                plugs++;
+                return DVO_HPD_PLUG;
+        case 1:
+                return DVO_HPD_UNPLUG;
+        default:
+                return DVO_HPD_NONE;
+        }
+}
+
+void    edid_fetch(void)
+{
+        fetches++;
+        if (fetch_waits)
+                fetches_replaced++;
+        fetch_waits = 1 + rnd(3);
+}
+
+bool    edid_fetched(void)
+{
+        bool changed = rnd(2);
+
+        fetched++;
+        plug_changes += changed;
+        return changed;
+}
+
+void    dvo_edid_poll(void)
+{
+}
+
+void    video_probe_mode(bool force)
+{
+        probes++;
+        event_post(EVT_MODE_SAVE);
+}
+
+void    video_save_mode(void)
+{
+        saves++;
+        if (settling)
+                saves_settling++;
+}
+
+bool    video_reconfig_pending(void)
+{
+        return settling;
+}
+
+static void     vidc_write(bool irq)
+{
+        if (((sync_reg >> 3) & 1) == ((sync_reg >> 2) & 1)) {
+                sync_reg ^= 8;
+                vidc_batches++;
+        }
+        if (irq)
+                event_post(EVT_VIDC_RECONFIG);
+        else
+                missed_edges++;
+}
+
+void    video_reconfig_event(void)
+{
+        settle_events++;
+        if (fetch_waits)
+                reconfigs_fetching++;
+        if (!settling)
+                settle_starts++;
+        settling = true;
+        settle_polls = 0;
+}
+
+void    video_reconfig_poll(void)
+{
+        if (!settling) {
+                idle_settle_polls++;
+                return;
+        }
+        /* RISC OS sometimes writes the timing over a few frames */
+        if (settle_polls == 0 && rnd(8) == 0) {
+                rewrites++;
+                vidc_write(true);
+        }
+        if (++settle_polls >= SETTLE_POLLS) {
+                settling = false;
+                settle_commits++;
+                event_post(EVT_MODE_SAVE);
+        }
+}
+
+/* Coarse times, so IRQs often coincide */
+static void     schedule(unsigned int i)
+{
+        next_us[i] = now_us + src_period[i] / 10 * (1 + rnd(20));
+}
+
+void    fpga_sim_idle(void)
+{
+        uint64_t next = ~0ull;
+
+        waits++;
+        /* The loop only waits with nothing to do */
+        if (event_pending()) {
+                busy_waits++;
+                return;
+        }
+        if (fetch_waits && --fetch_waits == 0)
+                event_post(EVT_EDID);
+        if (!inject)
+                return;
+        for (unsigned int i = 0; i < NSRC; i++) {
+                if (next_us[i] < next)
+                        next = next_us[i];
+        }
+        now_us = next;
+        for (unsigned int i = 0; i < NSRC; i++) {
+                if (next_us[i] != now_us)
+                        continue;
+                /* Sometimes twice, before the loop gets to it */
+                unsigned int n = 1 + (rnd(4) == 0);
+
+                for (unsigned int k = 0; k < n; k++) {
+                        if (i == SRC_VIDC)
+                                vidc_write(true);
+                        else
+                                event_post(src_ev[i]);
+                        fired[i]++;
+                }
+                /* Sometimes the FPGA IRQ's edge is missed, leaving it
+                 * to the fallback poll
+                 */
+                if (i == SRC_POLL && rnd(32) == 0)
+                        vidc_write(false);
+                posted[i]++;
+                schedule(i);
+        }
+}
+
+static void     test_loop(void)
+{
+        uint32_t all = 0;
+
+        for (unsigned int i = 0; i < NSRC; i++) {
+                all |= src_ev[i];
+                schedule(i);
+        }
+        /* Time only moves on in waits, so bound the passes too */
+        unsigned int passes = 0;
+
+        inject = true;
+        while (now_us < RUN_US && passes++ < 1000000)
+                video_loop_dispatch();
+        inject = false;
+        CHECK(now_us >= RUN_US, "loop waits");
+        /* Drain what's left (the fake idle doesn't inject any more) */
+        passes = 0;
+        while ((settling || fetch_waits || (event_pending() & (all | EVT_MODE_SAVE | EVT_EDID))) &&
+               passes++ < 100)
+                video_loop_dispatch();
+        CHECK(passes < 100, "drained");
+
+        char what[32];
+
+        for (unsigned int i = 0; i < NSRC; i++) {
+                snprintf(what, sizeof(what), "event %08x", src_ev[i]);
+                CHECK(posted[i] > 100, what);
+                CHECK(fired[i] > posted[i], what);      /* Some coalesced */
+        }
+        /* Each wait's posts are handled once, whatever else is going on */
+        CHECK(handled[SRC_DVO] == posted[SRC_DVO], "DVO");
+        CHECK(handled[SRC_CAPTURE] == posted[SRC_CAPTURE], "capture");
+        CHECK(handled[SRC_CLI] == posted[SRC_CLI], "console");
+        CHECK(handled[SRC_I2C] == posted[SRC_I2C], "I2C");
+        /* Every VIDC write is acked and debounced, missed edges included */
+        CHECK(missed_edges > 10, "missed edges");
+        CHECK(rewrites > 10, "writes while settling");
+        CHECK(settle_events == vidc_batches, "reconfig acked once per write");
+        CHECK(((sync_reg >> 3) & 1) == ((sync_reg >> 2) & 1), "all acked");
+        CHECK(settle_commits == settle_starts && !settling, "settled");
+        /* Those extend the settle rather than starting another */
+        CHECK(settle_events - settle_starts == rewrites, "rewrites restart settling");
+        CHECK(idle_settle_polls == 0, "settle polled only while settling");
+        /* A plug with a new monitor reprobes, forced */
+        CHECK(plugs > 50 && fetches == plugs, "plug fetches EDID");
+        CHECK(fetches_replaced > 0 && fetched == fetches - fetches_replaced, "EDID fetched");
+        CHECK(plug_changes < fetched && probes == plug_changes, "HPD probes");
+        /* ...and VIDC's still dealt with meanwhile */
+        CHECK(reconfigs_fetching > 0, "reconfig whilst fetching EDID");
+        /* Mode saves wait until VIDC's settled */
+        CHECK(saves > 0 && saves <= settle_commits + probes, "saves");
+        CHECK(saves_settling == 0, "no save while settling");
+        CHECK(busy_waits == 0, "no waiting with events pending");
+        printf("%d waits, %d VIDC writes (%d missed edges, %d while settling), "
+               "%d plugs; posted/fired/handled:", waits, vidc_batches, missed_edges,
+               rewrites, plugs);
+        for (unsigned int i = 0; i < NSRC; i++)
+                printf(" %d/%d/%d", posted[i], fired[i], handled[i]);
+        printf("\n");
+}
+
+/* Poll mode checks VIDC every pass, without waiting; test mode ignores it */
+static void     test_modes(void)
+{
+        unsigned int w = waits, e = settle_events;
+
+        event_take(~0u);
+        flag_irq_mode = 0;
+        vidc_write(false);
+        video_loop_dispatch();
+        CHECK(settle_events == e + 1 && settling, "poll mode: reconfig seen");
+        for (unsigned int i = 0; i < SETTLE_POLLS; i++)
+                video_loop_dispatch();
+        CHECK(!settling && waits == w, "poll mode: settled, no waits");
+        flag_irq_mode = 1;
+        event_take(~0u);
+
+        flag_test_mode = 1;
+        e = settle_events;
+        vidc_write(true);
+        event_post(EVT_VIDC_POLL);
+        video_loop_dispatch();
+        CHECK(settle_events == e && !event_pending() && waits == w + 1,
+              "test mode: reconfig ignored");
+        flag_test_mode = 0;
+        /* Seen once out of test mode */
+        event_post(EVT_VIDC_POLL);
+        video_loop_dispatch();
+        CHECK(settle_events == e + 1, "test mode: seen after");
+        for (unsigned int i = 0; settling && i < 100; i++)
+                video_loop_dispatch();
+        event_take(~0u);
+
+        /* A mode save waits until VIDC's settled */
+        unsigned int sv = saves;
+
+        vidc_write(true);
+        video_loop_dispatch();
+        event_post(EVT_MODE_SAVE);
+        video_loop_dispatch();
+        CHECK(settling && saves == sv, "save deferred while settling");
+        for (unsigned int i = 0; (settling || event_pending()) && i < 100; i++)
+                video_loop_dispatch();
+        CHECK(saves == sv + 1 && saves_settling == 0, "save once settled");
+}
+
+static void     test_mask(void)
+{
+        event_take(~0u);
+        event_post(EVT_CLI_CMD | EVT_VID_I2C);
+        event_post(EVT_MODE_SAVE);
+        CHECK(event_pending() == (EVT_CLI_CMD | EVT_VID_I2C | EVT_MODE_SAVE), "pending");
+        CHECK(event_take(EVT_VID_I2C | EVT_CAPTURE) == EVT_VID_I2C, "take masked");
+        CHECK(event_pending() == (EVT_CLI_CMD | EVT_MODE_SAVE), "others left");
+        CHECK(event_take(EVT_VID_I2C) == 0, "taken once");
+        CHECK(event_take(~0u) == (EVT_CLI_CMD | EVT_MODE_SAVE), "take all");
+        CHECK(event_pending() == 0, "empty");
+
+        /* A wait with something pending returns straight away */
+        event_post(EVT_CLI_CMD);
+        unsigned int w = busy_waits;
+        uint64_t t = now_us;
+
+        event_wait();
+        CHECK(busy_waits == w + 1 && now_us == t, "wait with pending");
+        event_take(~0u);
+}
+
+int     main(void)
+{
+        events_init();
+        test_loop();
+        test_modes();
+        test_mask();
+        printf("%s: %d checked, %d failed\n", failed ? "FAIL" : "PASS", checked, failed);
+        return failed ? 1 : 0;
+}
@@ -0,0 +1,449 @@
+/* i2s_test: the I2S PIO program's output, bit by bit (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+/* audio_i2s.pio is read and run here, on a model of one PIO state machine
+ * configured as audio_i2s_program_init() does:  OUT to the data pin,
+ * shifting left (MSB first) with autopull at 32 bits; two side-set bits,
+ * WS then BCLK.  (Only the instructions the program uses are modelled;
+ * anything else fails the test, rather than being run wrongly.)
+ *
+ * The pins are then decoded as an I2S receiver would, sampling data and
+ * WS on rising BCLK:  a channel's MSB is the bit after WS changes, WS low
+ * being left.  The frames fed in (R<<16 | L, as audio.h packs them) must
+ * come out the same, at 64 cycles per frame, with WS and data changing
+ * only whilst BCLK is low.
+ */
+
+#define MAX_INSTRS      32
+
+typedef enum { OP_OUT, OP_JMP, OP_SET } op_t;
+typedef enum { C_ALWAYS, C_NOT_X, C_X_DEC, C_NOT_Y, C_Y_DEC } cond_t;
+typedef enum { D_PINS, D_X, D_Y, D_NULL } dest_t;
+
+typedef struct {
+        op_t            op;
+        cond_t          cond;
+        dest_t          dest;
+        unsigned int    arg;            /* Bit count, value, or target */
+        char            target[32];
+        unsigned int    side;
+} instr_t;
+
+static instr_t          prog[MAX_INSTRS];
+static unsigned int     nprog;
+static unsigned int     side_bits;
+static unsigned int     entry;
+static struct { char name[32]; unsigned int pc; } labels[MAX_INSTRS];
+static unsigned int     nlabels;
+
+static unsigned int     checked, failed;
+
+#define CHECK(cond, what)                                               \
+        do {                                                            \
+                checked++;                                              \
+                if (!(cond)) {                                          \
+                        printf("FAIL: %s: %s\n", what, #cond);          \
+                        failed++;                                       \
+                }                                                       \
+        } while (0)
+
+static char     *trim(char *s)
+{
+        char *e;
+
+        while (isspace((unsigned char)*s))
+                s++;
+        e = s + strlen(s);
+        while (e > s && isspace((unsigned char)e[-1]))
+                *--e = '\0';
+        return s;
+}
+
+static bool     parse_instr(char *s, instr_t *in)
+{
+        char *side = strstr(s, " side ");
+        char a[32], b[32];
+
+        memset(in, 0, sizeof(*in));
+        if (!side)
+                return false;
+        *side = '\0';
+        in->side = strtoul(trim(side + 6), NULL, 0);
+        if (strncmp(trim(side + 6), "0b", 2) == 0)
+                in->side = strtoul(trim(side + 6) + 2, NULL, 2);
+        s = trim(s);
+
+        if (sscanf(s, "out %31[^,], %u", a, &in->arg) == 2) {
+                in->op = OP_OUT;
+                if (strcmp(a, "pins") == 0)
+                        in->dest = D_PINS;
+                else if (strcmp(a, "x") == 0)
+                        in->dest = D_X;
+                else if (strcmp(a, "y") == 0)
+                        in->dest = D_Y;
+                else if (strcmp(a, "null") == 0)
+                        in->dest = D_NULL;
+                else
+                        return false;
+                return in->arg >= 1 && in->arg <= 32;
+        }
+        if (sscanf(s, "set %31[^,], %u", a, &in->arg) == 2) {
+                in->op = OP_SET;
+                if (strcmp(a, "x") == 0)
+                        in->dest = D_X;
+                else if (strcmp(a, "y") == 0)
+                        in->dest = D_Y;
+                else
+                        return false;
+                return in->arg < 32;
+        }
+        int n = sscanf(s, "jmp %31s %31s", a, b);
+
+        in->op = OP_JMP;
+        if (n == 1) {
+                in->cond = C_ALWAYS;
+                strcpy(in->target, a);
+                return true;
+        }
+        if (n != 2)
+                return false;
+        strcpy(in->target, b);
+        if (strcmp(a, "!x") == 0)
+                in->cond = C_NOT_X;
+        else if (strcmp(a, "x--") == 0)
+                in->cond = C_X_DEC;
+        else if (strcmp(a, "!y") == 0)
+                in->cond = C_NOT_Y;
+        else if (strcmp(a, "y--") == 0)
+                in->cond = C_Y_DEC;
+        else
+                return false;
+        return true;
+}
+
+static bool     load(const char *path)
+{
+        FILE *f = fopen(path, "r");
+        char line[160];
+        char entry_name[32] = "";
+        bool in_c = false;
+
+        if (!f) {
+                perror(path);
+                return false;
+        }
+        while (fgets(line, sizeof(line), f)) {
+                char *s, *c = strchr(line, ';');
+
+                if (c)
+                        *c = '\0';
+                s = trim(line);
+                if (in_c) {
+                        in_c = strncmp(s, "%}", 2) != 0;
+                        continue;
+                }
+                if (*s == '\0' || strncmp(s, ".program", 8) == 0)
+                        continue;
+                if (*s == '%') {
+                        in_c = true;
+                        continue;
+                }
+                if (sscanf(s, ".side_set %u", &side_bits) == 1)
+                        continue;
+                if (*s == '.') {
+                        /* .wrap_target/.wrap aren't modelled */
+                        printf("FAIL: unsupported directive: %s\n", s);
+                        fclose(f);
+                        return false;
+                }
+
+                char *colon = strchr(s, ':');
+
+                if (colon) {
+                        bool pub = strncmp(s, "public ", 7) == 0;
+
+                        *colon = '\0';
+                        snprintf(labels[nlabels].name, sizeof(labels[0].name), "%s",
+                                 trim(pub ? s + 7 : s));
+                        labels[nlabels++].pc = nprog;
+                        if (pub)
+                                strcpy(entry_name, labels[nlabels - 1].name);
+                        continue;
+                }
+                if (nprog == MAX_INSTRS || !parse_instr(s, &prog[nprog])) {
+                        printf("FAIL: unsupported instruction: %s\n", s);
+                        fclose(f);
+                        return false;
+                }
+                nprog++;
+        }
+        fclose(f);
+
+        for (unsigned int i = 0; i < nprog; i++) {
+                if (prog[i].op != OP_JMP)
+                        continue;
+                unsigned int l;
+
+                for (l = 0; l < nlabels; l++) {
+                        if (strcmp(labels[l].name, prog[i].target) == 0)
+                                break;
+                }
+                if (l == nlabels) {
+                        printf("FAIL: no label %s\n", prog[i].target);
+                        return false;
+                }
+                prog[i].arg = labels[l].pc;
+        }
+        for (unsigned int l = 0; l < nlabels; l++) {
+                if (strcmp(labels[l].name, entry_name) == 0)
+                        entry = labels[l].pc;
+        }
+        return nprog > 0 && side_bits == 2 && entry_name[0];
+}
+
+/******************************************************************************/
+/* The state machine, and what's on its pins each cycle */
+
+typedef struct {
+        bool            data, ws, bclk;
+} pins_t;
+
+#define MAX_CYCLES      (64 * 64)
+
+static pins_t           trace[MAX_CYCLES];
+static unsigned int     ncycles;
+static unsigned int     stalls;
+
+static void     run(const uint32_t *fifo, unsigned int nfifo, unsigned int cycles)
+{
+        unsigned int pc = entry, x = 0, y = 0;
+        uint32_t osr = 0;
+        unsigned int osr_count = 32;    /* Empty */
+        unsigned int rd = 0;
+        pins_t p = { false, false, false };
+
+        ncycles = 0;
+        stalls = 0;
+        while (ncycles < cycles) {
+                const instr_t *in = &prog[pc];
+                unsigned int next = (pc + 1) % nprog;
+
+                /* Side-set applies even if the instruction stalls */
+                p.ws = in->side & 1;
+                p.bclk = (in->side >> 1) & 1;
+
+                switch (in->op) {
+                case OP_OUT:
+                        if (osr_count >= 32) {
+                                if (rd == nfifo) {
+                                        stalls++;
+                                        next = pc;
+                                        break;
+                                }
+                                osr = fifo[rd++];
+                                osr_count = 0;
+                        }
+                        uint32_t v = in->arg == 32 ? osr : osr >> (32 - in->arg);
+
+                        osr = in->arg == 32 ? 0 : osr << in->arg;
+                        osr_count += in->arg;
+                        if (in->dest == D_PINS)
+                                p.data = v & 1;
+                        else if (in->dest == D_X)
+                                x = v;
+                        else if (in->dest == D_Y)
+                                y = v;
+                        break;
+                case OP_SET:
+                        if (in->dest == D_X)
+                                x = in->arg;
+                        else
+                                y = in->arg;
+                        break;
+                case OP_JMP: {
+                        bool take = true;
+
+                        switch (in->cond) {
+                        case C_ALWAYS:  break;
+                        case C_NOT_X:   take = (x == 0); break;
+                        case C_X_DEC:   take = (x != 0); x--; break;
+                        case C_NOT_Y:   take = (y == 0); break;
+                        case C_Y_DEC:   take = (y != 0); y--; break;
+                        }
+                        if (take)
+                                next = in->arg;
+                        break;
+                }
+                }
+                trace[ncycles++] = p;
+                pc = next;
+        }
+}
+
+/* Receive:  returns the number of whole frames, into l[]/r[], skipping
+ * the (unframed) channel before WS first changes.
+ */
+static unsigned int     receive(int16_t *l, int16_t *r, unsigned int max)
+{
+        int ws = -1;
+        int chan = -1;          /* Being received:  0 left, 1 right */
+        unsigned int bits = 0, nl = 0, nr = 0;
+        uint16_t word = 0;
+
+        for (unsigned int i = 1; i < ncycles; i++) {
+                if (!trace[i].bclk || trace[i - 1].bclk)
+                        continue;       /* Not a rising edge */
+
+                if (chan >= 0 && bits < 16) {
+                        word = (word << 1) | trace[i].data;
+                        if (++bits == 16) {
+                                if (chan == 0 && nl < max)
+                                        l[nl++] = word;
+                                else if (chan == 1 && nr < max && nl > nr)
+                                        r[nr++] = word;
+                        }
+                }
+                if (ws >= 0 && trace[i].ws != ws) {
+                        /* That was the LSB; the next bit's the MSB */
+                        chan = trace[i].ws;
+                        bits = 0;
+                        word = 0;
+                }
+                ws = trace[i].ws;
+        }
+        return nr < nl ? nr : nl;
+}
+
+static void     test_frames(void)
+{
+        static const uint32_t patterns[] = {
+                0x80000001, 0x00017fff, 0xffff0000, 0x0000ffff,
+                0xaaaa5555, 0x5555aaaa, 0x12345678, 0xfedcba98,
+        };
+        uint32_t fifo[32];
+        int16_t l[32], r[32];
+        char what[48];
+        uint32_t lfsr = 0xace1;
+        unsigned int n = sizeof(fifo) / sizeof(fifo[0]);
+
+        for (unsigned int i = 0; i < n; i++) {
+                if (i < sizeof(patterns) / sizeof(patterns[0])) {
+                        fifo[i] = patterns[i];
+                } else {
+                        lfsr = lfsr * 1103515245 + 12345;
+                        fifo[i] = lfsr;
+                }
+        }
+        /* Exactly enough cycles for them all (plus the entry instruction) */
+        run(fifo, n, 1 + 64 * n);
+        CHECK(stalls == 0, "no stalls");
+
+        unsigned int got = receive(l, r, 32);
+
+        /* The first word's right channel goes out before any WS change, so
+         * it isn't framed; it's frame n's left channel that's missing from
+         * the end, for want of the change after it.
+         */
+        CHECK(got == n - 1, "frames");
+        for (unsigned int i = 0; i < got; i++) {
+                snprintf(what, sizeof(what), "frame %d (%08x)", i, fifo[i]);
+                CHECK((uint16_t)l[i] == (fifo[i] & 0xffff), what);
+                CHECK((uint16_t)r[i] == (fifo[i + 1] >> 16), what);
+        }
+}
+
+/* Clocks:  BCLK every other cycle, WS every 64, both square; WS and data
+ * only change while BCLK is low.
+ */
+static void     test_timing(void)
+{
+        uint32_t fifo[8];
+        unsigned int rises = 0, ws_changes = 0, bad_edges = 0, last_ws_change = 0;
+        bool ws_period_ok = true;
+
+        for (unsigned int i = 0; i < 8; i++)
+                fifo[i] = 0x9c3a65c5 ^ (i * 0x01010101);
+        run(fifo, 8, 1 + 64 * 8);
+
+        for (unsigned int i = 2; i < ncycles; i++) {
+                const pins_t *p = &trace[i], *q = &trace[i - 1];
+
+                if (p->bclk && !q->bclk)
+                        rises++;
+                if (p->bclk == q->bclk)
+                        bad_edges++;            /* BCLK must toggle each cycle */
+                if ((p->ws != q->ws || p->data != q->data) && p->bclk)
+                        bad_edges++;
+                if (p->ws != q->ws) {
+                        if (ws_changes > 0 && i - last_ws_change != 32)
+                                ws_period_ok = false;
+                        ws_changes++;
+                        last_ws_change = i;
+                }
+        }
+        CHECK(bad_edges == 0, "BCLK square, WS/data change on falling edge");
+        CHECK(rises >= 32 * 8 - 1, "32 BCLKs per frame");
+        CHECK(ws_changes >= 15 && ws_period_ok, "WS every 32 cycles");
+}
+
+/* Run dry:  the state machine stalls with BCLK low (so no stray bits) */
+static void     test_underrun(void)
+{
+        uint32_t fifo[1] = { 0x12345678 };
+        unsigned int high = 0;
+
+        run(fifo, 1, 64 * 3);
+        CHECK(stalls > 64, "underrun stalls");
+        for (unsigned int i = ncycles - stalls; i < ncycles; i++) {
+                if (trace[i].bclk)
+                        high++;
+        }
+        CHECK(high == 0, "BCLK low whilst stalled");
+}
+
+int     main(int argc, char *argv[])
+{
+        if (argc != 2) {
+                fprintf(stderr, "Syntax: %s <audio_i2s.pio>\n", argv[0]);
+                return 1;
+        }
+        if (!load(argv[1])) {
+                printf("FAIL: can't model %s\n", argv[1]);
+                return 1;
+        }
+        test_frames();
+        test_timing();
+        test_underrun();
+        printf("%s: %d checked, %d failed\n", failed ? "FAIL" : "PASS", checked, failed);
+        return failed ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+/* latency_test: mode-switch latency tracepoint checks (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "latency.h"
+#include "fpga_sim.h"
+
+/* latency.c takes its time from the simulator in the host build; here,
+ * this stands in, so each check sets the clock it wants.
+ */
+static uint64_t         now_us;
+
+uint64_t        fpga_sim_time_us(void)
+{
+        return now_us;
+}
+
+static unsigned int     checked, failed;
+
+#define CHECK(cond, what)                                               \
+        do {                                                            \
+                checked++;                                              \
+                if (!(cond)) {                                          \
+                        printf("FAIL: %s: %s\n", what, #cond);          \
+                        failed++;                                       \
+                }                                                       \
+        } while (0)
+
+static void     span(lat_stage_t s, uint32_t us)
+{
+        LAT_BEGIN(s);
+        now_us += us;
+        LAT_END(s);
+}
+
+static void     test_stats(void)
+{
+        lat_stat_t st;
+
+        lat_clear();
+        span(LAT_SOLVE, 100);
+        span(LAT_SOLVE, 300);
+        span(LAT_SOLVE, 0);
+        lat_get(LAT_SOLVE, &st);
+        CHECK(st.count == 3 && st.min_us == 0 && st.max_us == 300 &&
+              st.total_us == 400, "stats");
+        /* 0 in bucket 0; 100 in [64, 128), 7; 300 in [256, 512), 9 */
+        CHECK(st.hist[0] == 1 && st.hist[7] == 1 && st.hist[9] == 1, "buckets");
+
+        /* Longer than the last bucket goes in it */
+        span(LAT_SOLVE, 10000000);
+        lat_get(LAT_SOLVE, &st);
+        CHECK(st.hist[LAT_BUCKETS - 1] == 1, "overflow bucket");
+
+        /* Other stages untouched */
+        lat_get(LAT_SYNC, &st);
+        CHECK(st.count == 0, "other stage");
+
+        lat_clear();
+        lat_get(LAT_SOLVE, &st);
+        CHECK(st.count == 0 && st.max_us == 0 && st.hist[0] == 0, "clear");
+}
+
+static void     test_pairing(void)
+{
+        lat_stat_t st;
+
+        lat_clear();
+        /* END without BEGIN is ignored */
+        LAT_END(LAT_MODE_CHANGE);
+        lat_get(LAT_MODE_CHANGE, &st);
+        CHECK(st.count == 0, "end without begin");
+
+        /* A second END is ignored too */
+        span(LAT_MODE_CHANGE, 50);
+        now_us += 1000;
+        LAT_END(LAT_MODE_CHANGE);
+        lat_get(LAT_MODE_CHANGE, &st);
+        CHECK(st.count == 1 && st.max_us == 50, "double end");
+
+        /* A repeated BEGIN restarts */
+        LAT_BEGIN(LAT_MODE_CHANGE);
+        now_us += 1000;
+        span(LAT_MODE_CHANGE, 20);
+        lat_get(LAT_MODE_CHANGE, &st);
+        CHECK(st.count == 2 && st.min_us == 20, "restart");
+
+        /* Cancelled (reconfig to the same mode), then a later END (a
+         * forced probe) mustn't count the time since the BEGIN:
+         */
+        LAT_BEGIN(LAT_MODE_CHANGE);
+        now_us += 5000;
+        LAT_CANCEL(LAT_MODE_CHANGE);
+        now_us += 5000;
+        LAT_END(LAT_MODE_CHANGE);
+        lat_get(LAT_MODE_CHANGE, &st);
+        CHECK(st.count == 2 && st.max_us == 50, "cancel");
+
+        /* Stages nest and overlap independently */
+        LAT_BEGIN(LAT_MODE_CHANGE);
+        now_us += 10;
+        span(LAT_SOLVE, 30);
+        now_us += 10;
+        LAT_END(LAT_MODE_CHANGE);
+        lat_get(LAT_MODE_CHANGE, &st);
+        CHECK(st.count == 3 && st.max_us == 50 && st.total_us == 50 + 20 + 50,
+              "nested");
+        lat_get(LAT_SOLVE, &st);
+        CHECK(st.count == 1 && st.total_us == 30, "nested");
+
+        /* Clear drops begun stages too */
+        LAT_BEGIN(LAT_SYNC);
+        lat_clear();
+        LAT_END(LAT_SYNC);
+        lat_get(LAT_SYNC, &st);
+        CHECK(st.count == 0, "clear open");
+}
+
+/* The clock's 32 bits of microseconds; a span across the wrap is fine */
+static void     test_wrap(void)
+{
+        lat_stat_t st;
+
+        lat_clear();
+        now_us = 0xfffffff0ull;
+        span(LAT_PLL_LOCK, 0x20);
+        lat_get(LAT_PLL_LOCK, &st);
+        CHECK(st.count == 1 && st.max_us == 0x20, "wrap");
+}
+
+int     main(void)
+{
+        test_stats();
+        test_pairing();
+        test_wrap();
+        printf("%s: %d checked, %d failed\n", failed ? "FAIL" : "PASS", checked, failed);
+        return failed ? 1 : 0;
+}
@@ -0,0 +1,275 @@
+/* modestore_test: mode store checks against the flash model (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Built in, for the record layout, so records from another solver can be
+ * made up:
+ */
+#include "modestore.c"
+
+/* Only used by modestore_dump() */
+uint32_t        vidc_timing_hash(const vidc_timing_t *t)
+{
+        return t->h_cyc;
+}
+
+#define EDID_A          0x11111111
+#define EDID_B          0x22222222
+
+static unsigned int     checked, failed;
+
+#define CHECK(cond, what)                                               \
+        do {                                                            \
+                checked++;                                              \
+                if (!(cond)) {                                          \
+                        printf("FAIL: %s: %s\n", what, #cond);          \
+                        failed++;                                       \
+                }                                                       \
+        } while (0)
+
+/* Mode n:  a key and a mode that say n */
+static void     mode_n(unsigned int n, vidc_timing_t *key, video_mode_t *m)
+{
+        memset(key, 0, sizeof(*key));
+        memset(m, 0, sizeof(*m));
+        key->h_cyc = n;
+        key->control = 0x1000 + n;
+        m->pclk_khz = 24000 + n;
+        m->vido[VIDO_REG_RES_X] = 640;
+}
+
+static void     save_n(uint32_t edid, unsigned int n)
+{
+        vidc_timing_t key;
+        video_mode_t m;
+
+        mode_n(n, &key, &m);
+        modestore_save(edid, &key, &m);
+}
+
+/* The last mode's number, or -1 */
+static int      last_n(uint32_t edid)
+{
+        vidc_timing_t key;
+        video_mode_t m;
+
+        if (!modestore_last(edid, &key, &m))
+                return -1;
+        if (m.pclk_khz != 24000 + key.h_cyc)
+                return -2;
+        return key.h_cyc;
+}
+
+static unsigned int     seen[32];
+static unsigned int     nseen;
+
+static void     collect(const vidc_timing_t *key, const video_mode_t *m)
+{
+        if (nseen < 32)
+                seen[nseen] = key->h_cyc;
+        nseen++;
+}
+
+static unsigned int     count(uint32_t edid)
+{
+        nseen = 0;
+        modestore_foreach(edid, collect);
+        return nseen;
+}
+
+static unsigned int     programs(void)
+{
+        flash_sim_stats_t a, b;
+
+        flash_sim_get_stats(0, &a);
+        flash_sim_get_stats(1, &b);
+        return a.programs + b.programs;
+}
+
+static unsigned int     overwrites(void)
+{
+        flash_sim_stats_t a, b;
+
+        flash_sim_get_stats(0, &a);
+        flash_sim_get_stats(1, &b);
+        return a.overwrites + b.overwrites;
+}
+
+static void     fresh(void)
+{
+        flash_sim_reset();
+        modestore_init();
+}
+
+static void     test_basic(void)
+{
+        fresh();
+        CHECK(last_n(EDID_A) == -1 && count(EDID_A) == 0, "empty");
+
+        save_n(EDID_A, 1);
+        save_n(EDID_A, 2);
+        CHECK(last_n(EDID_A) == 2, "last");
+        CHECK(count(EDID_A) == 2 && seen[0] == 1 && seen[1] == 2, "foreach");
+
+        unsigned int p = programs();
+        save_n(EDID_A, 2);
+        CHECK(programs() == p, "same again isn't written");
+
+        /* Survives a reboot */
+        modestore_init();
+        CHECK(last_n(EDID_A) == 2 && count(EDID_A) == 2, "reboot");
+        CHECK(overwrites() == 0, "only programs blank flash");
+}
+
+/* Modes are only returned for the monitor, and solver, they're for */
+static void     test_tags(void)
+{
+        fresh();
+        save_n(EDID_A, 1);
+        save_n(EDID_A, 2);
+        CHECK(last_n(EDID_B) == -1 && count(EDID_B) == 0, "other monitor");
+        CHECK(last_n(0) == -1, "no monitor");
+
+        save_n(EDID_B, 3);
+        CHECK(last_n(EDID_B) == 3 && count(EDID_B) == 1, "second monitor");
+        CHECK(last_n(EDID_A) == 2 && count(EDID_A) == 2, "first monitor kept");
+
+        /* The same mode for another monitor is a new record */
+        unsigned int p = programs();
+        save_n(EDID_A, 3);
+        CHECK(programs() == p + 1 && last_n(EDID_A) == 3, "same mode, other monitor");
+
+        /* A record from an older solver */
+        ms_record_t r;
+        vidc_timing_t key;
+        video_mode_t m;
+
+        mode_n(4, &key, &m);
+        ms_fill_record(&r, last->seq + 1, EDID_A, &key, &m);
+        r.solver = VSOLVE_VERSION - 1;
+        r.crc = ms_crc(&r, offsetof(ms_record_t, crc));
+        ms_program(active, next_page, &r, sizeof(r));
+        modestore_init();
+        CHECK(last_n(EDID_A) == 3 && count(EDID_A) == 3, "old solver ignored");
+
+        /* ...and saving what it had doesn't think it's already there */
+        save_n(EDID_A, 4);
+        CHECK(last_n(EDID_A) == 4, "old solver replaced");
+        CHECK(overwrites() == 0, "only programs blank flash");
+}
+
+/* Filling a sector compacts into the other, keeping the most recent
+ * distinct modes for the monitor in use, and dropping the rest.
+ */
+static void     test_compact(void)
+{
+        flash_sim_stats_t s0, s1;
+
+        fresh();
+        save_n(EDID_B, 100);
+        for (unsigned int i = 0; i < 40; i++)
+                save_n(EDID_A, i % 12);
+        CHECK(last_n(EDID_A) == 39 % 12, "compacted last");
+        CHECK(last_n(EDID_B) == -1, "other monitor dropped");
+
+        /* Most recent distinct, oldest first, ending with the last */
+        unsigned int n = count(EDID_A);
+        bool order = n <= MS_KEEP + (MS_PAGES - 1) && n >= MS_KEEP;
+
+        for (unsigned int i = 1; i < n && i < 32; i++) {
+                if (seen[i] != (seen[i - 1] + 1) % 12)
+                        order = false;
+        }
+        CHECK(order && seen[n - 1] == 39 % 12, "kept modes");
+
+        flash_sim_get_stats(0, &s0);
+        flash_sim_get_stats(1, &s1);
+        CHECK(s0.erases > 0 && s1.erases > 0 &&
+              (s0.erases > s1.erases ? s0.erases - s1.erases : s1.erases - s0.erases) <= 1,
+              "erases alternate");
+        CHECK(overwrites() == 0, "only programs blank flash");
+}
+
+/* Power's lost part-way through each flash operation of a save in turn,
+ * with the save landing on each page (so appends, and a compaction);
+ * after a reboot, the last mode is either the one before or the one being
+ * saved, and the others are still there.
+ */
+static void     test_power_cut(void)
+{
+        unsigned int torn = 0;
+
+        for (unsigned int saves = MS_PAGES; saves < 2*MS_PAGES; saves++) {
+                for (unsigned int op = 1; ; op++) {
+                        flash_sim_stats_t s0, s1;
+                        char what[48];
+
+                        fresh();
+                        for (unsigned int i = 0; i < saves; i++)
+                                save_n(EDID_A, i % 10);
+                        int before = last_n(EDID_A);
+                        unsigned int n = count(EDID_A);
+
+                        flash_sim_power_cut(op);
+                        save_n(EDID_A, 20);
+                        flash_sim_power_on();
+                        flash_sim_get_stats(0, &s0);
+                        flash_sim_get_stats(1, &s1);
+                        if (s0.lost + s1.lost == 0)
+                                break;          /* The save took fewer */
+                        torn++;
+
+                        modestore_init();
+                        int after = last_n(EDID_A);
+                        unsigned int m = count(EDID_A);
+
+                        snprintf(what, sizeof(what), "power cut, %d saves, op %d", saves, op);
+                        CHECK(after == before || after == 20, what);
+                        CHECK(m >= (n < MS_KEEP ? n : MS_KEEP - 1), what);
+
+                        /* And it carries on */
+                        save_n(EDID_A, 21);
+                        CHECK(last_n(EDID_A) == 21, what);
+                        save_n(EDID_A, 22);
+                        modestore_init();
+                        CHECK(last_n(EDID_A) == 22, what);
+                }
+        }
+        /* One op per append, more for the compaction */
+        CHECK(torn > MS_PAGES, "power cuts tried");
+}
+
+int     main(void)
+{
+        test_basic();
+        test_tags();
+        test_compact();
+        test_power_cut();
+        printf("%s: %d checked, %d failed\n", failed ? "FAIL" : "PASS", checked, failed);
+        return failed ? 1 : 0;
+}
@@ -0,0 +1,272 @@
+/* resample_test: rate converter accuracy and trim loop bounds (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "resample.h"
+
+/* Bounds on what resample.c gets wrong, for the VIDC rates it's fed:
+ *
+ * - Output count:  the Q16.16 step is rounded down, so there are never
+ *   fewer output frames than the exact ratio gives, and no more than one
+ *   step's rounding (< 1/step_nominal, relatively) over it.
+ * - Values:  a ramp comes out within an LSB of the line it samples (plus
+ *   the slope times the Q15 phase's rounding), and a full-scale jump
+ *   doesn't wrap.
+ * - Chunking:  the output's the same however the input and output are
+ *   split up between calls.
+ * - Trim:  against a consumer whose clock is off by a few thousand ppm,
+ *   the buffer level settles near its target, with the trim cancelling
+ *   the drift, and the trim never exceeds RESAMPLE_TRIM_MAX_PPM.
+ */
+
+static unsigned int     checked, failed;
+
+#define CHECK(cond, what)                                               \
+        do {                                                            \
+                checked++;                                              \
+                if (!(cond)) {                                          \
+                        printf("FAIL: %s: %s\n", what, #cond);          \
+                        failed++;                                       \
+                }                                                       \
+        } while (0)
+
+#define FRAME(l, r)     (((uint32_t)(uint16_t)(r) << 16) | (uint16_t)(l))
+#define LEFT(f)         ((int16_t)((f) & 0xffff))
+#define RIGHT(f)        ((int16_t)((f) >> 16))
+
+#define NIN             20000
+
+static uint32_t         in[NIN];
+static uint32_t         out[NIN * 5];
+static uint32_t         out2[NIN * 5];
+
+/* VIDC sound periods (us per byte) and channel counts, against each
+ * output rate:  from 1 channel at the fastest VIDC rate to 8 at slow.
+ */
+static const struct {
+        unsigned int    period, nch;
+} vidc_rates[] = {
+        { 3, 8 }, { 4, 8 }, { 6, 4 }, { 8, 4 }, { 12, 2 }, { 16, 2 },
+        { 20, 1 }, { 24, 1 }, { 32, 1 }, { 48, 1 }, { 64, 1 }, { 100, 1 },
+};
+
+static const unsigned int out_rates[] = { 32000, 44100, 48000 };
+
+static void     test_count(void)
+{
+        char what[48];
+
+        for (unsigned int i = 0; i < sizeof(vidc_rates) / sizeof(vidc_rates[0]); i++) {
+                for (unsigned int o = 0; o < 3; o++) {
+                        unsigned int den = vidc_rates[i].period * vidc_rates[i].nch;
+                        resample_t rs;
+                        unsigned int nin = NIN;
+
+                        resample_init(&rs);
+                        resample_set_rate(&rs, 1000000, den, out_rates[o]);
+
+                        unsigned int n = resample_run(&rs, in, &nin, out, sizeof(out) / 4);
+                        double exact = (double)NIN * den * out_rates[o] / 1000000.0;
+                        double over = n - exact;
+
+                        snprintf(what, sizeof(what), "%dus x %d -> %d: %d frames",
+                                 vidc_rates[i].period, vidc_rates[i].nch,
+                                 out_rates[o], n);
+                        CHECK(nin == NIN, what);
+                        CHECK(over > -1.0 && over < exact / rs.step_nominal + 1.0, what);
+                }
+        }
+}
+
+/* Input frame i is a ramp, left up and right down; output k samples it at
+ * k * step - 1 (the first output is the zero frame before the input).
+ */
+static void     test_ramp(void)
+{
+        static const int slopes[] = { 0, 1, 3, 7, 13 };
+        resample_t rs;
+        char what[48];
+
+        for (unsigned int s = 0; s < sizeof(slopes) / sizeof(slopes[0]); s++) {
+                int slope = slopes[s];
+                int base = -slope * 2000;
+                unsigned int nin = 4000, worst = 0;
+                double bound = 1.0 + (slope + 1) / 32768.0;
+
+                for (unsigned int i = 0; i < nin; i++)
+                        in[i] = FRAME(base + slope * (int)i, -(base + slope * (int)i));
+                resample_init(&rs);
+                resample_set_rate(&rs, 1000000, 20, 44100);
+
+                unsigned int n = resample_run(&rs, in, &nin, out, sizeof(out) / 4);
+
+                for (unsigned int k = 1; k < n; k++) {
+                        double x = (double)k * rs.step / RESAMPLE_ONE - 1.0;
+
+                        if (x < 0)
+                                continue;
+                        double want = base + slope * x;
+                        unsigned int el = fabs(LEFT(out[k]) - want) > bound;
+                        unsigned int er = fabs(RIGHT(out[k]) + want) > bound;
+
+                        worst += el + er;
+                }
+                snprintf(what, sizeof(what), "ramp slope %d", slope);
+                CHECK(worst == 0, what);
+        }
+
+        /* Full scale, every other frame:  no wrap, and between the two */
+        for (unsigned int i = 0; i < 64; i++)
+                in[i] = (i & 1) ? FRAME(32767, -32768) : FRAME(-32768, 32767);
+        resample_init(&rs);
+        resample_set_rate(&rs, 1000000, 7, 48000);
+        rs.prev = in[0];
+
+        unsigned int nin = 64, bad = 0;
+        unsigned int n = resample_run(&rs, in, &nin, out, sizeof(out) / 4);
+
+        for (unsigned int k = 0; k < n; k++) {
+                /* Each L is the negation of its R, less the two halves'
+                 * rounding down; a wrap would be a long way out.
+                 */
+                int sum = LEFT(out[k]) + RIGHT(out[k]);
+
+                if (sum < -2 || sum > 0)
+                        bad++;
+        }
+        CHECK(n > 16 && bad == 0, "full scale");
+}
+
+/* Chunked input and output match a single call */
+static void     test_chunks(void)
+{
+        resample_t rs;
+        uint32_t lfsr = 0x1234567;
+        unsigned int nin, n, pos = 0, n2 = 0;
+
+        for (unsigned int i = 0; i < NIN; i++) {
+                lfsr = lfsr * 1103515245 + 12345;
+                in[i] = lfsr;
+        }
+        resample_init(&rs);
+        resample_set_rate(&rs, 1000000, 24, 48000);
+        nin = NIN;
+        n = resample_run(&rs, in, &nin, out, sizeof(out) / 4);
+
+        resample_init(&rs);
+        resample_set_rate(&rs, 1000000, 24, 48000);
+        while (pos < NIN) {
+                lfsr = lfsr * 1103515245 + 12345;
+
+                unsigned int chunk = (lfsr >> 16) % 37 + 1;
+                unsigned int room = (lfsr >> 8) % 29;   /* Sometimes none */
+
+                nin = chunk;
+                if (nin > NIN - pos)
+                        nin = NIN - pos;
+                n2 += resample_run(&rs, &in[pos], &nin, &out2[n2], room);
+                pos += nin;
+        }
+        CHECK(n2 == n, "chunked count");
+        CHECK(memcmp(out, out2, n * sizeof(out[0])) == 0, "chunked output");
+}
+
+/* The feed loop:  ticks of 256 input frames at the VIDC rate, resampled
+ * into a ring drained at the output rate off by drift_ppm, trimming after
+ * each.  Returns the level's worst distance from target over the last
+ * quarter, and leaves the trim in *trim.
+ */
+#define TICKS           20000
+#define TARGET          1024
+
+static int      run_loop(int drift_ppm, int *trim, int *trim_max)
+{
+        resample_t rs;
+        unsigned int period = 24, out_hz = 48000;
+        double level = TARGET, drained = 0;
+        int worst = 0;
+
+        resample_init(&rs);
+        resample_set_rate(&rs, 1000000, period, out_hz);
+        *trim_max = 0;
+        for (unsigned int t = 0; t < TICKS; t++) {
+                unsigned int nin = 256;
+                unsigned int n = resample_run(&rs, in, &nin, out, sizeof(out) / 4);
+
+                level += n;
+                drained = 256.0 * period * out_hz * (1.0 + drift_ppm / 1e6) / 1e6;
+                level -= drained;
+                if (level < 0)
+                        level = 0;
+                resample_trim(&rs, (unsigned int)level, TARGET);
+                if (abs(rs.trim_ppm) > *trim_max)
+                        *trim_max = abs(rs.trim_ppm);
+                if (t >= TICKS * 3 / 4 && abs((int)level - TARGET) > worst)
+                        worst = abs((int)level - TARGET);
+        }
+        *trim = rs.trim_ppm;
+        return worst;
+}
+
+static void     test_trim(void)
+{
+        static const int drifts[] = { 0, 100, -100, 1000, -1000, 3000, -3000 };
+        char what[48];
+        int trim, trim_max;
+
+        for (unsigned int i = 0; i < sizeof(drifts) / sizeof(drifts[0]); i++) {
+                int worst = run_loop(drifts[i], &trim, &trim_max);
+
+                snprintf(what, sizeof(what), "drift %d ppm: level +/-%d, trim %d",
+                         drifts[i], worst, trim);
+                CHECK(worst <= 4, what);
+                /* The step's rounding is the trim's resolution:  ~15ppm here */
+                CHECK(abs(trim + drifts[i]) <= 50, what);
+                CHECK(trim_max <= RESAMPLE_TRIM_MAX_PPM, what);
+        }
+
+        /* Beyond what it can trim:  clamped, not wound up or wrapped */
+        run_loop(20000, &trim, &trim_max);
+        CHECK(trim == -RESAMPLE_TRIM_MAX_PPM && trim_max == RESAMPLE_TRIM_MAX_PPM,
+              "saturated");
+        run_loop(-20000, &trim, &trim_max);
+        CHECK(trim == RESAMPLE_TRIM_MAX_PPM && trim_max == RESAMPLE_TRIM_MAX_PPM,
+              "saturated");
+}
+
+int     main(void)
+{
+        test_count();
+        test_ramp();
+        test_chunks();
+        test_trim();
+        printf("%s: %d checked, %d failed\n", failed ? "FAIL" : "PASS", checked, failed);
+        return failed ? 1 : 0;
+}
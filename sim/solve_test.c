@@ -0,0 +1,207 @@
+/* solve_test: video_solve() against the previous hand-picked modes (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "video.h"
+#include "video_solve.h"
+#include "vidc_regs.h"
+#include "pll.h"
+
+/* Before the PLL solver, the output clock was one of a few multiples of
+ * 24MHz with potted PLL words, and line-doubled modes stepped up through
+ * 24/36/48MHz until the line fitted.  These are those words, and that
+ * stepping, for checking the solver against:  the words it picks for the
+ * old clocks must be the same, and doubled modes must still get sane
+ * porches, at no higher a clock than before where the old result was sane.
+ *
+ * (The old x0.5 word had a different FILTER_RANGE, and x0.38 came from
+ * another reference, but neither was used for VIDC modes.)
+ */
+
+static const struct {
+        unsigned int    mult;           /* x10 */
+        uint32_t        cfg;
+} old_plls[] = {
+        { 10, (1 << 25) | (1 << 22) | (2 << 14) | (5 << 11) | (31 << 4) },
+        { 15, (1 << 25) | (1 << 22) | (2 << 14) | (4 << 11) | (23 << 4) },
+        { 20, (1 << 25) | (1 << 22) | (2 << 14) | (4 << 11) | (31 << 4) },
+        { 40, (1 << 25) | (1 << 22) | (2 << 14) | (3 << 11) | (31 << 4) },
+};
+
+/* VIDC modes, as display geometry and horizontal/vertical totals; the
+ * register words are made in RISC OS's proportions by test_timing().
+ */
+static const struct {
+        const char      *name;
+        uint32_t        cr;
+        unsigned int    xres, hcr, yres, vcr;
+} test_modes[] = {
+        { "mode 0",     0x02,  640, 1024, 256, 312 },
+        { "mode 1",     0x04,  320,  512, 256, 312 },
+        { "mode 12",    0x0a,  640, 1024, 256, 312 },
+        { "mode 13",    0x0c,  320,  512, 256, 312 },
+        { "mode 16",    0x0b, 1056, 1536, 256, 312 },
+        { "mode 27",    0x0b,  640,  800, 480, 525 },
+        { "mode 33",    0x02,  768, 1024, 288, 312 },
+        { "mode 36",    0x0e,  768, 1024, 288, 312 },
+        { "mode 37",    0x03,  896, 1136, 352, 366 },
+        { "640x200",    0x02,  640, 1024, 200, 262 },
+        { "800x256",    0x0a,  800, 1024, 256, 312 },
+        { "512x352",    0x09,  512,  768, 352, 366 },
+};
+
+static const unsigned int pix_rates[] = { 8, 12, 16, 24 };
+
+static void     test_timing(uint32_t cr, unsigned int xres, unsigned int hcr,
+                            unsigned int yres, unsigned int vcr, vidc_timing_t *t)
+{
+        unsigned int off = vidc_bpp_to_hdsr_offset((cr >> 2) & 3);
+        unsigned int blank = hcr - xres;
+        unsigned int hsw = (blank / 4) & ~1;
+        unsigned int hdsr_f = (hsw + blank / 2 - off) / 2;
+        unsigned int vsw = 3;
+        unsigned int vdsr = vsw + (vcr - yres - vsw) / 2;
+
+        t->h_cyc = ((hcr - 2) / 2) << 14;
+        t->h_sync = ((hsw - 2) / 2) << 14;
+        t->h_disp_start = hdsr_f << 14;
+        t->h_disp_end = (hdsr_f + xres / 2) << 14;
+        t->v_cyc = (vcr - 1) << 14;
+        t->v_sync = (vsw - 1) << 14;
+        t->v_disp_start = (vdsr - 1) << 14;
+        t->v_disp_end = (vdsr + yres - 1) << 14;
+        t->control = cr;
+}
+
+/* The old stepping:  returns the clock (MHz), or 0 if nothing fitted */
+static unsigned int     old_double(unsigned int xres, unsigned int hcr, unsigned int pix_rate,
+                                   unsigned int *fp, unsigned int *sw, int *bp)
+{
+        static const unsigned int out_clk_rates[] = { 24, 36, 48 };
+
+        for (unsigned int i = 0; i < 3; i++) {
+                unsigned int w = hcr * out_clk_rates[i] / pix_rate / 2;
+
+                if (w >= xres + xres / 32) {
+                        *fp = w / 20;
+                        *sw = w / 40;
+                        *bp = (int)w - (int)xres - (int)*fp - (int)*sw;
+                        return out_clk_rates[i];
+                }
+        }
+        return 0;
+}
+
+static unsigned int     test_plls(void)
+{
+        unsigned int bad = 0;
+
+        for (unsigned int i = 0; i < sizeof(old_plls)/sizeof(old_plls[0]); i++) {
+                pll_coeffs_t c;
+                uint32_t khz = PLL_REF_KHZ * old_plls[i].mult / 10;
+                bool ok = pll_lookup(NULL, khz, &c);
+                uint32_t cfg = ok ? pll_config_word(&c) : 0;
+
+                printf("%s: %5d kHz: %07x (was %07x)\n",
+                       (cfg == old_plls[i].cfg && c.fout_khz == khz) ? "ok  " : "FAIL",
+                       khz, cfg, old_plls[i].cfg);
+                if (cfg != old_plls[i].cfg || c.fout_khz != khz)
+                        bad++;
+        }
+        return bad;
+}
+
+static unsigned int     test_mode(unsigned int i)
+{
+        vidc_timing_t t;
+        video_solution_t s;
+        const video_mode_t *m = &s.mode;
+        const uint32_t *v = m->vido;
+        uint32_t cr = test_modes[i].cr;
+        unsigned int pix_rate = pix_rates[cr & 3];
+        unsigned int xres = test_modes[i].xres;
+        unsigned int hcr = test_modes[i].hcr;
+        unsigned int fp = 0, sw = 0, old_pclk;
+        int bp = 0;
+        const char *why = NULL;
+
+        test_timing(cr, xres, hcr, test_modes[i].yres, test_modes[i].vcr, &t);
+        video_solve(&t, NULL, NULL, &s);
+
+        unsigned int oxres = v[VIDO_REG_RES_X] & 0x7ff;
+        int32_t ofp = (int32_t)v[VIDO_REG_HS_FP];
+        int32_t osw = (int32_t)v[VIDO_REG_HS_WIDTH];
+        int32_t obp = (int32_t)v[VIDO_REG_HS_BP];
+        uint32_t htotal = oxres + v[VIDO_REG_HS_FP] + v[VIDO_REG_HS_WIDTH] +
+                v[VIDO_REG_HS_BP];
+
+        if (s.reason != VSOLVE_DOUBLED) {
+                /* 1:1, so VIDC's own timing at 24MHz */
+                old_pclk = 24;
+                if (ofp <= 0 || osw <= 0 || obp <= 0)
+                        why = "porch";
+                else if (m->pclk_khz != 24000 || htotal != hcr)
+                        why = "not 1:1";
+        } else {
+                old_pclk = old_double(oxres, hcr, pix_rate, &fp, &sw, &bp);
+
+                uint64_t line = (uint64_t)hcr * m->pclk_khz;
+                uint64_t out = (uint64_t)htotal * 2 * pix_rate * 1000;
+
+                if (ofp <= 0 || osw <= 0 || obp < (int32_t)(oxres / 32))
+                        why = "porch";
+                else if (m->pclk_khz > 48000 || m->pll_cfg == 0)
+                        why = "clock";
+                else if (out > line || line - out >= 2 * pix_rate * 1000)
+                        why = "line period";
+                else if (old_pclk && bp >= (int)(oxres / 32) &&
+                         m->pclk_khz > old_pclk * 1000)
+                        why = "faster than before";
+                else if (old_pclk && m->pclk_khz == old_pclk * 1000 &&
+                         (ofp != (int32_t)fp || osw != (int32_t)sw || obp != bp))
+                        why = "porches differ";
+        }
+        printf("%s: %-8s %4dx%-3d %2dMHz: %s, %5d kHz, x %d %d %d %d "
+               "(was %dMHz, %d %d %d)%s%s\n",
+               why ? "FAIL" : "ok  ", test_modes[i].name, xres, test_modes[i].yres,
+               pix_rate, video_solve_reason(s.reason), m->pclk_khz,
+               oxres, ofp, osw, obp, old_pclk, fp, sw, bp,
+               why ? ": " : "", why ? why : "");
+        return why ? 1 : 0;
+}
+
+int     main(void)
+{
+        unsigned int n = sizeof(test_modes)/sizeof(test_modes[0]);
+        unsigned int bad = test_plls();
+
+        for (unsigned int i = 0; i < n; i++)
+                bad += test_mode(i);
+        n += sizeof(old_plls)/sizeof(old_plls[0]);
+        printf("%s: %d checked, %d failed\n", bad ? "FAIL" : "PASS", n, bad);
+        return bad ? 1 : 0;
+}
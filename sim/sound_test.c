@@ -0,0 +1,229 @@
+/* sound_test: VIDC log decode and stereo mixing, against golden values (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "fpga.h"
+#include "audio.h"
+#include "vidc_sound.h"
+
+/* vidc_sound.c reads the stereo registers from the FPGA, and queues its
+ * output to audio.c; neither is used by the checks here, which call the
+ * decoder and mixer directly, so these just stand in.
+ */
+uint32_t        fpga_read32(unsigned int addr)
+{
+        return 0;
+}
+
+void            fpga_read_burst(unsigned int addr, uint32_t *data, unsigned int count)
+{
+        memset(data, 0, count * sizeof(*data));
+}
+
+unsigned int    audio_get_rate(void)
+{
+        return AUDIO_RATE_DEFAULT;
+}
+
+unsigned int    audio_space(void)
+{
+        return 0;
+}
+
+unsigned int    audio_level(void)
+{
+        return 0;
+}
+
+unsigned int    audio_write(const uint32_t *frames, unsigned int n)
+{
+        return n;
+}
+
+static unsigned int     checked, failed;
+
+#define CHECK(cond, what)                                               \
+        do {                                                            \
+                checked++;                                              \
+                if (!(cond)) {                                          \
+                        printf("FAIL: %s: %s\n", what, #cond);          \
+                        failed++;                                       \
+                }                                                       \
+        } while (0)
+
+/* The magnitudes of the 128 log codes (byte >> 1), chord by chord:  the
+ * same segments as G.711 mu-law, 0 to 8031.  vidc_sound_linear() gives
+ * these times 4, negated if bit 0 is set.
+ */
+static const int16_t    golden_mag[128] = {
+           0,    2,    4,    6,    8,   10,   12,   14,   16,   18,   20,   22,   24,   26,   28,   30,
+          33,   37,   41,   45,   49,   53,   57,   61,   65,   69,   73,   77,   81,   85,   89,   93,
+          99,  107,  115,  123,  131,  139,  147,  155,  163,  171,  179,  187,  195,  203,  211,  219,
+         231,  247,  263,  279,  295,  311,  327,  343,  359,  375,  391,  407,  423,  439,  455,  471,
+         495,  527,  559,  591,  623,  655,  687,  719,  751,  783,  815,  847,  879,  911,  943,  975,
+        1023, 1087, 1151, 1215, 1279, 1343, 1407, 1471, 1535, 1599, 1663, 1727, 1791, 1855, 1919, 1983,
+        2079, 2207, 2335, 2463, 2591, 2719, 2847, 2975, 3103, 3231, 3359, 3487, 3615, 3743, 3871, 3999,
+        4191, 4447, 4703, 4959, 5215, 5471, 5727, 5983, 6239, 6495, 6751, 7007, 7263, 7519, 7775, 8031,
+};
+
+static void     test_linear(void)
+{
+        char what[32];
+        unsigned int bad = 0;
+
+        for (unsigned int b = 0; b < 256; b++) {
+                int want = golden_mag[b >> 1] * 4;
+
+                if (b & 1)
+                        want = -want;
+                if (vidc_sound_linear(b) != want) {
+                        snprintf(what, sizeof(what), "byte %02x", b);
+                        CHECK(vidc_sound_linear(b) == want, what);
+                        bad++;
+                }
+        }
+        CHECK(bad == 0, "all 256 codes");
+        CHECK(vidc_sound_linear(0x00) == 0 && vidc_sound_linear(0x01) == 0, "zero");
+        CHECK(vidc_sound_linear(0xfe) == 32124 && vidc_sound_linear(0xff) == -32124,
+              "full scale");
+}
+
+/* Pan tables, through the mixer with one channel (so each frame is one
+ * slot's table entry):  position 1 is all left, 7 all right, 4 (and 0)
+ * an even split, in sixths between.
+ */
+static void     test_pan(void)
+{
+        uint8_t in[256 * 8];
+        uint32_t out[256 * 8];
+        uint8_t pos[VIDC_SOUND_SLOTS];
+        char what[32];
+
+        for (unsigned int i = 0; i < sizeof(in); i++)
+                in[i] = i / 8;
+
+        for (unsigned int p = 0; p < 8; p++) {
+                unsigned int rp = (p == 0) ? 4 : p;
+                unsigned int bad = 0;
+
+                memset(pos, p, sizeof(pos));
+                vidc_sound_set_stereo(pos);
+                snprintf(what, sizeof(what), "position %d", p);
+                CHECK(vidc_sound_mix(in, sizeof(in), 1, out) == sizeof(in), what);
+
+                for (unsigned int b = 0; b < 256; b++) {
+                        int lin = vidc_sound_linear(b);
+                        int16_t l = out[b * 8] & 0xffff;
+                        int16_t r = out[b * 8] >> 16;
+
+                        /* Truncated towards zero, like the table */
+                        if (l != lin * (int)(7 - rp) / 6 || r != lin * (int)(rp - 1) / 6)
+                                bad++;
+                }
+                CHECK(bad == 0, what);
+        }
+
+        /* Spot values:  full scale, left, centre and right */
+        memset(pos, 1, sizeof(pos));
+        vidc_sound_set_stereo(pos);
+        vidc_sound_mix((const uint8_t *)"\xfe\xfe\xfe\xfe\xfe\xfe\xfe\xfe", 8, 1, out);
+        CHECK(out[0] == 0x00007d7c, "left");
+        memset(pos, 4, sizeof(pos));
+        vidc_sound_set_stereo(pos);
+        vidc_sound_mix((const uint8_t *)"\xfe\xfe\xfe\xfe\xfe\xfe\xfe\xfe", 8, 1, out);
+        CHECK(out[0] == 0x3ebe3ebe, "centre");
+        memset(pos, 7, sizeof(pos));
+        vidc_sound_set_stereo(pos);
+        vidc_sound_mix((const uint8_t *)"\xff\xff\xff\xff\xff\xff\xff\xff", 8, 1, out);
+        CHECK(out[0] == 0x82840000, "right");
+}
+
+/* The mix is the mean of each sample period's slots */
+static void     test_mix(void)
+{
+        static const uint8_t pos[VIDC_SOUND_SLOTS] = { 1, 7, 1, 7, 1, 7, 1, 7 };
+        /* +8031, -8031, 0, +30 (x4), then their negations */
+        static const uint8_t in[8] = { 0xfe, 0xff, 0x00, 0x1e, 0xff, 0xfe, 0x01, 0x1f };
+        uint32_t out[8];
+
+        vidc_sound_set_stereo(pos);
+        CHECK(vidc_sound_mix(in, 8, 2, out) == 4, "2 ch");
+        CHECK(out[0] == 0xc1423ebe && out[1] == 0x003c0000 &&
+              out[2] == 0x3ebec142 && out[3] == 0xffc40000, "2 ch");
+        CHECK(vidc_sound_mix(in, 8, 4, out) == 2, "4 ch");
+        CHECK(out[0] == 0xe0bf1f5f && out[1] == 0x1f41e0a1, "4 ch");
+        CHECK(vidc_sound_mix(in, 8, 8, out) == 1, "8 ch");
+        CHECK(out[0] == 0, "8 ch");
+        /* Only whole groups of 8 */
+        CHECK(vidc_sound_mix(in, 7, 8, out) == 0, "partial");
+        CHECK(vidc_sound_mix(in, 8, 3, out) == 0, "bad nch");
+}
+
+/* The same input and positions as 'snd b', so its hashes on the device
+ * can be compared with these.
+ */
+static void     test_bench_hash(void)
+{
+        static const uint32_t golden[4] = {
+                0x309c709a, 0xca6fa6aa, 0x6a6972f2, 0xd3ae6b9d,
+        };
+        static const uint8_t pos[VIDC_SOUND_SLOTS] = { 1, 2, 3, 4, 5, 6, 7, 0 };
+        static uint8_t in[1024];
+        static uint32_t out[1024];
+        uint32_t lfsr = 0xace1;
+        char what[32];
+
+        for (unsigned int i = 0; i < sizeof(in); i++) {
+                lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xb400);
+                in[i] = lfsr;
+        }
+        vidc_sound_set_stereo(pos);
+
+        for (unsigned int nch = 1, i = 0; nch <= 8; nch <<= 1, i++) {
+                unsigned int frames = vidc_sound_mix(in, sizeof(in), nch, out);
+                uint32_t hash = 0x811c9dc5;
+
+                for (unsigned int f = 0; f < frames; f++) {
+                        hash ^= out[f];
+                        hash *= 0x01000193;
+                }
+                snprintf(what, sizeof(what), "%d ch hash %08x", nch, hash);
+                CHECK(frames == sizeof(in) / nch && hash == golden[i], what);
+        }
+}
+
+int     main(void)
+{
+        vidc_sound_init();
+        test_linear();
+        test_pan();
+        test_mix();
+        test_bench_hash();
+        printf("%s: %d checked, %d failed\n", failed ? "FAIL" : "PASS", checked, failed);
+        return failed ? 1 : 0;
+}
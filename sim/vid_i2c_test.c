@@ -0,0 +1,262 @@
+/* vid_i2c_test: the transmitter I2C queue against a mock bus (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "vid_i2c.h"
+#include "vid_i2c_xfer.h"
+#include "events.h"
+
+/* vid_i2c_xfer.c is run against a mock bus:  one device, a register file
+ * with an auto-incrementing pointer (as the transmitters have), and NAKs
+ * from any other address.  Like the DesignWare controller, it can complete
+ * later, when the test says, so callbacks and ordering can be checked
+ * while transactions are outstanding; or within start(), so the blocking
+ * calls (which spin until completion) can be.
+ */
+
+#define DEV_ADDR        0x39
+
+static uint8_t          dev_regs[256];
+static uint8_t          dev_ptr;
+static bool             bus_async;
+static bool             bus_pending;
+static unsigned int     bus_starts;
+static unsigned int     bus_overlaps;
+static struct {
+        uint8_t         addr;
+        const uint8_t   *wr;
+        unsigned int    wlen;
+        uint8_t         *rd;
+        unsigned int    rlen;
+} bus_x;
+
+static unsigned int     events_posted;
+
+void    event_post(uint32_t events)
+{
+        if (events & EVT_VID_I2C)
+                events_posted++;
+}
+
+static unsigned int     checked, failed;
+
+#define CHECK(cond, what)                                               \
+        do {                                                            \
+                checked++;                                              \
+                if (!(cond)) {                                          \
+                        printf("FAIL: %s: %s\n", what, #cond);          \
+                        failed++;                                       \
+                }                                                       \
+        } while (0)
+
+/* Run the transaction on the bus:  write sets the pointer then writes
+ * registers; read reads from the pointer.
+ */
+static int      bus_run(void)
+{
+        if (bus_x.addr != DEV_ADDR)
+                return -1;
+        for (unsigned int i = 0; i < bus_x.wlen; i++) {
+                if (i == 0)
+                        dev_ptr = bus_x.wr[0];
+                else
+                        dev_regs[dev_ptr++] = bus_x.wr[i];
+        }
+        for (unsigned int i = 0; i < bus_x.rlen; i++)
+                bus_x.rd[i] = dev_regs[dev_ptr++];
+        return bus_x.wlen + bus_x.rlen;
+}
+
+static void     bus_start(uint8_t addr, const uint8_t *wr, unsigned int wlen,
+                          uint8_t *rd, unsigned int rlen)
+{
+        if (bus_pending)
+                bus_overlaps++;
+        bus_starts++;
+        bus_x.addr = addr;
+        bus_x.wr = wr;
+        bus_x.wlen = wlen;
+        bus_x.rd = rd;
+        bus_x.rlen = rlen;
+        if (bus_async) {
+                bus_pending = true;
+                return;
+        }
+        vid_i2c_xfer_complete(bus_run());
+}
+
+/* Complete the transaction on the bus, as the IRQ would; false if idle */
+static bool     bus_finish(void)
+{
+        if (!bus_pending)
+                return false;
+        bus_pending = false;
+        vid_i2c_xfer_complete(bus_run());
+        return true;
+}
+
+static const vid_i2c_backend_t mock_bus = {
+        .start = bus_start,
+};
+
+#define LOG_MAX         64
+
+static int              cb_log[LOG_MAX];
+static unsigned int     cb_n;
+
+static void     log_cb(int result, void *arg)
+{
+        if (cb_n < LOG_MAX)
+                cb_log[cb_n] = ((int)(intptr_t)arg << 8) | (result & 0xff);
+        cb_n++;
+}
+
+static void     test_blocking(void)
+{
+        static const uint8_t wr[4] = { 0x10, 0xaa, 0xbb, 0xcc };
+        uint8_t reg = 0x10, rd[3];
+
+        bus_async = false;
+        CHECK(vid_i2c_write(DEV_ADDR, wr, 4) == 4, "write");
+        CHECK(dev_regs[0x10] == 0xaa && dev_regs[0x12] == 0xcc, "write");
+        CHECK(vid_i2c_write_read(DEV_ADDR, &reg, 1, rd, 3) == 4, "write_read");
+        CHECK(memcmp(rd, &wr[1], 3) == 0, "write_read");
+        /* The pointer's left after the last read */
+        CHECK(vid_i2c_read(DEV_ADDR, rd, 1) == 1 && rd[0] == dev_regs[0x13], "read");
+
+        CHECK(vid_i2c_write(DEV_ADDR + 1, wr, 4) == -1, "NAK");
+        CHECK(vid_i2c_read(DEV_ADDR + 1, rd, 1) == -1, "NAK");
+        CHECK(vid_i2c_write_read(DEV_ADDR, NULL, 0, NULL, 0) == -1, "empty");
+        CHECK(!bus_pending && bus_overlaps == 0, "blocking");
+}
+
+/* Queued in the background:  run in order, one on the bus at a time, but
+ * callbacks only from vid_i2c_poll(), and write data copied at submission.
+ */
+static void     test_queue(void)
+{
+        uint8_t wr[VID_I2C_WR_MAX + 1];
+        uint8_t rd[2] = { 0, 0 };
+        unsigned int starts = bus_starts;
+        unsigned int posted = events_posted;
+
+        bus_async = true;
+        cb_n = 0;
+        wr[0] = 0x20;
+        wr[1] = 0x11;
+        vid_i2c_submit(DEV_ADDR, wr, 2, NULL, 0, log_cb, (void *)1);
+        wr[1] = 0x22;                   /* After submission:  not written */
+        vid_i2c_submit(DEV_ADDR, wr, 1, rd, 2, log_cb, (void *)2);
+        vid_i2c_submit(DEV_ADDR + 2, wr, 1, NULL, 0, log_cb, (void *)3);
+        vid_i2c_submit(DEV_ADDR, wr, 2, NULL, 0, NULL, NULL);
+        CHECK(bus_starts == starts + 1, "one at a time");
+
+        /* Out of range:  failed at once, not queued */
+        vid_i2c_submit(DEV_ADDR, wr, VID_I2C_WR_MAX + 1, NULL, 0, log_cb, (void *)4);
+        vid_i2c_submit(DEV_ADDR, wr, 0, NULL, 0, log_cb, (void *)5);
+        CHECK(cb_n == 2 && cb_log[0] == ((4 << 8) | 0xff) &&
+              cb_log[1] == ((5 << 8) | 0xff), "rejected");
+
+        cb_n = 0;
+        CHECK(bus_finish() && bus_finish(), "finish");
+        CHECK(cb_n == 0, "no callbacks until poll");
+        vid_i2c_poll();
+        CHECK(cb_n == 2 && cb_log[0] == ((1 << 8) | 2) && cb_log[1] == ((2 << 8) | 3),
+              "in order");
+        CHECK(rd[0] == 0x11 && dev_regs[0x20] == 0x11, "data");
+
+        CHECK(bus_finish() && bus_finish() && !bus_finish(), "drained");
+        vid_i2c_poll();
+        CHECK(cb_n == 3 && cb_log[2] == ((3 << 8) | 0xff), "NAK");
+        CHECK(dev_regs[0x20] == 0x22, "last write");
+        CHECK(events_posted == posted + 4, "events");
+        CHECK(bus_starts == starts + 4 && bus_overlaps == 0, "starts");
+}
+
+/* A full queue:  all 16 slots outstanding, each with its own copy */
+static void     test_full(void)
+{
+        uint8_t wr[2];
+
+        bus_async = true;
+        cb_n = 0;
+        for (unsigned int i = 0; i < 16; i++) {
+                wr[0] = 0x80 + i;
+                wr[1] = i ^ 0x5a;
+                vid_i2c_submit(DEV_ADDR, wr, 2, NULL, 0, log_cb, (void *)(intptr_t)i);
+        }
+        while (bus_finish())
+                ;
+        vid_i2c_poll();
+
+        bool ok = cb_n == 16;
+
+        for (unsigned int i = 0; i < 16 && ok; i++)
+                ok = cb_log[i] == (int)((i << 8) | 2) && dev_regs[0x80 + i] == (i ^ 0x5a);
+        CHECK(ok, "full queue");
+        CHECK(bus_overlaps == 0, "full queue");
+}
+
+/* Completing within start() (so callbacks may queue more, which complete
+ * at once):  still in order, and nothing nests on the bus.
+ */
+static void     chain_cb(int result, void *arg)
+{
+        static const uint8_t wr[2] = { 0x40, 0x77 };
+
+        log_cb(result, arg);
+        if ((intptr_t)arg < 4)
+                vid_i2c_submit(DEV_ADDR, wr, 2, NULL, 0, chain_cb,
+                               (void *)((intptr_t)arg + 1));
+}
+
+static void     test_sync(void)
+{
+        static const uint8_t wr[2] = { 0x40, 0x01 };
+
+        bus_async = false;
+        cb_n = 0;
+        vid_i2c_submit(DEV_ADDR, wr, 2, NULL, 0, chain_cb, (void *)1);
+        CHECK(cb_n == 0, "sync: callbacks from poll");
+        vid_i2c_poll();
+        CHECK(cb_n == 4 && cb_log[0] == ((1 << 8) | 2) && cb_log[3] == ((4 << 8) | 2),
+              "sync: chained");
+        CHECK(dev_regs[0x40] == 0x77 && bus_overlaps == 0, "sync: chained");
+        vid_i2c_fence();
+}
+
+int     main(void)
+{
+        vid_i2c_xfer_init(&mock_bus);
+        test_blocking();
+        test_queue();
+        test_full();
+        test_sync();
+        printf("%s: %d checked, %d failed\n", failed ? "FAIL" : "PASS", checked, failed);
+        return failed ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+/* sim_stubs: host build stand-ins for the I/O the simulator doesn't model
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio.h"
+#include "capture.h"
+#include "dvo.h"
+#include "vid_i2c.h"
+
+/* The host build (see fpga_sim.c) models the FPGA only.  There's no video
+ * transmitter (so no monitor, and no EDID), audio output or bus capture;
+ * these keep the rest of the firmware happy without them.
+ */
+
+uint8_t         fpga_bitstream[1];
+unsigned int    fpga_bitstream_length = 0;
+
+/******************************************************************************/
+/* Video transmitter */
+
+static dvo_timing_t     sim_timing;
+
+int     dvo_init()
+{
+        return 0;
+}
+
+const char *dvo_name()
+{
+        return "simulated";
+}
+
+int     dvo_status()
+{
+        printf("DVO: simulated, %dx%d %d kHz\r\n",
+               sim_timing.h_active, sim_timing.v_active, sim_timing.pclk_khz);
+        return 0;
+}
+
+void    dvo_bus_scan()
+{
+}
+
+int     dvo_set_timing(const dvo_timing_t *t)
+{
+        sim_timing = *t;
+        return 0;
+}
+
+int     dvo_audio_config(unsigned int rate)
+{
+        return 0;
+}
+
+int     dvo_mute(bool muted)
+{
+        return 0;
+}
+
+int     dvo_edid_read(uint8_t *buf, unsigned int len)
+{
+        return -1;
+}
+
+void    dvo_edid_fetch(uint8_t *buf, unsigned int len, dvo_edid_cb_t done)
+{
+        done(-1);
+}
+
+void    dvo_edid_poll(void)
+{
+}
+
+int     dvo_service_irq(uint32_t irq_time)
+{
+        return DVO_HPD_NONE;
+}
+
+void    dvo_get_hpd_stats(dvo_hpd_stats_t *s)
+{
+        *s = (dvo_hpd_stats_t){ 0 };
+}
+
+void    vid_i2c_poll(void)
+{
+}
+
+/******************************************************************************/
+/* Audio: consumed as soon as it's written */
+
+static unsigned int     sim_rate = AUDIO_RATE_DEFAULT;
+static bool             sim_muted;
+
+int             audio_init(unsigned int rate)
+{
+        return audio_set_rate(rate);
+}
+
+int             audio_set_rate(unsigned int rate)
+{
+        if (rate != 32000 && rate != 44100 && rate != 48000)
+                return -1;
+        sim_rate = rate;
+        return 0;
+}
+
+unsigned int    audio_get_rate(void)
+{
+        return sim_rate;
+}
+
+unsigned int    audio_space(void)
+{
+        return AUDIO_RING_FRAMES - 1;
+}
+
+unsigned int    audio_level(void)
+{
+        return 0;
+}
+
+unsigned int    audio_write(const uint32_t *frames, unsigned int n)
+{
+        return n;
+}
+
+void            audio_mute(bool muted)
+{
+        sim_muted = muted;
+}
+
+bool            audio_is_muted(void)
+{
+        return sim_muted;
+}
+
+void            audio_test_tone(void)
+{
+}
+
+void            audio_status(void)
+{
+        printf("Audio: simulated, %d Hz%s\r\n", sim_rate, sim_muted ? ", muted" : "");
+}
+
+/******************************************************************************/
+/* Bus capture */
+
+void            capture_init(void)
+{
+}
+
+void            capture_poll(void)
+{
+}
+
+void            capture_status(void)
+{
+        printf("Capture: not simulated\r\n");
+}
@@ -0,0 +1,456 @@
+/* sim_sweep: mode derivation regression sweep and benchmark (host build)
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "video.h"
+#include "video_solve.h"
+#include "vidc_regs.h"
+#include "sim_sweep.h"
+
+/* The grid:  each control word (pixel rate, bpp, and 16bpp) at each line
+ * rate, over a range of display sizes.  It's a sample of the space VIDC
+ * can be programmed with (common sizes, three line rates, one blanking
+ * shape), not all of it.  Blanking's synthesised in roughly
+ * RISC OS's proportions, and sizes that don't fit the line/frame (or VIDC's
+ * fields) are skipped.  Each control word also gets a zero HDER, as
+ * RISCiX's hires modes have been seen to write.
+ *
+ * The golden file is the listing of every derivation (what -l prints):
+ * one line per VIDC configuration, with the VIDO words, pixel clock and
+ * PLL config derived for it.  A mismatch is reported field by field.
+ */
+
+static const unsigned int sweep_xres[] = {
+        256, 320, 352, 384, 480, 512, 640, 720, 768, 800, 896, 1024, 1056, 1152, 1280
+};
+static const unsigned int sweep_yres[] = {
+        128, 192, 200, 224, 240, 256, 288, 352, 384, 400, 480, 512, 576, 600,
+        768, 864, 896, 1024
+};
+/* Line period (ns), and frame rate (Hz):  TV, 24kHz, VGA-ish */
+static const struct {
+        unsigned int    line_ns;
+        unsigned int    hz;
+} sweep_lines[] = {
+        { 64000, 50 }, { 41667, 60 }, { 32000, 60 },
+};
+
+#define SWEEP_CR_16BPP          (1 << 22)
+#define SWEEP_NUM_CR            (4*4 + 4)
+
+#define SWEEP_BENCH_SECS        0.5
+
+/* Sanity flags */
+#define SANE_PORCH              0x01    /* Negative, or zero-width sync */
+#define SANE_CLOCK              0x02    /* No PLL config for the pixel clock */
+#define SANE_REFRESH            0x04    /* Outside 50-85Hz */
+#define SANE_FIELD              0x08    /* Doesn't fit VIDO's 11-bit fields */
+
+static const char *sane_names[] = { "porch", "clock", "refresh", "field" };
+
+#define SWEEP_LINE_LEN          256
+#define SWEEP_MAX_FIELDS        24
+
+/* The listing, from the last recorded pass */
+static char             (*listing)[SWEEP_LINE_LEN];
+static unsigned int     listing_len, listing_size;
+static unsigned int     num_flagged;
+static unsigned int     flag_counts[4];
+static pll_memo_t       sweep_memo;
+
+static uint32_t sweep_cr(unsigned int i)
+{
+        /* Rate in 1:0, bpp in 3:2; then 8bpp as 16bpp */
+        return i < 16 ? i : (0xc | (i - 16) | SWEEP_CR_16BPP);
+}
+
+/* Make VIDC register values for a mode; false if it can't be done */
+static bool     sweep_timing(uint32_t cr, unsigned int xres, unsigned int yres,
+                             unsigned int line_ns, unsigned int hz, bool zero_hder,
+                             vidc_timing_t *t)
+{
+        static const unsigned int pix_rates[] = { 8, 12, 16, 24 };
+        unsigned int off = vidc_bpp_to_hdsr_offset((cr >> 2) & 3);
+        unsigned int hcr = (pix_rates[cr & 3] * line_ns / 1000) & ~1;
+        unsigned int vcr = 1000000000 / (line_ns * hz);
+
+        if (hcr < xres + xres/8 || hcr > 2048 || yres + 8 > vcr || vcr > 1024)
+                return false;
+
+        unsigned int blank = hcr - xres;
+        unsigned int hsw = (blank / 4) & ~1;
+        unsigned int hdsr = hsw + blank / 2;
+
+        if (hsw < 2)
+                hsw = 2;
+        if (hdsr < off)
+                return false;
+
+        unsigned int hdsr_f = (hdsr - off) / 2;
+        unsigned int hder_f = zero_hder ? 0 : hdsr_f + xres / 2;
+        unsigned int vsw = 3;
+        unsigned int vdsr = vsw + (vcr - yres - vsw) / 2;
+
+        if (hder_f > 1023)
+                return false;
+
+        t->h_cyc = ((hcr - 2) / 2) << 14;
+        t->h_sync = ((hsw - 2) / 2) << 14;
+        t->h_disp_start = hdsr_f << 14;
+        t->h_disp_end = hder_f << 14;
+        t->v_cyc = (vcr - 1) << 14;
+        t->v_sync = (vsw - 1) << 14;
+        t->v_disp_start = (vdsr - 1) << 14;
+        t->v_disp_end = (vdsr + yres - 1) << 14;
+        t->control = cr;
+        return true;
+}
+
+static unsigned int     sweep_check(const video_mode_t *m)
+{
+        const uint32_t *v = m->vido;
+        unsigned int flags = 0;
+        static const int porches[] = {
+                VIDO_REG_HS_FP, VIDO_REG_HS_WIDTH, VIDO_REG_HS_BP,
+                VIDO_REG_VS_FP, VIDO_REG_VS_WIDTH, VIDO_REG_VS_BP,
+        };
+
+        for (unsigned int i = 0; i < sizeof(porches)/sizeof(porches[0]); i++) {
+                uint32_t p = v[porches[i]];
+
+                if ((int32_t)p < 0 ||
+                    (p == 0 && (porches[i] == VIDO_REG_HS_WIDTH || porches[i] == VIDO_REG_VS_WIDTH)))
+                        flags |= SANE_PORCH;
+                else if (p > 0x7ff)
+                        flags |= SANE_FIELD;
+        }
+        if ((v[VIDO_REG_RES_X] & 0x3fffffff) > 0x7ff ||
+            (v[VIDO_REG_RES_Y] & 0x3fffffff) > 0x7ff || v[VIDO_REG_WPLM1] > 0xff)
+                flags |= SANE_FIELD;
+        if (m->pll_cfg == 0)
+                flags |= SANE_CLOCK;
+
+        uint64_t htotal = (uint64_t)(v[VIDO_REG_RES_X] & 0x7ff) + v[VIDO_REG_HS_FP] +
+                v[VIDO_REG_HS_WIDTH] + v[VIDO_REG_HS_BP];
+        uint64_t vtotal = (uint64_t)(v[VIDO_REG_RES_Y] & 0x7ff) + v[VIDO_REG_VS_FP] +
+                v[VIDO_REG_VS_WIDTH] + v[VIDO_REG_VS_BP];
+        uint64_t hz = (htotal && vtotal) ?
+                (uint64_t)m->pclk_khz * 1000 / (htotal * vtotal) : 0;
+
+        if (!(flags & SANE_PORCH) && (hz < 50 || hz > 85))
+                flags |= SANE_REFRESH;
+        return flags;
+}
+
+/* One line per derivation:  "<VIDC config>: <field>=<value> ...", the
+ * reason last (as it has spaces in)
+ */
+static void     sweep_format(char *buf, const vidc_timing_t *t, unsigned int xres,
+                             unsigned int yres, unsigned int line_ns,
+                             const video_solution_t *s, unsigned int flags)
+{
+        const video_mode_t *m = &s->mode;
+        const uint32_t *v = m->vido;
+        int n;
+
+        n = snprintf(buf, SWEEP_LINE_LEN,
+                     "cr %08x %4dx%-4d %5dns hder %3d: "
+                     "rx=%d hfp=%d hsw=%d hbp=%d ry=%d vfp=%d vsw=%d vbp=%d "
+                     "wpl=%02x ctrl=%08x pclk=%d pll=%07x dx=%d dy=%d hires=%d flags=",
+                     t->control, xres, yres, line_ns, t->h_disp_end >> 14,
+                     v[VIDO_REG_RES_X] & 0x7ff, v[VIDO_REG_HS_FP], v[VIDO_REG_HS_WIDTH],
+                     v[VIDO_REG_HS_BP],
+                     v[VIDO_REG_RES_Y] & 0x7ff, v[VIDO_REG_VS_FP], v[VIDO_REG_VS_WIDTH],
+                     v[VIDO_REG_VS_BP],
+                     v[VIDO_REG_WPLM1], v[VIDO_REG_CTRL], m->pclk_khz, m->pll_cfg,
+                     m->dx, m->dy, m->hires);
+        if (!flags)
+                n += snprintf(buf + n, SWEEP_LINE_LEN - n, "-");
+        for (unsigned int i = 0; i < 4; i++)
+                if (flags & (1 << i))
+                        n += snprintf(buf + n, SWEEP_LINE_LEN - n, "%s%s",
+                                      (flags & ((1 << i) - 1)) ? "," : "", sane_names[i]);
+        snprintf(buf + n, SWEEP_LINE_LEN - n, " reason=%s", video_solve_reason(s->reason));
+}
+
+static void     sweep_record(const char *line)
+{
+        if (listing_len == listing_size) {
+                listing_size = listing_size ? listing_size * 2 : 1024;
+                listing = realloc(listing, listing_size * sizeof(*listing));
+                if (!listing) {
+                        perror("sweep listing");
+                        exit(1);
+                }
+        }
+        strcpy(listing[listing_len++], line);
+}
+
+/* One pass over the grid; returns the number of derivations */
+static unsigned int     sweep_run(bool record)
+{
+        unsigned int n = 0;
+
+        if (record) {
+                listing_len = 0;
+                num_flagged = 0;
+                memset(flag_counts, 0, sizeof(flag_counts));
+        }
+        for (unsigned int c = 0; c < SWEEP_NUM_CR; c++) {
+                for (unsigned int l = 0; l < sizeof(sweep_lines)/sizeof(sweep_lines[0]); l++) {
+                        for (unsigned int x = 0; x < sizeof(sweep_xres)/sizeof(sweep_xres[0]); x++) {
+                                for (unsigned int y = 0; y <= sizeof(sweep_yres)/sizeof(sweep_yres[0]); y++) {
+                                        /* The extra one's the zero HDER case, at the largest height */
+                                        bool zero_hder = y == sizeof(sweep_yres)/sizeof(sweep_yres[0]);
+                                        unsigned int yres = sweep_yres[zero_hder ? 0 : y];
+                                        vidc_timing_t t;
+                                        video_solution_t s;
+
+                                        if (zero_hder && x != 0)
+                                                continue;
+                                        if (!sweep_timing(sweep_cr(c), sweep_xres[x], yres,
+                                                          sweep_lines[l].line_ns, sweep_lines[l].hz,
+                                                          zero_hder, &t))
+                                                continue;
+                                        video_solve(&t, NULL, &sweep_memo, &s);
+                                        n++;
+                                        if (!record)
+                                                continue;
+
+                                        unsigned int flags = sweep_check(&s.mode);
+                                        char line[SWEEP_LINE_LEN];
+
+                                        if (flags)
+                                                num_flagged++;
+                                        for (unsigned int i = 0; i < 4; i++)
+                                                if (flags & (1 << i))
+                                                        flag_counts[i]++;
+                                        sweep_format(line, &t, sweep_xres[x], yres,
+                                                     sweep_lines[l].line_ns, &s, flags);
+                                        sweep_record(line);
+                                }
+                        }
+                }
+        }
+        return n;
+}
+
+static int      sweep_write_golden(const char *path)
+{
+        FILE *f = fopen(path, "w");
+
+        if (!f) {
+                perror(path);
+                return 1;
+        }
+        fprintf(f, "# video_solve() sweep results; regenerate with firmware_sim -S\n"
+                "# cr <control> <size> <line period> hder <HDER>: <derived mode>\n");
+        for (unsigned int i = 0; i < listing_len; i++)
+                fprintf(f, "%s\n", listing[i]);
+        fclose(f);
+        printf("Wrote %d derivations to %s\n", listing_len, path);
+        return 0;
+}
+
+/* Split "<key>: <name>=<value> ..." into fields (in place); reason= takes
+ * the rest of the line.  Returns the number of fields.
+ */
+static unsigned int     sweep_fields(char *line, char *names[], char *vals[])
+{
+        char *p = strchr(line, ':');
+        unsigned int n = 0;
+
+        if (!p)
+                return 0;
+        *p++ = '\0';
+        while (n < SWEEP_MAX_FIELDS) {
+                while (*p == ' ')
+                        p++;
+                if (!*p)
+                        break;
+
+                char *eq = strchr(p, '=');
+
+                if (!eq)
+                        break;
+                *eq = '\0';
+                names[n] = p;
+                vals[n] = eq + 1;
+                p = eq + 1;
+                if (strcmp(names[n++], "reason") == 0)
+                        break;
+                p += strcspn(p, " ");
+                if (*p)
+                        *p++ = '\0';
+        }
+        return n;
+}
+
+static void     sweep_diff(const char *was, const char *now)
+{
+        char a[SWEEP_LINE_LEN], b[SWEEP_LINE_LEN];
+        char *an[SWEEP_MAX_FIELDS], *av[SWEEP_MAX_FIELDS];
+        char *bn[SWEEP_MAX_FIELDS], *bv[SWEEP_MAX_FIELDS];
+
+        strcpy(a, was);
+        strcpy(b, now);
+
+        unsigned int na = sweep_fields(a, an, av);
+        unsigned int nb = sweep_fields(b, bn, bv);
+
+        printf("CHANGED: %s:", a);
+        for (unsigned int i = 0; i < na; i++) {
+                unsigned int j;
+
+                for (j = 0; j < nb && strcmp(an[i], bn[j]) != 0; j++)
+                        ;
+                if (j == nb)
+                        printf(" %s %s -> (none);", an[i], av[i]);
+                else if (strcmp(av[i], bv[j]) != 0)
+                        printf(" %s %s -> %s;", an[i], av[i], bv[j]);
+        }
+        for (unsigned int j = 0; j < nb; j++) {
+                unsigned int i;
+
+                for (i = 0; i < na && strcmp(an[i], bn[j]) != 0; i++)
+                        ;
+                if (i == na)
+                        printf(" %s (none) -> %s;", bn[j], bv[j]);
+        }
+        printf("\n");
+}
+
+static int      sweep_compare_golden(const char *path)
+{
+        FILE *f = fopen(path, "r");
+        char line[SWEEP_LINE_LEN];
+        bool *seen;
+        unsigned int checked = 0, bad = 0, next = 0;
+
+        if (!f) {
+                perror(path);
+                return 1;
+        }
+        seen = calloc(listing_len ? listing_len : 1, sizeof(bool));
+        if (!seen) {
+                perror("sweep listing");
+                exit(1);
+        }
+        while (fgets(line, sizeof(line), f)) {
+                size_t klen = strcspn(line, ":");
+                unsigned int i;
+
+                line[strcspn(line, "\n")] = '\0';
+                if (line[0] == '#' || line[klen] != ':')
+                        continue;
+                checked++;
+                /* Same order as the sweep, unless the grid's changed */
+                i = next;
+                if (i >= listing_len || strncmp(listing[i], line, klen + 1) != 0)
+                        for (i = 0; i < listing_len; i++)
+                                if (strncmp(listing[i], line, klen + 1) == 0)
+                                        break;
+                if (i == listing_len) {
+                        printf("MISSING: %s\n", line);
+                        bad++;
+                        continue;
+                }
+                seen[i] = true;
+                next = i + 1;
+                if (strcmp(listing[i], line) != 0) {
+                        sweep_diff(line, listing[i]);
+                        bad++;
+                }
+        }
+        fclose(f);
+        for (unsigned int i = 0; i < listing_len; i++) {
+                if (!seen[i]) {
+                        printf("NEW: %s\n", listing[i]);
+                        bad++;
+                }
+        }
+        free(seen);
+        printf("%s: %d derivations checked, %d differ\n", bad ? "FAIL" : "PASS", checked, bad);
+        return bad ? 1 : 0;
+}
+
+int     sim_sweep_main(int argc, char *argv[])
+{
+        bool list = false;
+        const char *golden = NULL;
+        bool write = false;
+
+        if (strcmp(argv[0], "-l") == 0 && argc == 1) {
+                list = true;
+        } else if (strcmp(argv[0], "-s") == 0 && argc <= 2) {
+                golden = argc == 2 ? argv[1] : NULL;
+        } else if (strcmp(argv[0], "-S") == 0 && argc == 2) {
+                golden = argv[1];
+                write = true;
+        } else {
+                fprintf(stderr, "Syntax: firmware_sim <scenario> | -s [<golden>] | "
+                        "-S <golden> | -l\n");
+                return 1;
+        }
+
+        unsigned int n = sweep_run(true);
+
+        if (list) {
+                for (unsigned int i = 0; i < listing_len; i++)
+                        printf("%s\n", listing[i]);
+                return 0;
+        }
+
+        /* Throughput, without the checking/hashing */
+        clock_t start = clock();
+        unsigned long total = 0;
+        double secs;
+
+        do {
+                total += sweep_run(false);
+                secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+        } while (secs < SWEEP_BENCH_SECS);
+
+        printf("%d derivations, %d flagged (", n, num_flagged);
+        for (unsigned int i = 0; i < 4; i++)
+                printf("%s%s %d", i ? ", " : "", sane_names[i], flag_counts[i]);
+        printf(")\n%.0f derivations/s\n", total / secs);
+
+        /* The other flags are the limits of what VIDO/the monitor can do,
+         * but a negative porch is always a bug in the derivation:
+         */
+        if (flag_counts[0]) {
+                printf("FAIL: %d derivations with a negative porch or zero-width sync "
+                       "(list them with -l)\n", flag_counts[0]);
+                return 1;
+        }
+        if (!golden)
+                return 0;
+        return write ? sweep_write_golden(golden) : sweep_compare_golden(golden);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIM_SWEEP_H
+#define SIM_SWEEP_H
+
+/* Host build only:  sweep video_solve() over a grid of VIDC
+ * configurations, checking the results against a golden file and for
+ * sanity, and measuring derivations per second.  The grid samples common
+ * sizes and line rates; it isn't every configuration VIDC allows.
+ *
+ * Arguments (from firmware_sim's command line):
+ *   -s [<golden>]      Sweep; compare against golden, if given
+ *   -S <golden>        Sweep, and (re)write golden
+ *   -l                 Sweep, listing every derivation
+ *
+ * Returns an exit status:  non-zero if any derived mode has a negative
+ * porch (or zero-width sync), or the golden file doesn't match.
+ */
+int     sim_sweep_main(int argc, char *argv[]);
+
+#endif
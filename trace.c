@@ -0,0 +1,137 @@
+/* VIDC register write trace
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include "trace.h"
+#include "vidc_regs.h"
+
+static trace_entry_t    trace_ring[TRACE_ENTRIES];   /* 16KB */
+static unsigned int     trace_head;     /* Total written */
+static unsigned int     trace_dropped;  /* Overwritten before being dumped */
+static bool             trace_on;
+static uint16_t         trace_frames;
+
+void    trace_enable(bool en)
+{
+        trace_on = en;
+}
+
+bool    trace_enabled(void)
+{
+        return trace_on;
+}
+
+void    trace_clear(void)
+{
+        trace_head = 0;
+        trace_dropped = 0;
+        trace_frames = 0;
+}
+
+void    trace_frame(void)
+{
+        trace_frames++;
+}
+
+void    trace_vidc_write(uint32_t word, unsigned int line)
+{
+        if (!trace_on)
+                return;
+
+        trace_entry_t *e = &trace_ring[trace_head % TRACE_ENTRIES];
+
+        e->word = word;
+        e->frame = trace_frames;
+        e->line = line;
+        if (trace_head >= TRACE_ENTRIES)
+                trace_dropped++;
+        trace_head++;
+}
+
+static unsigned int     trace_count(void)
+{
+        return trace_head < TRACE_ENTRIES ? trace_head : TRACE_ENTRIES;
+}
+
+void    trace_status(void)
+{
+        unsigned int n = trace_count();
+
+        printf("Trace %s: %d entries (%d dropped), frame %d\r\n",
+               trace_on ? "on" : "off", n, trace_dropped, trace_frames);
+        /* Show the last few in text, for a quick look: */
+        for (unsigned int i = (n > 8) ? n - 8 : 0; i < n; i++) {
+                const trace_entry_t *e =
+                        &trace_ring[(trace_head - n + i) % TRACE_ENTRIES];
+
+                printf("  frame %5d line %5d: reg %02x = %08x\r\n",
+                       e->frame, e->line == TRACE_NO_LINE ? -1 : e->line,
+                       VIDC_WRITE_REG(e->word), e->word);
+        }
+}
+
+static void     put_raw(const void *data, unsigned int len)
+{
+        const uint8_t *p = data;
+
+        while (len--)
+                putchar_raw(*p++);
+}
+
+static void     put_u16(uint16_t v)
+{
+        putchar_raw(v & 0xff);
+        putchar_raw(v >> 8);
+}
+
+static void     put_u32(uint32_t v)
+{
+        put_u16(v & 0xffff);
+        put_u16(v >> 16);
+}
+
+/* No CRLF translation (putchar_raw), so the host can read it verbatim */
+void    trace_dump_binary(void)
+{
+        unsigned int n = trace_count();
+
+        put_raw("ADVT", 4);
+        put_u16(TRACE_FORMAT_VERSION);
+        put_u16(sizeof(trace_entry_t));
+        put_u32(n);
+        put_u32(trace_dropped);
+        for (unsigned int i = 0; i < n; i++) {
+                const trace_entry_t *e =
+                        &trace_ring[(trace_head - n + i) % TRACE_ENTRIES];
+
+                put_u32(e->word);
+                put_u16(e->frame);
+                put_u16(e->line);
+        }
+        stdio_flush();
+}
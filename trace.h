@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* VIDC register write trace, from the parallel bus capture.
+ *
+ * Writes are timestamped with a frame count (from the FPGA's frame
+ * records) and, if the FPGA supplies it, the raster line.  The ring keeps
+ * the most recent TRACE_ENTRIES.
+ *
+ * Binary dump format (little-endian):
+ *      "ADVT", u16 version, u16 entry size, u32 entries, u32 dropped,
+ *      then entries, oldest first, each:
+ *      u32 VIDC write (register in 31:26), u16 frame, u16 line
+ */
+
+#define TRACE_ENTRIES           2048
+#define TRACE_NO_LINE           0xffff
+#define TRACE_FORMAT_VERSION    1
+
+typedef struct {
+        uint32_t        word;
+        uint16_t        frame;
+        uint16_t        line;
+} trace_entry_t;
+
+void            trace_enable(bool en);
+bool            trace_enabled(void);
+void            trace_clear(void);
+/* From capture: */
+void            trace_frame(void);
+void            trace_vidc_write(uint32_t word, unsigned int line);
+void            trace_status(void);
+/* Raw binary to stdout, for a host tool */
+void            trace_dump_binary(void);
+
+#endif
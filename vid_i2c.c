@@ -0,0 +1,166 @@
+/* vid_i2c: interrupt-driven I2C controller for the video transmitter
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+
+#include "vid_i2c.h"
+#include "vid_i2c_xfer.h"
+#include "hw.h"
+
+/* The DesignWare I2C controller, as the backend for the transaction
+ * queue (vid_i2c_xfer.c):  its interrupt feeds the FIFO, drains it, and
+ * completes the transaction on STOP.
+ */
+
+#define VID_I2C_FIFO_DEPTH      16
+
+/* The transaction on the bus, and its progress */
+static struct {
+        const uint8_t   *wr;
+        unsigned int    wlen;
+        uint8_t         *rd;
+        unsigned int    rlen;
+} x;
+static unsigned int     x_cmds;         /* Write bytes/read commands pushed */
+static unsigned int     x_rcvd;
+static bool             x_abort;
+static bool             inited;
+
+#define IRQ_MASK_ALL    (I2C_IC_INTR_MASK_M_TX_EMPTY_BITS | I2C_IC_INTR_MASK_M_RX_FULL_BITS | \
+                         I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS)
+
+/* IRQ context, or IRQs off */
+static void     vid_i2c_hw_start(uint8_t addr, const uint8_t *wr, unsigned int wlen,
+                                 uint8_t *rd, unsigned int rlen)
+{
+        i2c_hw_t *hw = i2c_get_hw(MCU_VID_I2C);
+
+        x.wr = wr;
+        x.wlen = wlen;
+        x.rd = rd;
+        x.rlen = rlen;
+        x_cmds = 0;
+        x_rcvd = 0;
+        x_abort = false;
+
+        hw->enable = 0;
+        hw->tar = addr;
+        hw->enable = 1;
+        (void)hw->clr_intr;
+        hw->intr_mask = IRQ_MASK_ALL;
+}
+
+/* Push commands into the TX FIFO.  Reads are limited to what fits in the
+ * RX FIFO; RX_FULL brings us back for more.  Returns true if there's more
+ * to push.
+ */
+static bool     vid_i2c_feed(i2c_hw_t *hw)
+{
+        unsigned int total = x.wlen + x.rlen;
+
+        while (x_cmds < total && hw->txflr < VID_I2C_FIFO_DEPTH) {
+                uint32_t c;
+
+                if (x_cmds < x.wlen) {
+                        c = x.wr[x_cmds];
+                } else {
+                        if ((x_cmds - x.wlen) - x_rcvd >= VID_I2C_FIFO_DEPTH)
+                                return false;
+                        c = I2C_IC_DATA_CMD_CMD_BITS;
+                        if (x_cmds == x.wlen && x.wlen)
+                                c |= I2C_IC_DATA_CMD_RESTART_BITS;
+                }
+                if (x_cmds == total - 1)
+                        c |= I2C_IC_DATA_CMD_STOP_BITS;
+                hw->data_cmd = c;
+                x_cmds++;
+        }
+        return x_cmds < total;
+}
+
+static void     vid_i2c_irq(void)
+{
+        i2c_hw_t *hw = i2c_get_hw(MCU_VID_I2C);
+        uint32_t st = hw->intr_stat;
+
+        if (st & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+                /* NAK etc.:  the controller flushes the FIFO and stops */
+                (void)hw->clr_tx_abrt;
+                x_abort = true;
+                x_cmds = x.wlen + x.rlen;
+        }
+        while (hw->rxflr) {
+                uint8_t d = hw->data_cmd;
+
+                if (x_rcvd < x.rlen)
+                        x.rd[x_rcvd++] = d;
+        }
+        if (!x_abort && vid_i2c_feed(hw))
+                hw->intr_mask |= I2C_IC_INTR_MASK_M_TX_EMPTY_BITS;
+        else
+                hw->intr_mask &= ~I2C_IC_INTR_MASK_M_TX_EMPTY_BITS;
+
+        if (st & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+                (void)hw->clr_stop_det;
+                /* Quiet until the next start, if any */
+                hw->intr_mask = 0;
+                vid_i2c_xfer_complete((x_abort || x_rcvd < x.rlen) ? -1 : (int)(x.wlen + x.rlen));
+        }
+}
+
+static const vid_i2c_backend_t hw_backend = {
+        .start = vid_i2c_hw_start,
+};
+
+void    vid_i2c_init(unsigned int baud)
+{
+        if (inited)
+                vid_i2c_fence();
+
+        i2c_init(MCU_VID_I2C, baud);
+        gpio_set_function(MCU_VID_SDA, GPIO_FUNC_I2C);
+        gpio_set_function(MCU_VID_SCL, GPIO_FUNC_I2C);
+        gpio_pull_up(MCU_VID_SDA);      /* Elides external P/U? */
+        gpio_pull_up(MCU_VID_SCL);
+
+        i2c_hw_t *hw = i2c_get_hw(MCU_VID_I2C);
+        unsigned int irq = I2C0_IRQ + i2c_hw_index(MCU_VID_I2C);
+
+        hw->intr_mask = 0;
+        hw->rx_tl = 0;                          /* RX_FULL at 1 byte */
+        hw->tx_tl = VID_I2C_FIFO_DEPTH / 2;     /* TX_EMPTY at half */
+        vid_i2c_xfer_init(&hw_backend);
+        irq_set_exclusive_handler(irq, vid_i2c_irq);
+        irq_set_enabled(irq, true);
+        inited = true;
+}
+
+void    vid_i2c_set_baud(unsigned int baud)
+{
+        vid_i2c_fence();
+        i2c_set_baudrate(MCU_VID_I2C, baud);
+}
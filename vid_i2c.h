@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VID_I2C_H
+#define VID_I2C_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Interrupt-driven transaction queue for the video transmitter's I2C bus
+ * (MCU_VID_I2C).  A transaction is an optional write then an optional
+ * read (with a repeated start between), ending with a stop.  They run in
+ * submission order, in the background.
+ *
+ * Completion callbacks are run from vid_i2c_poll(), in the main loop (on
+ * EVT_VID_I2C), not from the IRQ.  Owned by, and only used from, core 1.
+ *
+ * The queue is vid_i2c_xfer.c; the controller behind it, vid_i2c.c.
+ */
+
+/* Largest write copied into the queue by vid_i2c_submit() */
+#define VID_I2C_WR_MAX          34
+
+/* result is bytes transferred, or -1 (NAK/abort) */
+typedef void (*vid_i2c_cb_t)(int result, void *arg);
+
+void    vid_i2c_init(unsigned int baud);
+void    vid_i2c_set_baud(unsigned int baud);
+/* Queue a transaction.  wr (up to VID_I2C_WR_MAX) is copied; rd must stay
+ * valid until completion.  cb may be NULL.  Waits if the queue's full.
+ */
+void    vid_i2c_submit(uint8_t addr, const uint8_t *wr, unsigned int wlen,
+                       uint8_t *rd, unsigned int rlen,
+                       vid_i2c_cb_t cb, void *arg);
+/* Run callbacks of completed transactions */
+void    vid_i2c_poll(void);
+/* Wait for everything queued to complete */
+void    vid_i2c_fence(void);
+
+/* Blocking wrappers (queued behind anything already submitted), with the
+ * same returns as the SDK's i2c_*_blocking:
+ */
+int     vid_i2c_write(uint8_t addr, const uint8_t *wr, unsigned int wlen);
+int     vid_i2c_read(uint8_t addr, uint8_t *rd, unsigned int rlen);
+/* Write then (repeated start) read */
+int     vid_i2c_write_read(uint8_t addr, const uint8_t *wr, unsigned int wlen,
+                           uint8_t *rd, unsigned int rlen);
+
+void    vid_i2c_status(void);
+
+#endif
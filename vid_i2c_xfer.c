@@ -0,0 +1,219 @@
+/* vid_i2c_xfer: I2C transaction queue for the video transmitter
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "vid_i2c.h"
+#include "vid_i2c_xfer.h"
+#include "events.h"
+
+/* Transactions are queued in slots; the backend runs the one at q_cur,
+ * and on its completion the next is started.  On the device, the backend
+ * is the I2C controller's IRQ (vid_i2c.c); host tests put a model of the
+ * bus behind it.
+ */
+
+#define VID_I2C_SLOTS           16      /* Power of 2 */
+
+#define RESULT_PENDING          (-2)
+
+typedef struct {
+        uint8_t         addr;
+        const uint8_t   *wr;
+        unsigned int    wlen;
+        uint8_t         *rd;
+        unsigned int    rlen;
+        vid_i2c_cb_t    cb;
+        void            *arg;
+        volatile int    result;
+        uint8_t         wbuf[VID_I2C_WR_MAX];
+} vid_i2c_xfer_t;
+
+/* Slots from q_tail to q_cur are complete (awaiting their callbacks),
+ * q_cur is on the bus, and the rest up to q_head are queued.  q_head and
+ * q_tail only move in the main loop, q_cur only on completion (or when
+ * starting an idle bus, with IRQs off).
+ */
+static const vid_i2c_backend_t *q_backend;
+static vid_i2c_xfer_t   q[VID_I2C_SLOTS];
+static volatile unsigned int q_head;
+static volatile unsigned int q_cur;
+static unsigned int     q_tail;
+static volatile bool    busy;
+
+static struct {
+        unsigned int    transactions;
+        unsigned int    errors;
+        unsigned int    bytes;
+        unsigned int    max_queued;
+        unsigned int    full_waits;
+} vid_i2c_stats;
+
+void    vid_i2c_xfer_init(const vid_i2c_backend_t *backend)
+{
+        q_backend = backend;
+}
+
+/* Put the next queued transaction on the bus.  IRQ context, or IRQs off. */
+static void     vid_i2c_start(void)
+{
+        if (q_cur == q_head) {
+                busy = false;
+                return;
+        }
+        vid_i2c_xfer_t *x = &q[q_cur & (VID_I2C_SLOTS - 1)];
+
+        busy = true;
+        q_backend->start(x->addr, x->wr, x->wlen, x->rd, x->rlen);
+}
+
+void    vid_i2c_xfer_complete(int result)
+{
+        q[q_cur & (VID_I2C_SLOTS - 1)].result = result;
+        q_cur++;
+        event_post(EVT_VID_I2C);
+        vid_i2c_start();
+}
+
+/* Completing transactions needs their callbacks run, which is done here */
+static void     vid_i2c_wait_space(void)
+{
+        if (q_head - q_tail < VID_I2C_SLOTS)
+                return;
+        vid_i2c_stats.full_waits++;
+        while (q_head - q_tail == VID_I2C_SLOTS)
+                vid_i2c_poll();
+}
+
+static vid_i2c_xfer_t *vid_i2c_queue(uint8_t addr, const uint8_t *wr, unsigned int wlen,
+                                     uint8_t *rd, unsigned int rlen,
+                                     vid_i2c_cb_t cb, void *arg)
+{
+        vid_i2c_wait_space();
+
+        vid_i2c_xfer_t *x = &q[q_head & (VID_I2C_SLOTS - 1)];
+
+        x->addr = addr;
+        x->wr = wr;
+        x->wlen = wlen;
+        x->rd = rd;
+        x->rlen = rlen;
+        x->cb = cb;
+        x->arg = arg;
+        x->result = RESULT_PENDING;
+
+        uint32_t irqs = save_and_disable_interrupts();
+        q_head++;
+        if (!busy)
+                vid_i2c_start();
+        restore_interrupts(irqs);
+
+        if (q_head - q_tail > vid_i2c_stats.max_queued)
+                vid_i2c_stats.max_queued = q_head - q_tail;
+        return x;
+}
+
+void    vid_i2c_submit(uint8_t addr, const uint8_t *wr, unsigned int wlen,
+                       uint8_t *rd, unsigned int rlen,
+                       vid_i2c_cb_t cb, void *arg)
+{
+        if (wlen > VID_I2C_WR_MAX || (wlen + rlen) == 0) {
+                if (cb)
+                        cb(-1, arg);
+                return;
+        }
+        /* Copy into the slot that vid_i2c_queue() is about to use: */
+        vid_i2c_wait_space();
+
+        vid_i2c_xfer_t *x = &q[q_head & (VID_I2C_SLOTS - 1)];
+
+        for (unsigned int i = 0; i < wlen; i++)
+                x->wbuf[i] = wr[i];
+        vid_i2c_queue(addr, x->wbuf, wlen, rd, rlen, cb, arg);
+}
+
+void    vid_i2c_poll(void)
+{
+        while (q_tail != q_cur) {
+                vid_i2c_xfer_t *x = &q[q_tail & (VID_I2C_SLOTS - 1)];
+                vid_i2c_cb_t cb = x->cb;
+                void *arg = x->arg;
+                int r = x->result;
+
+                vid_i2c_stats.transactions++;
+                if (r < 0)
+                        vid_i2c_stats.errors++;
+                else
+                        vid_i2c_stats.bytes += r;
+                q_tail++;
+                if (cb)
+                        cb(r, arg);
+        }
+}
+
+void    vid_i2c_fence(void)
+{
+        while (q_cur != q_head)
+                tight_loop_contents();
+        vid_i2c_poll();
+}
+
+int     vid_i2c_write_read(uint8_t addr, const uint8_t *wr, unsigned int wlen,
+                           uint8_t *rd, unsigned int rlen)
+{
+        if ((wlen + rlen) == 0)
+                return -1;
+
+        /* Buffers stay put whilst waiting, so aren't copied */
+        vid_i2c_xfer_t *x = vid_i2c_queue(addr, wr, wlen, rd, rlen, NULL, NULL);
+
+        while (x->result == RESULT_PENDING)
+                tight_loop_contents();
+        int r = x->result;
+
+        vid_i2c_poll();
+        return r;
+}
+
+int     vid_i2c_write(uint8_t addr, const uint8_t *wr, unsigned int wlen)
+{
+        return vid_i2c_write_read(addr, wr, wlen, NULL, 0);
+}
+
+int     vid_i2c_read(uint8_t addr, uint8_t *rd, unsigned int rlen)
+{
+        return vid_i2c_write_read(addr, NULL, 0, rd, rlen);
+}
+
+void    vid_i2c_status(void)
+{
+        printf("I2C: %d transactions (%d failed), %d bytes, max queued %d, "
+               "%d waits for queue space\r\n",
+               vid_i2c_stats.transactions, vid_i2c_stats.errors, vid_i2c_stats.bytes,
+               vid_i2c_stats.max_queued, vid_i2c_stats.full_waits);
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VID_I2C_XFER_H
+#define VID_I2C_XFER_H
+
+#include <stdint.h>
+
+/* Backend interface for the I2C transaction queue (vid_i2c_xfer.c), which
+ * implements the queue parts of vid_i2c.h.
+ *
+ * start() puts one transaction on the bus:  wlen bytes of wr, then (with
+ * a repeated start) rlen bytes into rd, then a stop.  When it's done, the
+ * backend calls vid_i2c_xfer_complete() with the result (as for
+ * vid_i2c_cb_t), from IRQ context or from within start() itself.
+ */
+typedef struct {
+        void    (*start)(uint8_t addr, const uint8_t *wr, unsigned int wlen,
+                         uint8_t *rd, unsigned int rlen);
+} vid_i2c_backend_t;
+
+void    vid_i2c_xfer_init(const vid_i2c_backend_t *backend);
+void    vid_i2c_xfer_complete(int result);
+
+#endif
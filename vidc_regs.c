@@ -30,6 +30,7 @@
 #include "pico/stdlib.h"
 
 #include "fpga.h"
+#include "regcache.h"
 #include "vidc_regs.h"
 #include "hw.h"
 
@@ -38,7 +39,9 @@ static const char *modes[] = {
         "Normal", "TM0", "TM1", "TM2"
 };
 
-#define REG(x)         fpga_read32(FPGA_VIDC((x)/4))
+#define REG(x)         regcache_read(FPGA_VIDC((x)/4))
+/* Register from a local snapshot, regs[] */
+#define SREG(x)        regs[(x)/4]
 
 uint32_t        vidc_reg(unsigned int r)
 {
@@ -49,49 +52,90 @@ uint32_t        vidc_reg(unsigned int r)
         }
 }
 
+void            vidc_get_timing(vidc_timing_t *t)
+{
+        t->h_cyc = REG(VIDC_H_CYC);
+        t->h_sync = REG(VIDC_H_SYNC);
+        t->h_disp_start = REG(VIDC_H_DISP_START);
+        t->h_disp_end = REG(VIDC_H_DISP_END);
+        t->v_cyc = REG(VIDC_V_CYC);
+        t->v_sync = REG(VIDC_V_SYNC);
+        t->v_disp_start = REG(VIDC_V_DISP_START);
+        t->v_disp_end = REG(VIDC_V_DISP_END);
+        t->control = REG(VIDC_CONTROL);
+}
+
+/* A hash of the mode registers, for spotting changes cheaply (FNV-1a
+ * over the raw words):
+ */
+uint32_t        vidc_timing_hash(const vidc_timing_t *t)
+{
+        const uint32_t *w = (const uint32_t *)t;
+        uint32_t h = 2166136261u;
+
+        for (unsigned int i = 0; i < sizeof(*t)/sizeof(uint32_t); i++) {
+                h ^= w[i];
+                h *= 16777619u;
+        }
+        return h;
+}
+
+uint32_t        vidc_timing_signature(void)
+{
+        vidc_timing_t t;
+
+        vidc_get_timing(&t);
+        return vidc_timing_hash(&t);
+}
+
 /* Pretty-print the VIDC regs */
 void            vidc_dumpregs(void)
 {
+        /* Fetch the whole bank (plus DMA counters) in one go: */
+        uint32_t regs[(V_DMAC_CURSOR/4) + 1];
+
+        fpga_read_burst(FPGA_VIDC(0), regs, (V_DMAC_CURSOR/4) + 1);
+
         /* Palette */
         printf("Palette:\t\t");
         for (int i = 0; i < 16*4; i += 4) {
-                printf("%03x ", REG(VIDC_PAL_0 + i));
+                printf("%03x ", SREG(VIDC_PAL_0 + i));
         }
         printf("\r\n");
 
         /* Border */
         printf("Border:\t\t\tColour %03x, Hs %d, He %d, Vs %d, Ve %d\r\n",
-               REG(VIDC_BORDERCOL),
-               (REG(VIDC_H_BORDER_START) >> 14) & 0x3ff,
-               (REG(VIDC_H_BORDER_END) >> 14) & 0x3ff,
-               (REG(VIDC_V_BORDER_START) >> 14) & 0x3ff,
-               (REG(VIDC_V_BORDER_END) >> 14) & 0x3ff);
+               SREG(VIDC_BORDERCOL),
+               (SREG(VIDC_H_BORDER_START) >> 14) & 0x3ff,
+               (SREG(VIDC_H_BORDER_END) >> 14) & 0x3ff,
+               (SREG(VIDC_V_BORDER_START) >> 14) & 0x3ff,
+               (SREG(VIDC_V_BORDER_END) >> 14) & 0x3ff);
 
         /* Cursor */
         printf("Pointer:\t\tColours %03x/%03x/%03x, Hs %d (ext %d), Vs %d, Ve %d\r\n",
-               REG(VIDC_CURSORPAL1),
-               REG(VIDC_CURSORPAL2),
-               REG(VIDC_CURSORPAL3),
-               (REG(VIDC_H_CURSOR_START) >> 13) & 0x7ff,
-               (REG(VIDC_H_CURSOR_START) >> 11) & 0x3,
-               (REG(VIDC_V_CURSOR_START) >> 14) & 0x3ff,
-               (REG(VIDC_V_CURSOR_END) >> 14) & 0x3ff);
+               SREG(VIDC_CURSORPAL1),
+               SREG(VIDC_CURSORPAL2),
+               SREG(VIDC_CURSORPAL3),
+               (SREG(VIDC_H_CURSOR_START) >> 13) & 0x7ff,
+               (SREG(VIDC_H_CURSOR_START) >> 11) & 0x3,
+               (SREG(VIDC_V_CURSOR_START) >> 14) & 0x3ff,
+               (SREG(VIDC_V_CURSOR_END) >> 14) & 0x3ff);
 
         /* Display */
         printf("Display Horizontal:\tCycle %d, Sync %d, Dst %d, Dend %d, Ilace %d\r\n",
-               (REG(VIDC_H_CYC) >> 14) & 0x3ff,
-               (REG(VIDC_H_SYNC) >> 14) & 0x3ff,
-               (REG(VIDC_H_DISP_START) >> 14) & 0x3ff,
-               (REG(VIDC_H_DISP_END) >> 14) & 0x3ff,
-               (REG(VIDC_H_INTERLACE) >> 14) & 0x3ff);
+               (SREG(VIDC_H_CYC) >> 14) & 0x3ff,
+               (SREG(VIDC_H_SYNC) >> 14) & 0x3ff,
+               (SREG(VIDC_H_DISP_START) >> 14) & 0x3ff,
+               (SREG(VIDC_H_DISP_END) >> 14) & 0x3ff,
+               (SREG(VIDC_H_INTERLACE) >> 14) & 0x3ff);
 
         printf("Display Vertical:\tCycle %d, Sync %d, Dst %d, Dend %d\r\n",
-               (REG(VIDC_V_CYC) >> 14) & 0x3ff,
-               (REG(VIDC_V_SYNC) >> 14) & 0x3ff,
-               (REG(VIDC_V_DISP_START) >> 14) & 0x3ff,
-               (REG(VIDC_V_DISP_END) >> 14) & 0x3ff);
+               (SREG(VIDC_V_CYC) >> 14) & 0x3ff,
+               (SREG(VIDC_V_SYNC) >> 14) & 0x3ff,
+               (SREG(VIDC_V_DISP_START) >> 14) & 0x3ff,
+               (SREG(VIDC_V_DISP_END) >> 14) & 0x3ff);
 
-        uint32_t ctrl = REG(VIDC_CONTROL);
+        uint32_t ctrl = SREG(VIDC_CONTROL);
         printf("Display control:\t%s%s, %sSync, Interlace %s, DMARq %1x, BPP %d, PixClk %d, palExt %d, bppExt %d\r\n",
                modes[(ctrl >> 14) & 3],
                (ctrl & 0x100) ? ", TM3" : "",
@@ -105,22 +149,22 @@ void            vidc_dumpregs(void)
 
         /* Sound */
         printf("Sound:\t\t\tFreq %d, stereo %1x %1x %1x %1x %1x %1x %1x\r\n",
-               REG(VIDC_SOUND_FREQ) & 0xff,
-               REG(VIDC_STEREO0) & 0xf,
-               REG(VIDC_STEREO1) & 0xf,
-               REG(VIDC_STEREO2) & 0xf,
-               REG(VIDC_STEREO3) & 0xf,
-               REG(VIDC_STEREO4) & 0xf,
-               REG(VIDC_STEREO5) & 0xf,
-               REG(VIDC_STEREO6) & 0xf,
-               REG(VIDC_STEREO7) & 0xf);
+               SREG(VIDC_SOUND_FREQ) & 0xff,
+               SREG(VIDC_STEREO0) & 0xf,
+               SREG(VIDC_STEREO1) & 0xf,
+               SREG(VIDC_STEREO2) & 0xf,
+               SREG(VIDC_STEREO3) & 0xf,
+               SREG(VIDC_STEREO4) & 0xf,
+               SREG(VIDC_STEREO5) & 0xf,
+               SREG(VIDC_STEREO6) & 0xf,
+               SREG(VIDC_STEREO7) & 0xf);
 
         /* Counters: */
         printf("Video DMAs/frame:\t%d\r\nCursor DMAs/frame:\t%d\r\n",
-               REG(V_DMAC_VIDEO),
-               REG(V_DMAC_CURSOR));
+               SREG(V_DMAC_VIDEO),
+               SREG(V_DMAC_CURSOR));
 
         /* Custom/special regs: */
         printf("Special:\t\t%08x d %08x\r\n",
-               REG(VIDC_SPECIAL), REG(VIDC_SPECIAL_DATA));
+               SREG(VIDC_SPECIAL), SREG(VIDC_SPECIAL_DATA));
 }
@@ -25,6 +25,9 @@
 #ifndef VIDC_REGS_H
 #define VIDC_REGS_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #define VIDC_PAL_0              0
 #define VIDC_BORDERCOL          0x40
 #define VIDC_CURSORPAL1         0x44
@@ -63,8 +66,32 @@
 #define V_DMAC_VIDEO            0x100
 #define V_DMAC_CURSOR           0x104
 
+/* A write on the VIDC bus has the register (as the offsets above) in
+ * bits 31:26:
+ */
+#define VIDC_WRITE_REG(w)       (((w) >> 24) & 0xfc)
+
+/* Writes that can change the display mode; not palette, sound, or the
+ * cursor position (which moves with the mouse).
+ */
+static inline bool      vidc_is_timing_reg(unsigned int r)
+{
+        return (r >= VIDC_H_CYC && r <= VIDC_V_BORDER_END &&
+                r != VIDC_H_CURSOR_START) || r == VIDC_CONTROL;
+}
+
+/* The registers that define the display mode: */
+typedef struct {
+        uint32_t        h_cyc, h_sync, h_disp_start, h_disp_end;
+        uint32_t        v_cyc, v_sync, v_disp_start, v_disp_end;
+        uint32_t        control;
+} vidc_timing_t;
+
 void            vidc_dumpregs(void);
 uint32_t        vidc_reg(unsigned int r);
+void            vidc_get_timing(vidc_timing_t *t);
+uint32_t        vidc_timing_hash(const vidc_timing_t *t);
+uint32_t        vidc_timing_signature(void);
 
 
 static inline int vidc_bpp_to_hdsr_offset(int bpp_po2)
@@ -0,0 +1,366 @@
+/* VIDC sound sample decode and stereo mixing
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#if PICO_ON_DEVICE
+#include "hardware/structs/systick.h"
+#endif
+
+#include "fpga.h"
+#include "vidc_regs.h"
+#include "vidc_sound.h"
+#include "resample.h"
+#include "audio.h"
+#include "hw.h"
+
+/* Linear L/R contributions of each log byte, at each stereo position.
+ * The mixer looks these up per channel slot, so there's no per-sample
+ * multiply (the M0+ has no FPU, and only a 32x32 MUL).  8KB.
+ */
+static int16_t          pan[8][256][2];
+static const int16_t    (*slot_pan[VIDC_SOUND_SLOTS])[2];
+static resample_t       rs;
+
+static const unsigned int stereo_regs[VIDC_SOUND_SLOTS] = {
+        VIDC_STEREO0, VIDC_STEREO1, VIDC_STEREO2, VIDC_STEREO3,
+        VIDC_STEREO4, VIDC_STEREO5, VIDC_STEREO6, VIDC_STEREO7,
+};
+
+/* Segmented (mu-law-like) log: chord c, step s gives
+ * ((2s + 33) << c) - 33, which spans 0-8031; scaled by 4 for 16 bits.
+ */
+int16_t         vidc_sound_linear(uint8_t b)
+{
+        unsigned int chord = (b >> 5) & 7;
+        unsigned int step = (b >> 1) & 0xf;
+        int mag = ((((step << 1) + 33) << chord) - 33) * 4;
+
+        return (b & 1) ? -mag : mag;
+}
+
+void            vidc_sound_init(void)
+{
+        for (unsigned int p = 0; p < 8; p++) {
+                /* Position 1 is fully left, 7 fully right, 4 centre */
+                unsigned int rp = (p == 0) ? 4 : p;
+
+                for (unsigned int b = 0; b < 256; b++) {
+                        int lin = vidc_sound_linear(b);
+
+                        pan[p][b][0] = lin * (int)(7 - rp) / 6;
+                        pan[p][b][1] = lin * (int)(rp - 1) / 6;
+                }
+        }
+        for (unsigned int i = 0; i < VIDC_SOUND_SLOTS; i++)
+                slot_pan[i] = pan[4];
+        resample_init(&rs);
+}
+
+void            vidc_sound_set_stereo(const uint8_t pos[VIDC_SOUND_SLOTS])
+{
+        for (unsigned int i = 0; i < VIDC_SOUND_SLOTS; i++)
+                slot_pan[i] = pan[pos[i] & 7];
+}
+
+/* Straight from the FPGA, not the register cache:  the Arc writes these
+ * without a reconfig, so the cached VIDC snapshot can be stale.
+ */
+static void     vidc_sound_read_stereo(uint8_t pos[VIDC_SOUND_SLOTS])
+{
+        uint32_t st[VIDC_SOUND_SLOTS];
+
+        /* STEREO7 is first, at 0x60, then STEREO0-6 */
+        fpga_read_burst(FPGA_VIDC(VIDC_STEREO7 / 4), st, VIDC_SOUND_SLOTS);
+        for (unsigned int i = 0; i < VIDC_SOUND_SLOTS; i++)
+                pos[i] = st[(stereo_regs[i] - VIDC_STEREO7) / 4] & 7;
+        vidc_sound_set_stereo(pos);
+}
+
+void            vidc_sound_update_stereo(void)
+{
+        uint8_t pos[VIDC_SOUND_SLOTS];
+
+        vidc_sound_read_stereo(pos);
+}
+
+static inline uint32_t  mix_frame(int32_t l, int32_t r)
+{
+        return ((uint32_t)(uint16_t)r << 16) | (uint16_t)l;
+}
+
+#define MIX(i)          do {                                    \
+                const int16_t *e = slot_pan[i][in[i]];          \
+                l += e[0];                                      \
+                r += e[1];                                      \
+        } while (0)
+
+/* Each channel is only output for 1/nch of the sample period, so the mix
+ * is the mean of the slots rather than the sum.  That can't exceed the
+ * range of a single slot, so there's no clamping.
+ */
+unsigned int    vidc_sound_mix(const uint8_t *in, unsigned int nbytes, unsigned int nch,
+                               uint32_t *out)
+{
+        const uint8_t *end = in + (nbytes & ~7);
+        uint32_t *start = out;
+        int32_t l, r;
+
+        switch (nch) {
+        case 8:
+                for (; in < end; in += 8) {
+                        l = 0; r = 0;
+                        MIX(0); MIX(1); MIX(2); MIX(3);
+                        MIX(4); MIX(5); MIX(6); MIX(7);
+                        *out++ = mix_frame(l >> 3, r >> 3);
+                }
+                break;
+        case 4:
+                for (; in < end; in += 8) {
+                        l = 0; r = 0;
+                        MIX(0); MIX(1); MIX(2); MIX(3);
+                        *out++ = mix_frame(l >> 2, r >> 2);
+                        l = 0; r = 0;
+                        MIX(4); MIX(5); MIX(6); MIX(7);
+                        *out++ = mix_frame(l >> 2, r >> 2);
+                }
+                break;
+        case 2:
+                for (; in < end; in += 8) {
+                        l = 0; r = 0; MIX(0); MIX(1);
+                        *out++ = mix_frame(l >> 1, r >> 1);
+                        l = 0; r = 0; MIX(2); MIX(3);
+                        *out++ = mix_frame(l >> 1, r >> 1);
+                        l = 0; r = 0; MIX(4); MIX(5);
+                        *out++ = mix_frame(l >> 1, r >> 1);
+                        l = 0; r = 0; MIX(6); MIX(7);
+                        *out++ = mix_frame(l >> 1, r >> 1);
+                }
+                break;
+        case 1:
+                for (; in < end; in += 8) {
+                        for (unsigned int i = 0; i < 8; i++) {
+                                const int16_t *e = slot_pan[i][in[i]];
+
+                                *out++ = mix_frame(e[0], e[1]);
+                        }
+                }
+                break;
+        default:
+                break;
+        }
+        return out - start;
+}
+
+/******************************************************************************/
+
+/* Live VIDC sound parameters are re-read this often, as writes to them
+ * don't raise the VIDC reconfig IRQ:
+ */
+#define PARAM_POLL_US           10000
+#define FEED_CHUNK_BYTES        256
+#define FEED_OUT_FRAMES         256
+/* Aim to keep the output ring half full */
+#define FEED_TARGET_LEVEL       (AUDIO_RING_FRAMES / 2)
+
+static unsigned int     sound_period;   /* VIDC_SOUND_FREQ + 2, us per byte */
+static unsigned int     sound_nch;
+static unsigned int     sound_out_rate;
+static uint32_t         param_time;
+static uint8_t          carry[8];       /* Partial slot group from last feed */
+static unsigned int     carry_len;
+static vidc_sound_stats_t sound_stats;
+
+/* VIDC always cycles through the 8 stereo slots, one byte per period, and
+ * RISC OS programs slot i with channel (i mod nch)'s position.  Guess nch
+ * as the period of the stereo positions.
+ */
+static unsigned int     vidc_sound_channels(const uint8_t pos[VIDC_SOUND_SLOTS])
+{
+        for (unsigned int n = 1; n < VIDC_SOUND_SLOTS; n <<= 1) {
+                unsigned int i;
+
+                for (i = n; i < VIDC_SOUND_SLOTS; i++) {
+                        if (pos[i] != pos[i % n])
+                                break;
+                }
+                if (i == VIDC_SOUND_SLOTS)
+                        return n;
+        }
+        return VIDC_SOUND_SLOTS;
+}
+
+/* Re-read the sound registers directly (the VIDC shadow is only refreshed
+ * on mode changes), and follow any change of rate.
+ */
+static void     vidc_sound_poll_params(void)
+{
+        uint8_t pos[VIDC_SOUND_SLOTS];
+
+        vidc_sound_read_stereo(pos);
+
+        unsigned int period = (fpga_read32(FPGA_VIDC(VIDC_SOUND_FREQ / 4)) & 0xff) + 2;
+        unsigned int nch = vidc_sound_channels(pos);
+        unsigned int out_rate = audio_get_rate();
+
+        if (period != sound_period || nch != sound_nch || out_rate != sound_out_rate) {
+                sound_period = period;
+                sound_nch = nch;
+                sound_out_rate = out_rate;
+                resample_set_rate(&rs, 1000000, period * nch, out_rate);
+                sound_stats.rate_changes++;
+        }
+        param_time = time_us_32();
+}
+
+static void     vidc_sound_convert(const uint8_t *in, unsigned int nbytes)
+{
+        static uint32_t mixed[FEED_CHUNK_BYTES];
+        static uint32_t out[FEED_OUT_FRAMES];
+
+        while (nbytes >= 8) {
+                unsigned int len = nbytes > FEED_CHUNK_BYTES ? FEED_CHUNK_BYTES : nbytes;
+                unsigned int frames = vidc_sound_mix(in, len, sound_nch, mixed);
+                const uint32_t *p = mixed;
+
+                len &= ~7;
+                in += len;
+                nbytes -= len;
+                sound_stats.frames_in += frames;
+
+                /* Output is bounded by the ring's free space, so the work per
+                 * call is too; if it's full, the rest of the input is lost.
+                 */
+                while (frames) {
+                        unsigned int nin = frames;
+                        unsigned int space = audio_space();
+
+                        if (space > FEED_OUT_FRAMES)
+                                space = FEED_OUT_FRAMES;
+                        if (space == 0) {
+                                sound_stats.overflows++;
+                                break;
+                        }
+                        unsigned int nout = resample_run(&rs, p, &nin, out, space);
+
+                        audio_write(out, nout);
+                        sound_stats.frames_out += nout;
+                        p += nin;
+                        frames -= nin;
+                }
+        }
+}
+
+/* Queue captured VIDC sound bytes for output */
+void            vidc_sound_feed(const uint8_t *bytes, unsigned int n)
+{
+        if (sound_period == 0 || (time_us_32() - param_time) > PARAM_POLL_US)
+                vidc_sound_poll_params();
+
+        if (audio_level() == 0)
+                sound_stats.underruns++;
+
+        /* Complete a slot group left over from last time: */
+        while (carry_len && n) {
+                carry[carry_len++] = *bytes++;
+                n--;
+                if (carry_len == 8) {
+                        vidc_sound_convert(carry, 8);
+                        carry_len = 0;
+                }
+        }
+        vidc_sound_convert(bytes, n & ~7);
+        bytes += n & ~7;
+        for (n &= 7; n; n--)
+                carry[carry_len++] = *bytes++;
+
+        resample_trim(&rs, audio_level(), FEED_TARGET_LEVEL);
+}
+
+void            vidc_sound_get_stats(vidc_sound_stats_t *s)
+{
+        *s = sound_stats;
+}
+
+void            vidc_sound_status(void)
+{
+        if (sound_period)
+                printf("VIDC sound: %d channel(s), %dus/byte (%d Hz per channel), "
+                       "step %08x, trim %d ppm\r\n",
+                       sound_nch, sound_period, 1000000 / (sound_period * sound_nch),
+                       rs.step, rs.trim_ppm);
+        printf("VIDC sound: %d frames in, %d out, %d overflows, %d underruns, %d rate changes\r\n",
+               sound_stats.frames_in, sound_stats.frames_out, sound_stats.overflows,
+               sound_stats.underruns, sound_stats.rate_changes);
+}
+
+/******************************************************************************/
+
+#define BENCH_BYTES     1024
+
+/* Time the mixer over a fixed pseudo-random input, for each channel count.
+ * The output hash is a golden value, checked in sim/sound_test.c:  it must
+ * not change unless the conversion is meant to.
+ */
+void            vidc_sound_bench(void)
+{
+        static uint8_t in[BENCH_BYTES];
+        static uint32_t out[BENCH_BYTES];
+        static const uint8_t pos[VIDC_SOUND_SLOTS] = { 1, 2, 3, 4, 5, 6, 7, 0 };
+        uint32_t lfsr = 0xace1;
+
+        for (unsigned int i = 0; i < BENCH_BYTES; i++) {
+                lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xb400);
+                in[i] = lfsr;
+        }
+        vidc_sound_set_stereo(pos);
+
+#if PICO_ON_DEVICE
+        /* SysTick, from the processor clock; 24 bits, counting down */
+        systick_hw->rvr = 0x00ffffff;
+        systick_hw->csr = 0x5;
+#define BENCH_NOW()     (systick_hw->cvr)
+#else
+        /* Host build: microseconds, not cycles */
+#define BENCH_NOW()     (-time_us_32())
+#endif
+
+        for (unsigned int nch = 1; nch <= 8; nch <<= 1) {
+                uint32_t start = BENCH_NOW();
+                unsigned int frames = vidc_sound_mix(in, BENCH_BYTES, nch, out);
+                uint32_t cycles = (start - BENCH_NOW()) & 0x00ffffff;
+                uint32_t hash = 0x811c9dc5;
+
+                for (unsigned int i = 0; i < frames; i++) {
+                        hash ^= out[i];
+                        hash *= 0x01000193;
+                }
+                printf("%d ch: %d bytes -> %d frames, %d cycles (%d.%02d/byte), hash %08x\r\n",
+                       nch, BENCH_BYTES, frames, cycles,
+                       cycles / BENCH_BYTES, (cycles * 100 / BENCH_BYTES) % 100, hash);
+        }
+        vidc_sound_update_stereo();
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VIDC_SOUND_H
+#define VIDC_SOUND_H
+
+#include <stdint.h>
+
+/* VIDC sound data conversion.
+ *
+ * VIDC sound bytes are 8-bit logarithmic (sign in bit 0, a 3-bit chord in
+ * bits 7:5 and a 4-bit step in bits 4:1), output in turn through 8
+ * channel "slots", each with a stereo image position from the
+ * VIDC_STEREOx registers.  With n channels active (1, 2, 4 or 8), each
+ * group of n bytes is one sample period.
+ */
+
+#define VIDC_SOUND_SLOTS        8
+
+void            vidc_sound_init(void);
+/* Positions 1 (left) to 7 (right); 0 is treated as centre */
+void            vidc_sound_set_stereo(const uint8_t pos[VIDC_SOUND_SLOTS]);
+/* Update positions from the VIDC_STEREOx registers */
+void            vidc_sound_update_stereo(void);
+/* Linear value (+/-32124) of one log sample */
+int16_t         vidc_sound_linear(uint8_t s);
+/* Convert and mix nbytes of sound data (a multiple of 8) from nch channels
+ * into 16-bit stereo frames (R<<16 | L).  Returns the number of frames.
+ */
+unsigned int    vidc_sound_mix(const uint8_t *in, unsigned int nbytes, unsigned int nch,
+                               uint32_t *out);
+void            vidc_sound_bench(void);
+
+/* Captured sound bytes in; mixed, resampled to the audio output rate, and
+ * queued for output.  Follows changes to VIDC_SOUND_FREQ and the stereo
+ * registers.
+ */
+typedef struct {
+        unsigned int    frames_in;      /* Mixed, at the VIDC rate */
+        unsigned int    frames_out;     /* Resampled, queued to audio */
+        unsigned int    overflows;
+        unsigned int    underruns;
+        unsigned int    rate_changes;
+} vidc_sound_stats_t;
+
+void            vidc_sound_feed(const uint8_t *bytes, unsigned int n);
+void            vidc_sound_get_stats(vidc_sound_stats_t *s);
+void            vidc_sound_status(void);
+
+#endif
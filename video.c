@@ -34,17 +34,28 @@
 #include <unistd.h>
 #include <string.h>
 #include "pico/stdlib.h"
+#if PICO_ON_DEVICE
+#include "hardware/structs/systick.h"
+#endif
 
 #include "fpga.h"
+#include "regcache.h"
+#include "modestore.h"
+#include "pll.h"
+#include "edid.h"
+#include "dvo.h"
+#include "events.h"
 #include "vidc_regs.h"
 #include "video.h"
+#include "video_solve.h"
 #include "hw.h"
+#include "latency.h"
 
-#define VR(x)           fpga_read32(FPGA_VO(x))
-#define VW(x, val)      fpga_write32(FPGA_VO(x), val)
+#define VR(x)           regcache_read(FPGA_VO(x))
+#define VW(x, val)      regcache_write(FPGA_VO(x), val)
 
-#define CRR()           fpga_read32(FPGA_CTRL(CTRL_REG))
-#define CRW(val)        fpga_write32(FPGA_CTRL(CTRL_REG), val)
+#define CRR()           regcache_read(FPGA_CTRL(CTRL_REG))
+#define CRW(val)        regcache_write(FPGA_CTRL(CTRL_REG), val)
 
 
 typedef struct {
@@ -61,9 +72,15 @@ static const vidmode_timing_t modes[] = {
 	[VMODE_1280]  = { 1280, 16, 144, 248, 1024, 1, 3, 38, 20 },
 };
 
+
+static void     modecache_init(void);
+static void     video_probe(bool force);
+
 void    video_init()
 {
         int i;
+
+        modecache_init();
         /* Set up PLL */
         /* Assert logic reset & PLL reset: */
         CRW(CR_RESET);
@@ -86,85 +103,49 @@ void    video_init()
 void 	video_set_mode(vidmode_t m)
 {
 	const vidmode_timing_t *t = &modes[m];
-	video_pclk_mult(t->mult);
+	/* The transmitter wants the clock the PLL really gives, not the nominal one */
+	uint32_t pclk_khz = video_pclk_set(PLL_REF_KHZ * t->mult / 10);
 	video_set_x_timing(t->x, t->xfp, t->xsw, t->xbp, 10);
 	video_set_y_timing(t->y, t->yfp, t->ysw, t->ybp);
 	video_sync();
+
+	dvo_timing_t dt = {
+		.pclk_khz = pclk_khz,
+		.h_active = t->x, .h_fp = t->xfp, .h_sync = t->xsw, .h_bp = t->xbp,
+		.v_active = t->y, .v_fp = t->yfp, .v_sync = t->ysw, .v_bp = t->ybp,
+	};
+	dvo_set_timing(&dt);
 }
 
-/* Dynamically reconfigure the output pixel clock rate:
+/* PLL lock time accounting, from the start of reconfiguration: */
+static video_pll_stats_t pll_stats;
+/* PLL solutions for the clocks used so far, by video_solve() and here */
+static pll_memo_t       pll_memo;
+/* Config word currently in the PLL; 0 if unknown (e.g. from bitstream) */
+static uint32_t pll_cfg_loaded;
+
+#define PLL_LOCK_POLL_US        10
+#define PLL_LOCK_TIMEOUT_US     100000
+
+/* Shift a new configuration word into the PLL, and wait for it to lock.
  *
- * Parameter is multiplication factor times 10, i.e.
- * 10, 15, 20, 40 for the standard 1x, 1.5x, 2x, 4x rates.
+ * The config chain latches PLL_DATA at the rising edge of PLL_CLK.  Each
+ * CTRL_REG write is a whole SPI transaction (several microseconds), which
+ * is far longer than the PLL's setup/hold needs, so each bit is two
+ * back-to-back writes:  data with clock low, then data with clock high.
+ * The next bit's first write takes the clock low again.  The writes are
+ * queued and then fenced, rather than waiting for each one.
  */
-void     video_pclk_mult(unsigned int factor)
+static void     video_pll_load(uint32_t cfg)
 {
-#define RECONFIGURE_PLL_COEFFS yes
-#ifdef RECONFIGURE_PLL_COEFFS
         const int cfg_bits = 26;
-        uint32_t cfg = (1 << 25) | (0 << 23) | (1 << 22) | (0 << 19);
-
-        /* From Yosys's documentation, for ICE40HX the word consists of:
-         * [   25] FSEnet                               1 (Simple)
-         * [24:23] pllout1Sel                           0 (Genclk. doc'd 2 but only 0 works)
-         * [   22] Source Clock (0=Pad, 1=Fabric)       1 (fabric)
-         * [   21] ShiftReg[0]                          0 (Mode 0, not used)
-         * [20:19] pllout2Sel                           0 (Genclk, doc'd 2 but only 0 works)
-         * [18:17] delaymuxsel                          0 (Delay)
-         * [16:14] FILTER_RANGE
-         * [13:11] DIVQ
-         * [10: 4] DIVF
-         * [ 3: 0] DIVR
-         *
-         * MSB-first, at rising SCLK edge.
-         */
+        uint32_t start, locked;
 
-        /* Supported factors 1, 4.
-         * FIXME: calculate coefficients, rather than using potted
-         * values.
-         */
-        if (factor == 40) {
-                /* x4 */
-                cfg |= 0;               /* DIVR */
-                cfg |= 31 << 4;         /* DIVF */
-                cfg |= 3 << 11;         /* DIVQ */
-                cfg |= 2 << 14;         /* FILTER_RANGE */
-        } else if (factor == 20) {
-                cfg |= 0;               /* DIVR */
-                cfg |= 31 << 4;         /* DIVF */
-                cfg |= 4 << 11;         /* DIVQ */
-                cfg |= 2 << 14;         /* FILTER_RANGE */
-        } else if (factor == 15) {
-                cfg |= 0;               /* DIVR */
-                cfg |= 23 << 4;         /* DIVF */
-                cfg |= 4 << 11;         /* DIVQ */
-                cfg |= 2 << 14;         /* FILTER_RANGE */
-        } else if (factor == 10) {
-                /* x1 */
-                cfg |= 0;               /* DIVR */
-                cfg |= 31 << 4;         /* DIVF */
-                cfg |= 5 << 11;         /* DIVQ */
-                cfg |= 2 << 14;         /* FILTER_RANGE */
-	} else if (factor == 5) {
-                /* x0.5 */
-                cfg |= 0;               /* DIVR */
-                cfg |= 15 << 4;         /* DIVF */
-                cfg |= 5 << 11;         /* DIVQ */
-                cfg |= 4 << 14;         /* FILTER_RANGE */
-	} else {
-                if (factor != 4) {
-                        printf("*** Pclk multiplication factor %d not supported!\n",
-                               factor);
-                }
-                /* 4 = x0.38 (i.e. 24 from 62.5) */
-                cfg |= 3;               /* DIVR */
-                cfg |= 48 << 4;         /* DIVF */
-                cfg |= 5 << 11;         /* DIVQ */
-                cfg |= 1 << 14;         /* FILTER_RANGE */
+        if (cfg == pll_cfg_loaded && (CRR() & CR_PLL_LOCK)) {
+                pll_stats.skipped++;
+                return;
         }
 
-        printf("Setting PLL config %08x (mult factor %d.%d): real pclk %d MHz\r\n",
-               cfg, factor/10, factor % 10, 24*factor/10);
         /* Update PLL configuration:
          * 1. Hold video logic in RESET
          * 2. Assert PLL reset
@@ -173,64 +154,154 @@ void     video_pclk_mult(unsigned int factor)
          * 5. Wait for lock
          * 6. Release video logic RESET
          */
+        LAT_BEGIN(LAT_PLL_SHIFT);
+        start = time_us_32();
         CRW(CR_RESET | CR_PLL_NRESET);  /* Logic reset (while clock's still running) */
         sleep_us(10);
         CRW(CR_RESET);                  /* PLL reset also */
 
-        /* Clock and Data are 0 */
-        for (int i = 0; i < cfg_bits; i++) {
-                uint32_t x = CR_RESET;
-                if (cfg & (1 << (cfg_bits-1))) {
-                        x |= CR_PLL_DATA;
-                }
-                cfg <<= 1;
-                CRW(x);
-                sleep_us(100);                  /* Setüp */
-                CRW(x | CR_PLL_CLK);
-                sleep_us(100);                  /* Holdé */
-                CRW(x);
-                sleep_us(100);
+        /* MSB-first, at rising SCLK edge. */
+        for (int i = cfg_bits - 1; i >= 0; i--) {
+                uint32_t x[2];
+
+                x[0] = CR_RESET | ((cfg & (1 << i)) ? CR_PLL_DATA : 0);
+                x[1] = x[0] | CR_PLL_CLK;
+                fpga_xfer_submit(FPGA_CTRL(CTRL_REG), &x[0], 1, true, NULL, NULL);
+                fpga_xfer_submit(FPGA_CTRL(CTRL_REG), &x[1], 1, true, NULL, NULL);
         }
-        /* Release PLL reset */
+        fpga_xfer_fence();
+        /* Release PLL reset (and resync the CTRL_REG shadow) */
         CRW(CR_RESET | CR_PLL_NRESET);
-        sleep_ms(1);
+        LAT_END(LAT_PLL_SHIFT);
+        LAT_BEGIN(LAT_PLL_LOCK);
 
         /* Wait for lock */
-        int i;
-        for (i = 0; i < 1000; i++) {
+        do {
+                locked = time_us_32();
                 if (CRR() & CR_PLL_LOCK)
                         break;
-                sleep_ms(1);
-        }
-        if (i == 1000)
+                sleep_us(PLL_LOCK_POLL_US);
+        } while ((locked - start) < PLL_LOCK_TIMEOUT_US);
+
+        if (!(CRR() & CR_PLL_LOCK)) {
                 printf("*** WARNING *** PLL lock timeout (CR %08x)\r\n", CRR());
+                pll_stats.timeouts++;
+                pll_cfg_loaded = 0;
+        } else {
+                unsigned int us = locked - start;
+
+                LAT_END(LAT_PLL_LOCK);
+
+                if (pll_stats.loads == 0 || us < pll_stats.lock_min_us)
+                        pll_stats.lock_min_us = us;
+                if (us > pll_stats.lock_max_us)
+                        pll_stats.lock_max_us = us;
+                pll_stats.lock_total_us += us;
+                pll_stats.loads++;
+                pll_cfg_loaded = cfg;
+        }
         /* Release logic reset */
         CRW(CR_PLL_NRESET);
-#else
-        uint32_t f = (factor == 2) ? 0 : CR_PLL_BYPASS;
-        /* Cheap version: use bypass mux to get 1:1 or 1:4 */
-        CRW(CR_RESET | CR_PLL_NRESET);          /* Logic reset */
-        sleep_us(10);
-        CRW(f | CR_RESET | CR_PLL_NRESET);      /* Switch clock */
-        sleep_us(10);
-        CRW(f | CR_PLL_NRESET);                 /* Out of reset */
-#endif
 }
 
+void    video_pll_get_stats(video_pll_stats_t *s)
+{
+        *s = pll_stats;
+}
+
+void    video_pll_clear_stats(void)
+{
+        memset(&pll_stats, 0, sizeof(pll_stats));
+}
+
+/* Dynamically reconfigure the output pixel clock rate to the closest
+ * achievable to khz.  Returns the real rate, or 0 if the PLL can't get
+ * anywhere near it (the clock is left unchanged).
+ */
+uint32_t        video_pclk_set(uint32_t khz)
+{
+        pll_coeffs_t c;
+
+        if (!pll_lookup(&pll_memo, khz, &c)) {
+                printf("*** Pclk %d kHz not achievable!\r\n", khz);
+                return 0;
+        }
+        uint32_t cfg = pll_config_word(&c);
+        printf("Setting PLL config %08x (R%d F%d Q%d FR%d): real pclk %d.%03d MHz\r\n",
+               cfg, c.divr, c.divf, c.divq, c.filter,
+               c.fout_khz / 1000, c.fout_khz % 1000);
+        video_pll_load(cfg);
+        return c.fout_khz;
+}
+
+/* Parameter is multiplication factor (of the 24MHz VIDC clock) times 10,
+ * i.e. 10, 15, 20, 40 for the standard 1x, 1.5x, 2x, 4x rates.
+ */
+void     video_pclk_mult(unsigned int factor)
+{
+        video_pclk_set(PLL_REF_KHZ * factor / 10);
+}
+
+/* Output commit/sync accounting: */
+static video_commit_stats_t commit_stats;
+/* SPI traffic spent polling for the sync ack, which is open-ended */
+static fpga_spi_stats_t sync_poll_spi;
+
+static void     video_sync_poll_account(const fpga_spi_stats_t *start, unsigned int polls)
+{
+        fpga_spi_stats_t now;
+
+        fpga_spi_get_stats(&now);
+        sync_poll_spi.transactions += now.transactions - start->transactions;
+        sync_poll_spi.bytes += now.bytes - start->bytes;
+        commit_stats.sync_polls += polls;
+}
+
+/* The VIDO registers are double-buffered:  new values are taken at the
+ * next frame after a sync request, so the output never sees a partial
+ * update.
+ */
 void    video_sync(void)
 {
         uint32_t s = VR(VIDO_REG_SYNC);
         printf("Sync reg: %02x\r\nRequesting sync...", s);
+        uint32_t start = time_us_32();
+        LAT_BEGIN(LAT_SYNC);
         VW(VIDO_REG_SYNC, s ^ 1);
+        fpga_spi_stats_t spi_start;
         int t = 1000000;
+
+        fpga_spi_get_stats(&spi_start);
         do {
                 s = VR(VIDO_REG_SYNC);
                 if ((s & 1) == ((s >> 1) & 1)) {
-                        printf("Synchronised (new reg %02x)\r\n", s);
+                        unsigned int us = time_us_32() - start;
+
+                        LAT_END(LAT_SYNC);
+                        video_sync_poll_account(&spi_start, 1000000 - t + 1);
+                        printf("Synchronised (new reg %02x, %dus)\r\n", s, us);
+                        if (commit_stats.syncs == 0 || us < commit_stats.sync_min_us)
+                                commit_stats.sync_min_us = us;
+                        if (us > commit_stats.sync_max_us)
+                                commit_stats.sync_max_us = us;
+                        commit_stats.sync_total_us += us;
+                        commit_stats.syncs++;
                         return;
                 }
         } while (--t > 0);
+        video_sync_poll_account(&spi_start, 1000000);
         printf("Timeout :(  (reg %02x)\r\n", s);
+        commit_stats.sync_timeouts++;
+}
+
+void    video_commit_get_stats(video_commit_stats_t *st)
+{
+        *st = commit_stats;
+}
+
+void    video_commit_clear_stats(void)
+{
+        memset(&commit_stats, 0, sizeof(commit_stats));
 }
 
 void    video_wait_flybk(void)
@@ -241,6 +312,7 @@ void    video_wait_flybk(void)
          */
         uint32_t s;
 
+        LAT_BEGIN(LAT_FLYBACK);
         /* Wait for a 1 (might exit immediately): */
         do {
                 s = VR(VIDO_REG_SYNC);
@@ -250,274 +322,464 @@ void    video_wait_flybk(void)
         do {
                 s = VR(VIDO_REG_SYNC);
         } while (s & 0x10);
+        LAT_END(LAT_FLYBACK);
 }
 
-static int      video_guess_hires(unsigned int x, unsigned int y, unsigned int bpp,
-                                  unsigned int pclk)
+/* Non-blocking version: returns true if flyback has ended (1-to-0)
+ * since the last call.
+ */
+static bool     video_flybk_edge(void)
 {
-        /* Try to guess if this is a hires mode; a very tall high-clock 4BPP mode? */
-        return (pclk == 24) && (bpp == 2) && (x < (y/2));
+        static bool prev_flybk = false;
+        bool flybk = !!(VR(VIDO_REG_SYNC) & 0x10);
+        bool edge = prev_flybk && !flybk;
+
+        prev_flybk = flybk;
+        return edge;
 }
 
-void    video_probe_mode(bool force)
+/******************************************************************************/
+/* Reconfiguration debouncing
+ *
+ * RISC OS (and games) write HCR/VCR and the other timing registers over
+ * several accesses, possibly spread over a few frames, and each can raise
+ * a reconfig event.  Rather than probing (and reprogramming the PLL) on
+ * the first one, wait for the timing registers to be stable for
+ * settle_frames flybacks.  Further events in the meantime restart the
+ * count; settle_window bounds the total wait.
+ */
+
+static unsigned int     settle_frames = 2;
+static unsigned int     settle_window = 10;
+
+static struct {
+        bool            active;
+        unsigned int    frames;         /* Flybacks since first event */
+        unsigned int    stable;         /* Flybacks with unchanged signature */
+        uint32_t        sig;
+} settle;
+
+static unsigned int     settle_events;
+static unsigned int     settle_coalesced;       /* i.e. probes avoided */
+static unsigned int     settle_commits;
+
+void    video_reconfig_event(void)
 {
-        const unsigned int pix_rates[] = { 8, 12, 16, 24 };
+        settle_events++;
+        if (settle.active) {
+                settle_coalesced++;
+        } else {
+                settle.active = true;
+                settle.frames = 0;
+                LAT_BEGIN(LAT_MODE_CHANGE);
+                LAT_BEGIN(LAT_SETTLE);
+                settle.sig = vidc_timing_signature();
+                video_flybk_edge();             /* Resync edge detector */
+        }
+        settle.stable = 0;
+}
+
+bool    video_reconfig_pending(void)
+{
+        return settle.active;
+}
+
+void    video_reconfig_poll(void)
+{
+        if (!settle.active || !video_flybk_edge())
+                return;
+
+        settle.frames++;
+        /* The snapshot's only good until the next write; take another: */
+        regcache_invalidate_vidc();
+        uint32_t sig = vidc_timing_signature();
+
+        if (sig == settle.sig) {
+                settle.stable++;
+        } else {
+                settle.sig = sig;
+                settle.stable = 0;
+        }
+
+        if (settle.stable >= settle_frames || settle.frames >= settle_window) {
+                if (settle.stable < settle_frames)
+                        printf("*** VIDC still changing after %d frames, probing anyway\r\n",
+                               settle.frames);
+                settle.active = false;
+                settle_commits++;
+                LAT_END(LAT_SETTLE);
+                /* Just after a flyback, so no need to wait for another */
+                video_probe(false);
+        }
+}
+
+void    video_settle_config(unsigned int frames, unsigned int window)
+{
+        settle_frames = frames;
+        settle_window = window > frames ? window : frames + 1;
+}
+
+void    video_settle_dump(void)
+{
+        printf("Settle: %d stable frames, window %d frames\r\n"
+               "\t%d reconfig events, %d commits, %d coalesced (probes avoided)\r\n",
+               settle_frames, settle_window,
+               settle_events, settle_commits, settle_coalesced);
+}
+
+/******************************************************************************/
+/* Mode decision cache
+ *
+ * Deriving the output mode is deterministic given VIDC's timing/control
+ * registers, so keep the last few results, keyed on those.  Flipping
+ * between previously-seen modes (e.g. desktop/game) then goes straight
+ * to programming the output.
+ */
 
+#define MODECACHE_ENTRIES       8
+
+typedef struct {
+        bool            valid;
+        uint32_t        hash;
+        uint32_t        last_used;
+        vidc_timing_t   key;
+        video_mode_t    mode;
+} modecache_entry_t;
+
+static modecache_entry_t modecache[MODECACHE_ENTRIES];
+static uint32_t         modecache_clock;
+static unsigned int     modecache_hits;
+static unsigned int     modecache_misses;
+static uint32_t         modecache_lookup_cycles;
+
+static inline uint32_t  cycles_now(void)
+{
+#if PICO_ON_DEVICE
+        return systick_hw->cvr;         /* 24 bits, counting down */
+#else
+        return -time_us_32();           /* Host build: microseconds */
+#endif
+}
+
+static void     modecache_init(void)
+{
+#if PICO_ON_DEVICE
+        /* Free-running SysTick at the CPU clock, for measuring lookups: */
+        systick_hw->rvr = 0x00ffffff;
+        systick_hw->csr = 0x5;          /* Enable, processor clock */
+#endif
+        video_modecache_flush();
+}
+
+void    video_modecache_flush(void)
+{
+        for (int i = 0; i < MODECACHE_ENTRIES; i++)
+                modecache[i].valid = false;
+}
+
+static const video_mode_t *modecache_lookup(const vidc_timing_t *t)
+{
+        uint32_t start = cycles_now();
+        uint32_t hash = vidc_timing_hash(t);
+        const video_mode_t *m = NULL;
+
+        for (int i = 0; i < MODECACHE_ENTRIES; i++) {
+                modecache_entry_t *e = &modecache[i];
+
+                if (e->valid && e->hash == hash &&
+                    memcmp(&e->key, t, sizeof(*t)) == 0) {
+                        e->last_used = ++modecache_clock;
+                        m = &e->mode;
+                        break;
+                }
+        }
+        if (m)
+                modecache_hits++;
+        else
+                modecache_misses++;
+        modecache_lookup_cycles += (start - cycles_now()) & 0x00ffffff;
+        return m;
+}
+
+static void     modecache_insert(const vidc_timing_t *t, const video_mode_t *m)
+{
+        modecache_entry_t *victim = &modecache[0];
+
+        for (int i = 0; i < MODECACHE_ENTRIES; i++) {
+                modecache_entry_t *e = &modecache[i];
+
+                if (!e->valid) {
+                        victim = e;
+                        break;
+                }
+                if (e->last_used < victim->last_used)
+                        victim = e;
+        }
+        victim->valid = true;
+        victim->hash = vidc_timing_hash(t);
+        victim->last_used = ++modecache_clock;
+        victim->key = *t;
+        victim->mode = *m;
+}
+
+void    video_modecache_dump(void)
+{
+        unsigned int lookups = modecache_hits + modecache_misses;
+
+        printf("Mode cache: %d lookups, %d hits, %d misses",
+               lookups, modecache_hits, modecache_misses);
+        if (lookups)
+                printf(" (%d%% hit rate), avg %d cycles/lookup",
+                       modecache_hits * 100 / lookups,
+                       modecache_lookup_cycles / lookups);
+        printf("\r\n");
+
+        for (int i = 0; i < MODECACHE_ENTRIES; i++) {
+                modecache_entry_t *e = &modecache[i];
+
+                if (!e->valid)
+                        continue;
+                printf("  %d: hash %08x, %dx%d%s%s%s, pclk %d.%03d MHz\r\n",
+                       i, e->hash,
+                       e->mode.vido[VIDO_REG_RES_X] & 0x7ff,
+                       e->mode.vido[VIDO_REG_RES_Y] & 0x7ff,
+                       e->mode.dx ? ", X-doubled" : "",
+                       e->mode.dy ? ", Y-doubled" : "",
+                       e->mode.hires ? ", hires" : "",
+                       e->mode.pclk_khz / 1000, e->mode.pclk_khz % 1000);
+        }
+}
+
+/******************************************************************************/
+
+/* Describe how the solver got to the output mode */
+static void     video_solution_print(const video_solution_t *s, const edid_info_t *mon)
+{
+        const video_mode_t *m = &s->mode;
+        const uint32_t *v = m->vido;
+
+        if (s->flags & VSOLVE_F_HDER_ZERO)
+                printf("*** HDER was 0, hacking to +288\r\n");
+        printf("New mode %dx%d, %dbpp%s:\r\n"
+               "\thfp %d, hsw %d, hbp %d (%d total, hcr %d)\r\n"
+               "\tvfp %d, vsw %d, vbp %d (%d total, vcr %d, frame %dHz pclk %dMHz)\r\n",
+               s->in_xres, s->in_yres, 1 << s->in_bpp,
+               s->in_ext_pal ? ", extended palette" : "",
+               s->in_hfp, s->in_hsw, s->in_hbp,
+               s->in_xres + s->in_hfp + s->in_hsw + s->in_hbp, s->in_hcr,
+               s->in_vfp, s->in_vsw, s->in_vbp,
+               s->in_yres + s->in_vfp + s->in_vsw + s->in_vbp, s->in_vcr,
+               s->in_pix_mhz*1000000 / (s->in_hcr * s->in_vcr), s->in_pix_mhz);
+
+        switch (s->reason) {
+        case VSOLVE_HIRES:
+                printf("Guessed hires mono mode.\r\n");
+                break;
+        case VSOLVE_DOUBLED:
+                printf("*** Using pclk %d.%03dMHz: hcr %d, new_width %d, xres %d, min_h %d\r\n",
+                       m->pclk_khz / 1000, m->pclk_khz % 1000,
+                       s->in_hcr, s->line_width, v[VIDO_REG_RES_X] & 0x7ff, s->min_blanking);
+                printf("*** %s-doubled%s: new width %d, fp %d, xsw %d, bp %d\r\n",
+                       m->dx ? "XY" : "Y",
+                       (s->flags & VSOLVE_F_DTD_BLANKING) ? " (monitor's blanking)" : "",
+                       s->line_width, v[VIDO_REG_HS_FP], v[VIDO_REG_HS_WIDTH],
+                       v[VIDO_REG_HS_BP]);
+                break;
+        case VSOLVE_NO_DOUBLE:
+                printf("*** Giving up, can't line-double this mode! "
+                       "(%d MHz, needs output pclk %d kHz, width %d) ***\r\n",
+                       s->in_pix_mhz, s->need_khz, s->line_width);
+                break;
+        }
+        if (s->flags & VSOLVE_F_NO_PLL)
+                printf("*** No PLL config for %d kHz!\r\n", m->pclk_khz);
+        if (s->flags & VSOLVE_F_OUT_OF_RANGE)
+                printf("*** Mode (H %dkHz, V %dHz, pclk %dkHz) outside monitor's range "
+                       "(H %d-%dkHz, V %d-%dHz, pclk max %dkHz)\r\n",
+                       s->hfreq_khz, s->vfreq_hz, m->pclk_khz,
+                       mon->hmin_khz, mon->hmax_khz, mon->vmin_hz, mon->vmax_hz,
+                       mon->max_pclk_khz);
+}
+
+/* The commit stage:  program the output for a solved mode */
+static void     video_commit_mode(const video_mode_t *m)
+{
+        /* Apply user-configured config (e.g. visual style) */
+        unsigned int crtlook = !!(cfg_get() & CFG_SW1);
+
+        printf("Setting PLL config %08x: pclk %d.%03d MHz\r\n",
+               m->pll_cfg, m->pclk_khz / 1000, m->pclk_khz % 1000);
+        video_pll_load(m->pll_cfg);
+
+        /* Only the words that differ from what's in VIDO are written (with
+         * FPGA_SPI_BURST, in a burst either side of SYNC).  After a PLL
+         * reload, that's all of them, as the logic reset leaves VIDO
+         * unknown.  They take effect together, at the sync.
+         */
+        uint32_t vido[VIDO_REG_CTRL + 1];
+        const unsigned int words = VIDO_REG_CTRL;       /* Not SYNC */
+
+        memcpy(vido, m->vido, sizeof(vido));
+        if (crtlook)
+                vido[VIDO_REG_RES_Y] |= 0x40000000;
+        LAT_BEGIN(LAT_VIDO_WRITE);
+        unsigned int changed;
+        unsigned int written = regcache_write_changed(FPGA_VO(0), vido, VIDO_REG_CTRL + 1,
+                                                      &changed);
+        LAT_END(LAT_VIDO_WRITE);
+
+        commit_stats.commits++;
+        commit_stats.words_changed += changed;
+        commit_stats.words_written += written;
+        commit_stats.words_saved += words - changed;
+        printf("VIDO: %d of %d words changed, %d written\r\n", changed, words, written);
+
+        video_sync();
+
+        /* Some transmitters need to know the timing, too: */
+        dvo_timing_t dt = {
+                .pclk_khz = m->pclk_khz,
+                .h_active = m->vido[VIDO_REG_RES_X] & 0x7ff,
+                .h_fp = m->vido[VIDO_REG_HS_FP],
+                .h_sync = m->vido[VIDO_REG_HS_WIDTH],
+                .h_bp = m->vido[VIDO_REG_HS_BP],
+                .v_active = m->vido[VIDO_REG_RES_Y] & 0x7ff,
+                .v_fp = m->vido[VIDO_REG_VS_FP],
+                .v_sync = m->vido[VIDO_REG_VS_WIDTH],
+                .v_bp = m->vido[VIDO_REG_VS_BP],
+        };
+        LAT_BEGIN(LAT_DVO);
+        dvo_set_timing(&dt);
+        LAT_END(LAT_DVO);
+}
+
+/* The mode currently programmed: */
+static video_mode_t     cur_mode;
+static bool             cur_valid = false;
+
+/* The last probed mode, until it's in the mode store: */
+static uint32_t         save_edid;
+static vidc_timing_t    save_key;
+static video_mode_t     save_mode;
+
+void    video_probe_mode(bool force)
+{
         video_wait_flybk();
+        video_probe(force);
+}
+
+/* Probe and (if it's changed, or forced) program the mode; call just
+ * after a flyback
+ */
+static void     video_probe(bool force)
+{
+        fpga_spi_stats_t spi_start, spi_end, poll_start;
+        vidc_timing_t t;
+        const video_mode_t *cached;
+        video_mode_t m;
+
+        /* Count register traffic from here, less the sync ack polling
+         * (that and flyback polling are open-ended, so are counted apart)
+         */
+        fpga_spi_get_stats(&spi_start);
+        poll_start = sync_poll_spi;
 
         uint32_t cfg_sw = cfg_get();
         printf("CR = %08x, ID = %08x, config = %08x\r\n",
-               fpga_read32(FPGA_CTRL(CTRL_REG)),
-               fpga_read32(FPGA_CTRL(CTRL_ID)),
+               CRR(),
+               regcache_read(FPGA_CTRL(CTRL_ID)),
                cfg_sw);
 
-        static unsigned int prev_xres = ~0;
-        static unsigned int prev_yres = ~0;
-        static unsigned int prev_ext_pal = ~0;
-        static unsigned int prev_xfp = ~0;
-        static unsigned int prev_xsw = ~0;
-        static unsigned int prev_xbp = ~0;
-        static unsigned int prev_yfp = ~0;
-        static unsigned int prev_ysw = ~0;
-        static unsigned int prev_ybp = ~0;
-        static unsigned int prev_wpl = ~0;
-
-        /* fp is dispend to frame (sync start); bo is dispstart-syncwidth */
-        unsigned int cr = vidc_reg(VIDC_CONTROL);
-        unsigned int ext_pal = !!(cr & (1 << 23));
-        unsigned int ext_bpp = !!(cr & (1 << 22));      /* 16BPP */
-        unsigned int bpp = (cr >> 2) & 3;
-        unsigned int pix_rate = pix_rates[(cr & 3)];
-        unsigned int hcr = ((vidc_reg(VIDC_H_CYC) >> 14)*2)+2;
-        unsigned int hsw = ((vidc_reg(VIDC_H_SYNC) >> 14)*2)+2;
-        unsigned int hdsr = ((vidc_reg(VIDC_H_DISP_START) >> 14)*2) +
-                vidc_bpp_to_hdsr_offset(bpp);
-        unsigned int hder = ((vidc_reg(VIDC_H_DISP_END) >> 14)*2) +
-                vidc_bpp_to_hdsr_offset(bpp);
-        unsigned int vcr = (vidc_reg(VIDC_V_CYC) >> 14)+1;
-        unsigned int vsw = (vidc_reg(VIDC_V_SYNC) >> 14)+1;
-        unsigned int vdsr = (vidc_reg(VIDC_V_DISP_START) >> 14)+1;
-        unsigned int vder = (vidc_reg(VIDC_V_DISP_END) >> 14)+1;
-
-        /* Note: hder observed to be zero ... when RISCiX programs a high-res mode.
-         */
-        if (hder == 0) {        /* HACK!!! */
-                hder = hdsr + 288;
-                printf("*** HDER was 0, hacking to +288\r\n");
-        }
+        vidc_get_timing(&t);
 
-        unsigned int xres = hder - hdsr;
-        unsigned int yres = vder - vdsr;
-        unsigned int xfp = hcr - hder;
-        unsigned int xsw = hsw;
-        unsigned int xbp = hdsr - hsw;
-        unsigned int yfp = vcr - vder;
-        unsigned int ysw = vsw;
-        unsigned int ybp = vdsr - vsw;
-        unsigned int wpl = (xres/(32>>bpp))-1;
-        unsigned int cx = hdsr - 6;
-        unsigned int hires = 0;
-        unsigned int dx = 0, dy = 0;
-
-        if (ext_bpp) {
-                /* There's a trick (AKA hack) here.  For 16BPP modes, the VIDC is told
-                 * that the mode is 8BPP and horiz resolution X, whereas the output is really
-                 * 16BPP with horiz resolution X/2.
-                 */
-                bpp = 4;
-                xres /= 2;
-                hcr /= 2;
-                xfp /= 2;
-                xsw /= 2;
-                xbp = hcr - xfp - xsw - xres;
-                pix_rate /= 2;
+        LAT_BEGIN(LAT_SOLVE);
+        cached = modecache_lookup(&t);
+        if (cached) {
+                m = *cached;
+                printf("Cached mode %dx%d%s%s%s\r\n",
+                       m.vido[VIDO_REG_RES_X] & 0x7ff, m.vido[VIDO_REG_RES_Y] & 0x7ff,
+                       m.dx ? ", X-doubled" : "", m.dy ? ", Y-doubled" : "",
+                       m.hires ? ", hires" : "");
+        } else {
+                const edid_info_t *mon = edid_get();
+                video_solution_t s;
+
+                video_solve(&t, mon, &pll_memo, &s);
+                video_solution_print(&s, mon);
+                m = s.mode;
+                modecache_insert(&t, &m);
         }
+        LAT_END(LAT_SOLVE);
 
-        if (force || xres != prev_xres || yres != prev_yres ||
-            xfp != prev_xfp || xsw != prev_xsw || xbp != prev_xbp ||
-            yfp != prev_yfp || ysw != prev_ysw || ybp != prev_ybp ||
-            ext_pal != prev_ext_pal || wpl != prev_wpl) {
-                printf("New mode %dx%d, %dbpp%s:\r\n"
-                       "\thfp %d, hsw %d, hbp %d (%d total, hcr %d)\r\n"
-                       "\tvfp %d, vsw %d, vbp %d (%d total, vcr %d, frame %dHz pclk %dMHz)\r\n",
-                       xres, yres, 1 << bpp, ext_pal ? ", extended palette" : "",
-                       xfp, xsw, xbp, xres + xfp + xsw + xbp, hcr,
-                       yfp, ysw, ybp, yres + yfp + ysw + ybp, vcr,
-                       pix_rate*1000000 / (hcr * vcr), pix_rate);
-
-                prev_xres = xres;
-                prev_yres = yres;
-                prev_ext_pal = ext_pal;
-                prev_xfp = xfp;
-                prev_xsw = xsw;
-                prev_xbp = xbp;
-                prev_yfp = yfp;
-                prev_ysw = ysw;
-                prev_ybp = ybp;
-                prev_wpl = wpl;
-        } else {
+        if (!force && cur_valid && memcmp(&m, &cur_mode, sizeof(m)) == 0) {
                 /* Don't reprogram the video output unless we're really doing something different,
                  * because the monitor will spend a second or two to regain sync and
                  * bootup messages will be missed.
                  */
-                printf("Config changed, but equals existing mode %dx%d, %dbpp%s:\r\n"
-                       "\thfp %d, hsw %d, hbp %d (%d total)\r\n"
-                       "\tvfp %d, vsw %d, vbp %d (%d total, frame %dHz pclk %dMHz)\r\n\r\n",
-                       xres, yres, 1 << bpp, ext_pal ? ", extended palette" : "",
-                       xfp, xsw, xbp, xres + xfp + xsw + xbp,
-                       yfp, ysw, ybp, yres + yfp + ysw + ybp,
-                       pix_rate*1000000 / (hcr * vcr), pix_rate);
+                printf("Config changed, but equals existing mode %dx%d\r\n\r\n",
+                       m.vido[VIDO_REG_RES_X] & 0x7ff, m.vido[VIDO_REG_RES_Y] & 0x7ff);
+                /* Not a mode change after all */
+                LAT_CANCEL(LAT_MODE_CHANGE);
                 return;
         }
 
-        /* Now, some dumb heuristics to try to program a matching output mode:
-         * 1. Is it a highres mode?
-         * 2. Is it a regular VGA/mode21-like mode?
-         * 3. Otherwise, something needs doubling.
+        video_commit_mode(&m);
+        LAT_END(LAT_MODE_CHANGE);
+        cur_mode = m;
+        cur_valid = true;
+
+        /* Writing flash stalls both cores, so it's left to the main loop,
+         * once VIDC's settled (see video_save_mode()):
          */
+        save_edid = edid_info_hash(edid_get());
+        save_key = t;
+        save_mode = m;
+        event_post(EVT_MODE_SAVE);
 
-        if (video_guess_hires(xres, yres, bpp, pix_rate)) {
-                /* Not totally infallible, but definitely works for mode 23 ;-)
-                 * Hopefully this will work for x900 variants.
-                 */
-                printf("Guessed hires mono mode.\r\n");
+        fpga_spi_get_stats(&spi_end);
+        unsigned int poll_xfers = sync_poll_spi.transactions - poll_start.transactions;
+        unsigned int poll_bytes = sync_poll_spi.bytes - poll_start.bytes;
 
-                xres *= 4;
-                /* ArcDVI can do a 96MHz pixel clock, so output VIDC/RISC OS timings
-                 * directly.  Whether your monitor likes 'em is another matter, as they're
-                 * not quite VESA, but "works for me".
-                 */
-                xfp *= 4;
-                xsw *= 4;
-                xbp *= 4;
-
-                /* Vertical timing stays the same. */
-                hires = 1;
-                bpp = 0;
-                wpl = (xres/32)-1;
-
-                cx = 0x12c; /* FIXME: derive this from ... something! ;( */
-
-                video_pclk_mult(40); /* 24*4=96MHz */
-
-        } else if (xres >= 640 && yres >= 480) {
-                /* Use VIDC timing directly */
-
-                video_pclk_mult(10);
-
-        } else if (yres < 480) {
-                /* We'll want some Y doublin'.  Slightly more complicated now,
-                 * because we need to recalculate the horiz timing to fit a 24MHz*X pclk
-                 * instead of the input one.  Specifically, we output the line twice
-                 * but need to keep the same vertical timing, which means we need to output
-                 * it twice as fast horizontally.  This is done by changing the blanking time,
-                 * and increasing the pixel clock "up one gear" if a lower clock won't fit.
-                 *
-                 * Not all modes can simply be doubled:
-                 * - Maybe the mode is already using a 24MHz pclk (e.g. mode 37),
-                 *   meaning we can't output the input line at 2x the rate
-                 * - Or, the mode is <24 (e.g. 16MHz) but so wide that we can't output
-                 *   enough pixels at 24MHz to keep within the line period.
-                 *
-                 * We attempt to resolve this by testing at increasing output
-                 * pixel clock rates; first 1x (24MHz), then 1.5x (36MHz), then 2x (48MHz).
-                 * Most modes (including the wide ones) fit this method.
-                 *
-                 * Some modes will end up a weird geometry (mode 37 would be 896x704)
-                 * which monitors may still not like.  FIXME:  Possible to add borders
-                 * and/or stretch DE to accommodate these.
-                 *
-                 * The fallback is outputting the mode non-doubled, which will likely
-                 * not work (monitors/TVs seem to like 400-ish lines at a minimum).
-                 *
-                 */
-                const int out_clk_rates[] = {24, 36, 48};
+        printf("FPGA SPI for mode change: %d transactions, %d bytes "
+               "(+%d transactions, %d bytes polling for sync)\r\n",
+               spi_end.transactions - spi_start.transactions - poll_xfers,
+               spi_end.bytes - spi_start.bytes - poll_bytes,
+               poll_xfers, poll_bytes);
 
-                if (xres < 640) {
-                        /* We want _both_ X and Y doubling. */
-                        dx = 1;
-                        xres *= 2;
-                }
+        printf("\r\n");
+}
 
-                unsigned int pclk = 0;
-                unsigned int new_total_width = 0;
-                for (int i = 0; i < 3; i++) {
-                        pclk = out_clk_rates[i];
-                        /* We need exactly 1/2 of the original line period, but with a
-                         * new clock:
-                         */
-                        new_total_width = hcr*pclk/pix_rate/2;
-
-                        /* Being too skimpy on H-blank time upsets many monitors, so
-                         * refuse to go into such a mode:
-                         */
-                        const unsigned int minimum_h_blanking = xres / 32; /* Art not science */
-
-                        if (new_total_width < (xres + minimum_h_blanking)) {
-                                printf("*** Can't line-double this mode with %dMHz pclk "
-                                       "(%d MHz, width %d (min %d), trying next clock.\r\n",
-                                       pclk, pix_rate, new_total_width, xres + minimum_h_blanking);
-
-                                if (pclk == 48) {
-                                        printf("*** Giving up, can't line-double this mode! "
-                                               "(%d MHz, output pclk %d MHz, width %d (min %d) ***\r\n",
-                                               pix_rate, pclk, new_total_width, xres + minimum_h_blanking);
-                                        /* Fall through, and set this mode verbatim, maybe
-                                         * the display can cope with it directly.
-                                         */
-                                        pclk = 0;
-                                        break;
-                                }
-                                /* Else loop, and try the next one up */
-                        } else {
-                                /* This pclk rate works for us. */
-                                printf("*** Using pclk %dMHz: hcr %d, new_width %d, xres %d, min_h %d\r\n",
-                                       pclk, hcr, new_total_width, xres, minimum_h_blanking);
-                                break;
-                        }
-                }
+/* From the main loop, on EVT_MODE_SAVE, once VIDC's settled */
+void    video_save_mode(void)
+{
+        modestore_save(save_edid, &save_key, &save_mode);
+}
 
-                if (pclk != 0) {
-                        yres *= 2;
-                        yfp *= 2;
-                        ysw *= 2;
-                        ybp *= 2;
-
-                        /* Synthesise new sync parameters using roughly a 2:1:4 ratio: */
-                        xfp = new_total_width / 20;
-                        xsw = new_total_width / 40;
-                        xbp = new_total_width-xres-xfp-xsw;
-
-                        printf("*** %s-doubled: new width %d, fp %d, xsw %d, bp %d\r\n",
-                               dx ? "XY" : "Y",
-                               new_total_width, xfp, xsw, xbp);
-                        dy = 1;
-                        video_pclk_mult(10*pclk/24);
-                } else {
-                        dx = 0;
-                        /* Give-up case, outputing mode 1:1 */
-                        video_pclk_mult(10);
-                }
-        }
+static void     modecache_seed(const vidc_timing_t *key, const video_mode_t *m)
+{
+        modecache_insert(key, m);
+}
 
-        /* Apply user-configured config (e.g. visual style) */
-        unsigned int crtlook = !!(cfg_sw & CFG_SW1);
-
-        VW(VIDO_REG_RES_X, xres | (dx ? 0x80000000 : 0));
-        VW(VIDO_REG_HS_FP, xfp);
-        VW(VIDO_REG_HS_WIDTH, xsw);
-        VW(VIDO_REG_HS_BP, xbp);
-        VW(VIDO_REG_RES_Y, yres | (dy ? 0x80000000 : 0) | (crtlook ? 0x40000000 : 0));
-        VW(VIDO_REG_VS_FP, yfp);
-        VW(VIDO_REG_VS_WIDTH, ysw);
-        VW(VIDO_REG_VS_BP, ybp);
-        VW(VIDO_REG_WPLM1, wpl);
-        VW(VIDO_REG_CTRL, cx | (hires ? 0x80000000 : 0) | (bpp << 28) |
-           (ext_pal ? 0x08000000 : 0));
+/* At boot, program the last-used mode straight away, before VIDC has been
+ * set up, so the monitor can sync while the Arc boots (rather than after,
+ * missing the bootup messages).  If VIDC ends up in that mode, it isn't
+ * reprogrammed.  The other stored modes seed the decision cache.
+ */
+void    video_restore_mode(void)
+{
+        vidc_timing_t key;
+        video_mode_t m;
+        uint32_t edid_hash = edid_info_hash(edid_get());
 
-        video_sync();
+        modestore_foreach(edid_hash, modecache_seed);
+        if (!modestore_last(edid_hash, &key, &m))
+                return;
 
-        printf("\r\n");
+        printf("Restoring last mode %dx%d\r\n",
+               m.vido[VIDO_REG_RES_X] & 0x7ff, m.vido[VIDO_REG_RES_Y] & 0x7ff);
+        video_commit_mode(&m);
+        cur_mode = m;
+        cur_valid = true;
 }
 
 void    video_dump_timing_regs(void)
@@ -557,7 +819,7 @@ void    video_set_y_timing(unsigned int yres, unsigned int fp, unsigned int sw,
 
 void    video_set_cursor_x(unsigned int offset)
 {
-        VW(VIDO_REG_CTRL, (VR(VIDO_REG_CTRL) & ~0x7ff) | (offset & 0x7ff));
+        regcache_modify(FPGA_VO(VIDO_REG_CTRL), 0x7ff, offset & 0x7ff);
 }
 
 void    video_set_ctrl(unsigned int ctrl)
@@ -25,6 +25,9 @@
 #ifndef VIDEO_H
 #define VIDEO_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 /* Video output register interface: */
 #define VIDO_REG_RES_X          0
 /* 31           double_x        0 = regular pixels, 1 = display x pixels twice
@@ -70,6 +73,38 @@
  * 10:0         Cursor X offset
  */
 
+/* A fully-resolved output mode, as programmed into VIDO and the PLL: */
+typedef struct {
+        uint32_t        vido[VIDO_REG_CTRL + 1];        /* [VIDO_REG_SYNC] unused */
+        uint32_t        pclk_khz;
+        uint32_t        pll_cfg;                        /* PLL config word */
+        uint8_t         dx, dy, hires;
+} video_mode_t;
+
+/* PLL reconfiguration accounting */
+typedef struct {
+        unsigned int    loads;          /* Reconfigured and locked */
+        unsigned int    skipped;        /* Config already loaded */
+        unsigned int    timeouts;
+        unsigned int    lock_min_us;    /* Start of reconfig to lock */
+        unsigned int    lock_max_us;
+        unsigned int    lock_total_us;
+} video_pll_stats_t;
+
+/* Output register commit accounting */
+typedef struct {
+        unsigned int    commits;
+        unsigned int    words_changed;
+        unsigned int    words_written;  /* On the wire (bursts may bridge gaps) */
+        unsigned int    words_saved;    /* Unchanged */
+        unsigned int    syncs;
+        unsigned int    sync_timeouts;
+        unsigned int    sync_polls;     /* SYNC reads waiting for the ack */
+        unsigned int    sync_min_us;    /* Sync request to ack */
+        unsigned int    sync_max_us;
+        unsigned int    sync_total_us;
+} video_commit_stats_t;
+
 /* Test video modes (for test FPGA) */
 typedef enum {
 	VMODE_VGA73 = 0,
@@ -82,6 +117,17 @@ typedef enum {
 void    video_init(void);
 void    video_sync(void);
 void    video_probe_mode(bool force);
+/* Debounced probing, for VIDC reconfig events: */
+void    video_reconfig_event(void);
+bool    video_reconfig_pending(void);
+void    video_reconfig_poll(void);
+void    video_settle_config(unsigned int frames, unsigned int window);
+void    video_settle_dump(void);
+void    video_restore_mode(void);
+/* Record the last probed mode in the mode store */
+void    video_save_mode(void);
+void    video_modecache_flush(void);
+void    video_modecache_dump(void);
 void	video_set_mode(vidmode_t m);
 void    video_dump_timing_regs(void);
 void    video_set_x_timing(unsigned int xres, unsigned int fp, unsigned int sw,
@@ -91,6 +137,11 @@ void    video_set_y_timing(unsigned int yres, unsigned int fp, unsigned int sw,
 void    video_set_cursor_x(unsigned int offset);
 void    video_set_ctrl(unsigned int ctrl);
 void    video_pclk_mult(unsigned int factor);
+uint32_t video_pclk_set(uint32_t khz);
+void    video_pll_get_stats(video_pll_stats_t *s);
+void    video_pll_clear_stats(void);
+void    video_commit_get_stats(video_commit_stats_t *s);
+void    video_commit_clear_stats(void);
 
 #endif
 
@@ -0,0 +1,159 @@
+/* ArcDVI: core 1 main loop dispatch
+ *
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#if PICO_ON_DEVICE
+#include "hardware/gpio.h"
+#endif
+
+#include "hw.h"
+#include "fpga.h"
+#include "regcache.h"
+#include "vidc_regs.h"
+#include "dvo.h"
+#include "edid.h"
+#include "events.h"
+#include "commands.h"
+#include "capture.h"
+#include "vid_i2c.h"
+#include "video.h"
+#include "video_loop.h"
+
+extern uint8_t flag_autoprobe_mode;
+extern uint8_t flag_test_mode;
+extern uint8_t flag_irq_mode;
+
+/* Returns true if a reconfiguration was seen */
+static bool     vidc_config_poll(void)
+{
+        uint32_t s = fpga_read32(FPGA_VO(VIDO_REG_SYNC));
+
+        int status = !!(s & 8);
+        int ack = !!(s & 4);
+
+        if (status != ack) {
+                // FIXME: Delay a frame or so, so that all writes have Probably Happened
+                printf("<VIDC RECONFIG %08x>\r\n", s);
+                regcache_invalidate_vidc();
+                fpga_write32(FPGA_VO(VIDO_REG_SYNC), s ^ 4); // Flip ack, enables further detection.
+
+                /* Writes are likely still in progress; probe once they've settled */
+                if (flag_autoprobe_mode)
+                        video_reconfig_event();
+                return true;
+        }
+        return false;
+}
+
+/* When the transmitter's IRQ fired, for measuring replug-to-picture time */
+static volatile uint32_t dvo_irq_time;
+
+void    video_loop_dvo_irq(void)
+{
+        dvo_irq_time = time_us_32();
+        event_post(EVT_DVO_IRQ);
+}
+
+#if PICO_ON_DEVICE
+#define FPGA_IRQ_LEVEL()        gpio_get(MCU_FPGA_IRQ)
+#else
+/* The simulator re-posts the event itself whilst its IRQ's still set */
+#define FPGA_IRQ_LEVEL()        false
+#endif
+
+static void     dvo_irq_service(void)
+{
+        if (dvo_service_irq(dvo_irq_time) == DVO_HPD_PLUG) {
+                /* Picture's back; now check whether it's a different
+                 * monitor, which might want a different mode.  The EDID
+                 * takes a while to arrive over DDC, so that's done in the
+                 * background (see edid_service()):
+                 */
+                edid_fetch();
+        }
+#if PICO_ON_DEVICE
+        /* Also a level; catch anything that arrived whilst servicing: */
+        if (!gpio_get(MCU_VID_IRQ))
+                video_loop_dvo_irq();
+#endif
+}
+
+static void     edid_service(void)
+{
+        if (edid_fetched() && flag_autoprobe_mode && !flag_test_mode)
+                video_probe_mode(true);
+}
+
+/* In IRQ mode, this sleeps until there's something to do; in poll mode,
+ * it hot-spins polling the VIDC reconfig status over SPI.
+ */
+void    video_loop_dispatch(void)
+{
+        if (event_take(EVT_CLI_CMD))
+                cmd_service();
+        if (event_take(EVT_CAPTURE))
+                capture_poll();
+        if (event_take(EVT_VID_I2C))
+                vid_i2c_poll();
+        if (event_take(EVT_DVO_IRQ))
+                dvo_irq_service();
+        if (event_take(EVT_EDID))
+                edid_service();
+        /* The fallback poll's timer wakes the loop often enough for this: */
+        dvo_edid_poll();
+        /* A flash write stalls both cores, so not whilst VIDC's
+         * changing (the event waits until it's settled):
+         */
+        if (!video_reconfig_pending() && !(event_pending() & EVT_VIDC_RECONFIG) &&
+            event_take(EVT_MODE_SAVE))
+                video_save_mode();
+
+        if (flag_test_mode) {
+                event_take(EVT_VIDC_RECONFIG | EVT_VIDC_POLL);
+                event_wait();
+                return;
+        }
+
+        if (!flag_irq_mode) {
+                event_take(EVT_VIDC_RECONFIG | EVT_VIDC_POLL);
+                vidc_config_poll();
+                video_reconfig_poll();
+        } else if (video_reconfig_pending()) {
+                /* Counting flybacks, so can't sleep: */
+                if (event_take(EVT_VIDC_RECONFIG | EVT_VIDC_POLL))
+                        vidc_config_poll();
+                video_reconfig_poll();
+        } else if (event_take(EVT_VIDC_RECONFIG | EVT_VIDC_POLL)) {
+                /* The IRQ is a level, so if VIDC was written again
+                 * whilst dealing with it there won't be another edge:
+                 */
+                if (vidc_config_poll() && FPGA_IRQ_LEVEL())
+                        event_post(EVT_VIDC_RECONFIG);
+        } else {
+                event_wait();
+        }
+}
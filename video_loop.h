@@ -0,0 +1,43 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef VIDEO_LOOP_H
+#define VIDEO_LOOP_H
+
+#include <stdint.h>
+
+/* Core 1's main loop, a pass at a time:  handles whichever events are
+ * pending (console commands, capture, transmitter I2C and IRQ, EDID
+ * fetches, mode saves, VIDC reconfig/fallback polls), or sleeps until
+ * one's posted.
+ * video_core_main() calls it forever; sim/events_test.c calls it with
+ * faked handlers.
+ */
+void    video_loop_dispatch(void);
+
+/* From the transmitter's IRQ:  notes the time, and posts EVT_DVO_IRQ */
+void    video_loop_dvo_irq(void);
+
+#endif
@@ -0,0 +1,322 @@
+/* video_solve: output mode solver
+ *
+ * Copyright 2021-2022 Matt Evans
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "video_solve.h"
+
+/* Output pixel clock range for line-doubled modes */
+#define DOUBLED_PCLK_MIN_KHZ    24000
+#define DOUBLED_PCLK_MAX_KHZ    48000
+
+static const char *reasons[] = {
+        [VSOLVE_DIRECT]         = "direct",
+        [VSOLVE_NARROW]         = "narrow, direct",
+        [VSOLVE_HIRES]          = "hires mono",
+        [VSOLVE_DOUBLED]        = "line-doubled",
+        [VSOLVE_NO_DOUBLE]      = "can't line-double, direct",
+};
+
+const char     *video_solve_reason(unsigned int reason)
+{
+        return reason < sizeof(reasons)/sizeof(reasons[0]) ? reasons[reason] : "?";
+}
+
+static int      video_guess_hires(unsigned int x, unsigned int y, unsigned int bpp,
+                                  unsigned int pclk)
+{
+        /* Try to guess if this is a hires mode; a very tall high-clock 4BPP mode? */
+        return (pclk == 24) && (bpp == 2) && (x < (y/2));
+}
+
+/* Output line/frame rates, and whether they're in the monitor's range */
+static void     video_solve_range(const edid_info_t *mon, video_solution_t *s)
+{
+        const uint32_t *v = s->mode.vido;
+        uint32_t htotal = (v[VIDO_REG_RES_X] & 0x7ff) + v[VIDO_REG_HS_FP] +
+                v[VIDO_REG_HS_WIDTH] + v[VIDO_REG_HS_BP];
+        uint32_t vtotal = (v[VIDO_REG_RES_Y] & 0x7ff) + v[VIDO_REG_VS_FP] +
+                v[VIDO_REG_VS_WIDTH] + v[VIDO_REG_VS_BP];
+
+        if (htotal == 0 || vtotal == 0)
+                return;
+
+        s->hfreq_khz = s->mode.pclk_khz / htotal;
+        s->vfreq_hz = (s->mode.pclk_khz * 1000) / (htotal * vtotal);
+
+        if (mon && mon->has_range &&
+            (s->hfreq_khz < mon->hmin_khz || s->hfreq_khz > mon->hmax_khz ||
+             s->vfreq_hz < mon->vmin_hz || s->vfreq_hz > mon->vmax_hz ||
+             (mon->max_pclk_khz && s->mode.pclk_khz > mon->max_pclk_khz)))
+                s->flags |= VSOLVE_F_OUT_OF_RANGE;
+}
+
+void    video_solve(const vidc_timing_t *t, const edid_info_t *mon, pll_memo_t *memo,
+                    video_solution_t *s)
+{
+        const unsigned int pix_rates[] = { 8, 12, 16, 24 };
+
+        /* fp is dispend to frame (sync start); bo is dispstart-syncwidth */
+        unsigned int cr = t->control;
+        unsigned int ext_pal = !!(cr & (1 << 23));
+        unsigned int ext_bpp = !!(cr & (1 << 22));      /* 16BPP */
+        unsigned int bpp = (cr >> 2) & 3;
+        unsigned int pix_rate = pix_rates[(cr & 3)];
+        unsigned int hcr = ((t->h_cyc >> 14)*2)+2;
+        unsigned int hsw = ((t->h_sync >> 14)*2)+2;
+        unsigned int hdsr = ((t->h_disp_start >> 14)*2) +
+                (unsigned int)vidc_bpp_to_hdsr_offset((int)bpp);
+        unsigned int hder = ((t->h_disp_end >> 14)*2) +
+                (unsigned int)vidc_bpp_to_hdsr_offset((int)bpp);
+        unsigned int vcr = (t->v_cyc >> 14)+1;
+        unsigned int vsw = (t->v_sync >> 14)+1;
+        unsigned int vdsr = (t->v_disp_start >> 14)+1;
+        unsigned int vder = (t->v_disp_end >> 14)+1;
+        video_mode_t *m = &s->mode;
+
+        pll_coeffs_t pll;
+
+        memset(s, 0, sizeof(*s));
+        /* Output 1:1 unless the heuristics below say otherwise */
+        m->pclk_khz = PLL_REF_KHZ;
+
+        /* Note: hder observed to be zero ... when RISCiX programs a high-res mode.
+         * (That's the register; hder itself always has the bpp offset added.)
+         */
+        if ((t->h_disp_end >> 14) == 0) {       /* HACK!!! */
+                hder = hdsr + 288;
+                s->flags |= VSOLVE_F_HDER_ZERO;
+        }
+
+        unsigned int xres = hder - hdsr;
+        unsigned int yres = vder - vdsr;
+        unsigned int xfp = hcr - hder;
+        unsigned int xsw = hsw;
+        unsigned int xbp = hdsr - hsw;
+        unsigned int yfp = vcr - vder;
+        unsigned int ysw = vsw;
+        unsigned int ybp = vdsr - vsw;
+        unsigned int wpl = (xres/(32>>bpp))-1;
+        unsigned int cx = hdsr - 6;
+        unsigned int hires = 0;
+        unsigned int dx = 0, dy = 0;
+
+        if (ext_bpp) {
+                /* There's a trick (AKA hack) here.  For 16BPP modes, the VIDC is told
+                 * that the mode is 8BPP and horiz resolution X, whereas the output is really
+                 * 16BPP with horiz resolution X/2.
+                 */
+                bpp = 4;
+                xres /= 2;
+                hcr /= 2;
+                xfp /= 2;
+                xsw /= 2;
+                xbp = hcr - xfp - xsw - xres;
+                pix_rate /= 2;
+                s->flags |= VSOLVE_F_16BPP;
+        }
+
+        s->in_xres = xres;
+        s->in_yres = yres;
+        s->in_hcr = hcr;
+        s->in_vcr = vcr;
+        s->in_hfp = xfp;
+        s->in_hsw = xsw;
+        s->in_hbp = xbp;
+        s->in_vfp = yfp;
+        s->in_vsw = ysw;
+        s->in_vbp = ybp;
+        s->in_pix_mhz = pix_rate;
+        s->in_bpp = bpp;
+        s->in_ext_pal = ext_pal;
+
+        /* Now, some dumb heuristics to try to program a matching output mode:
+         * 1. Is it a highres mode?
+         * 2. Is it a regular VGA/mode21-like mode?
+         * 3. Otherwise, something needs doubling.
+         */
+
+        if (video_guess_hires(xres, yres, bpp, pix_rate)) {
+                /* Not totally infallible, but definitely works for mode 23 ;-)
+                 * Hopefully this will work for x900 variants.
+                 */
+                s->reason = VSOLVE_HIRES;
+
+                xres *= 4;
+                /* ArcDVI can do a 96MHz pixel clock, so output VIDC/RISC OS timings
+                 * directly.  Whether your monitor likes 'em is another matter, as they're
+                 * not quite VESA, but "works for me".
+                 */
+                xfp *= 4;
+                xsw *= 4;
+                xbp *= 4;
+
+                /* Vertical timing stays the same. */
+                hires = 1;
+                bpp = 0;
+                wpl = (xres/32)-1;
+
+                cx = 0x12c; /* FIXME: derive this from ... something! ;( */
+
+                m->pclk_khz = 4 * PLL_REF_KHZ; /* 24*4=96MHz */
+
+        } else if (xres >= 640 && yres >= 480) {
+                /* Use VIDC timing directly */
+                s->reason = VSOLVE_DIRECT;
+
+                m->pclk_khz = PLL_REF_KHZ;
+
+        } else if (yres < 480) {
+                /* We'll want some Y doublin'.  Slightly more complicated now,
+                 * because we need to recalculate the horiz timing to fit a new pclk
+                 * instead of the input one.  Specifically, we output the line twice
+                 * but need to keep the same vertical timing, which means we need to output
+                 * it twice as fast horizontally.  This is done by changing the blanking time,
+                 * and raising the pixel clock if 24MHz won't fit.
+                 *
+                 * Not all modes can simply be doubled:
+                 * - Maybe the mode is already using a 24MHz pclk (e.g. mode 37),
+                 *   meaning we can't output the input line at 2x the rate
+                 * - Or, the mode is <24 (e.g. 16MHz) but so wide that we can't output
+                 *   enough pixels at 24MHz to keep within the line period.
+                 *
+                 * We resolve this by working out the lowest output pixel clock
+                 * that gives a long enough line, and asking the PLL solver for the
+                 * closest rate at or above that, between 24MHz and 48MHz.  Most modes
+                 * (including the wide ones) fit this method, and using the lowest
+                 * clock that fits keeps the synthesised blanking reasonably tight.
+                 *
+                 * Some modes will end up a weird geometry (mode 37 would be 896x704)
+                 * which monitors may still not like.  FIXME:  Possible to add borders
+                 * and/or stretch DE to accommodate these.
+                 *
+                 * The fallback is outputting the mode non-doubled, which will likely
+                 * not work (monitors/TVs seem to like 400-ish lines at a minimum).
+                 *
+                 */
+                if (xres < 640) {
+                        /* We want _both_ X and Y doubling. */
+                        dx = 1;
+                        xres *= 2;
+                }
+
+                /* Being too skimpy on H-blank time upsets many monitors, so
+                 * refuse to go into such a mode.  If the monitor lists a timing
+                 * with this active area, use its blanking.  Else the front porch
+                 * and sync are synthesised below as 1/20 and 1/40 of the line,
+                 * so the line needs room for those (3/40 of it) plus a back
+                 * porch of at least xres/32 (art not science).
+                 */
+                const edid_dtd_t *dtd = mon ? edid_info_find_dtd(mon, xres, yres * 2) : NULL;
+                unsigned int min_width;
+
+                if (dtd)
+                        min_width = xres + (unsigned int)dtd->hfp +
+                                (unsigned int)dtd->hsync + (unsigned int)dtd->hbp;
+                else
+                        min_width = ((xres + xres/32) * 40 + 36) / 37;
+
+                const unsigned int minimum_h_blanking = min_width - xres;
+                uint32_t max_khz = DOUBLED_PCLK_MAX_KHZ;
+                /* We need exactly 1/2 of the original line period, but with a
+                 * new clock; this is the slowest clock giving min_width pixels:
+                 */
+                uint32_t need_khz = (min_width * 2 * pix_rate * 1000 + hcr - 1) / hcr;
+                unsigned int new_total_width = 0;
+
+                if (need_khz < DOUBLED_PCLK_MIN_KHZ)
+                        need_khz = DOUBLED_PCLK_MIN_KHZ;
+                if (mon && mon->has_range && mon->max_pclk_khz &&
+                    mon->max_pclk_khz < max_khz)
+                        max_khz = mon->max_pclk_khz;
+                s->need_khz = need_khz;
+                s->min_blanking = minimum_h_blanking;
+
+                if (pll_solve_min(PLL_REF_KHZ, need_khz, max_khz, &pll)) {
+                        new_total_width = hcr * pll.fout_khz / (pix_rate * 1000) / 2;
+
+                        yres *= 2;
+                        yfp *= 2;
+                        ysw *= 2;
+                        ybp *= 2;
+
+                        if (dtd) {
+                                /* The monitor's own porch/sync; the line's at
+                                 * least as long as its, so the rest goes in BP:
+                                 */
+                                xfp = dtd->hfp;
+                                xsw = dtd->hsync;
+                                s->flags |= VSOLVE_F_DTD_BLANKING;
+                        } else {
+                                /* Synthesise new sync parameters using roughly a 2:1:4 ratio: */
+                                xfp = new_total_width / 20;
+                                xsw = new_total_width / 40;
+                        }
+                        xbp = new_total_width-xres-xfp-xsw;
+
+                        s->reason = VSOLVE_DOUBLED;
+                        s->line_width = new_total_width;
+                        dy = 1;
+                        m->pclk_khz = pll.fout_khz;
+                } else {
+                        s->reason = VSOLVE_NO_DOUBLE;
+                        s->line_width = min_width;
+                        dx = 0;
+                        /* Give-up case, outputing mode 1:1.  Maybe the display
+                         * can cope with it directly.
+                         */
+                        m->pclk_khz = PLL_REF_KHZ;
+                }
+        } else {
+                s->reason = VSOLVE_NARROW;
+        }
+
+        /* The rates chosen above are all exactly achievable, so this just
+         * resolves the PLL configuration word.
+         */
+        if (pll_lookup(memo, m->pclk_khz, &pll)) {
+                m->pclk_khz = pll.fout_khz;
+                m->pll_cfg = pll_config_word(&pll);
+        } else {
+                s->flags |= VSOLVE_F_NO_PLL;
+        }
+
+        m->vido[VIDO_REG_RES_X] = xres | (dx ? 0x80000000 : 0);
+        m->vido[VIDO_REG_HS_FP] = xfp;
+        m->vido[VIDO_REG_HS_WIDTH] = xsw;
+        m->vido[VIDO_REG_HS_BP] = xbp;
+        m->vido[VIDO_REG_RES_Y] = yres | (dy ? 0x80000000 : 0);
+        m->vido[VIDO_REG_VS_FP] = yfp;
+        m->vido[VIDO_REG_VS_WIDTH] = ysw;
+        m->vido[VIDO_REG_VS_BP] = ybp;
+        m->vido[VIDO_REG_WPLM1] = wpl;
+        m->vido[VIDO_REG_CTRL] = cx | (hires ? 0x80000000 : 0) | (bpp << 28) |
+                (ext_pal ? 0x08000000 : 0);
+        m->dx = dx;
+        m->dy = dy;
+        m->hires = hires;
+        video_solve_range(mon, s);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 ArcDVI contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VIDEO_SOLVE_H
+#define VIDEO_SOLVE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vidc_regs.h"
+#include "video.h"
+#include "edid.h"
+#include "pll.h"
+
+/* The output mode solver:  from VIDC's timing registers (and the monitor's
+ * EDID, if any) to the VIDO/PLL programming for a matching output mode.
+ *
+ * There's no register I/O, no console output, and no state of its own (PLL
+ * solutions are remembered in a memo the caller passes in), so it can be
+ * cached, and run in bulk on a host.  Describing the solution, and
+ * committing it to the hardware, are up to the caller.
+ */
+
+/* Bumped whenever a change to video_solve() changes its results, so modes
+ * stored by an older one are solved again (see modestore.c):
+ */
+#define VSOLVE_VERSION          2
+
+/* Which way the mode was matched: */
+#define VSOLVE_DIRECT           0       /* At least 640x480: VIDC's timing, 1:1 */
+#define VSOLVE_NARROW           1       /* Tall enough but narrow: 1:1 anyway */
+#define VSOLVE_HIRES            2       /* Hires mono: 4 pixels per VIDC pixel */
+#define VSOLVE_DOUBLED          3       /* Line-doubled (maybe X too), new pclk */
+#define VSOLVE_NO_DOUBLE        4       /* Needed doubling, no clock fits: 1:1 */
+
+/* Adjustments and observations along the way: */
+#define VSOLVE_F_HDER_ZERO      0x01    /* HDER was 0 (RISCiX), assumed +288 */
+#define VSOLVE_F_16BPP          0x02    /* VIDC runs 8bpp at 2x width */
+#define VSOLVE_F_DTD_BLANKING   0x04    /* Doubled with the monitor's blanking */
+#define VSOLVE_F_OUT_OF_RANGE   0x08    /* Outside the monitor's range limits */
+#define VSOLVE_F_NO_PLL         0x10    /* No PLL config for the pixel clock */
+
+typedef struct {
+        /* VIDC's mode, as decoded (after the 16bpp adjustment): */
+        uint16_t        in_xres, in_yres;
+        uint16_t        in_hcr, in_vcr;
+        uint16_t        in_hfp, in_hsw, in_hbp;
+        uint16_t        in_vfp, in_vsw, in_vbp;
+        uint8_t         in_pix_mhz;
+        uint8_t         in_bpp;                 /* log2 */
+        bool            in_ext_pal;
+
+        uint8_t         reason;                 /* VSOLVE_* */
+        uint8_t         flags;                  /* VSOLVE_F_* */
+        /* Doubling: the slowest clock that fits, and the line it gives
+         * (or, if none fits, the narrowest line wanted)
+         */
+        uint32_t        need_khz;
+        uint16_t        min_blanking;
+        uint16_t        line_width;
+        /* Output line/frame rates, for range checks */
+        uint32_t        hfreq_khz;
+        uint32_t        vfreq_hz;
+
+        video_mode_t    mode;                   /* What to program */
+} video_solution_t;
+
+/* mon may be NULL (no/unknown monitor), and memo NULL to not memoise */
+void            video_solve(const vidc_timing_t *t, const edid_info_t *mon,
+                            pll_memo_t *memo, video_solution_t *s);
+const char     *video_solve_reason(unsigned int reason);
+
+#endif